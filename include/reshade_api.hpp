@@ -842,5 +842,16 @@ namespace reshade { namespace api
 		/// </summary>
 		/// <param name="postfix">Optional string to append to the screenshot filename, or <see langword="nullptr"/> for no postfix.</param>
 		virtual void save_screenshot(const char *postfix = nullptr) = 0;
+
+		/// <summary>
+		/// Gets the time spent in the callbacks an add-on registered for an event, averaged over recent frames.
+		/// This is only available while measuring add-on callbacks is enabled on the statistics page of the overlay.
+		/// </summary>
+		/// <param name="addon_name">Name of the add-on, as it was registered.</param>
+		/// <param name="ev">Event to query (a value of the <c>addon_event</c> enumeration).</param>
+		/// <param name="out_duration_ns">Pointer to a variable that is set to the average time per frame spent in the callbacks of the add-on for this event, in nanoseconds.</param>
+		/// <param name="out_call_count">Pointer to a variable that is set to the average number of calls per frame to the callbacks of the add-on for this event.</param>
+		/// <returns><see langword="true"/> if statistics are available for the add-on, <see langword="false"/> otherwise.</returns>
+		virtual bool get_addon_event_statistics(const char *addon_name, uint32_t ev, uint64_t *out_duration_ns, uint64_t *out_call_count) const = 0;
 	};
 } }
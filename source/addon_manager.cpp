@@ -9,7 +9,11 @@
 #include "addon_manager.hpp"
 #include "dll_log.hpp"
 #include "ini_file.hpp"
-#include <algorithm> // std::find, std::find_if, std::remove, std::remove_if
+#include <new> // std::align_val_t
+#include <mutex>
+#include <limits>
+#include <cstddef> // offsetof
+#include <algorithm> // std::copy_n, std::find, std::find_if, std::remove, std::remove_if, std::min
 
 extern void register_addon_depth();
 extern void register_addon_effect_runtime_sync();
@@ -20,8 +24,7 @@ extern HMODULE g_module_handle;
 
 extern std::filesystem::path get_module_path(HMODULE module);
 
-#if RESHADE_VERBOSE_LOG
-static const char *addon_event_to_string(reshade::addon_event ev)
+const char *reshade::addon_event_to_string(reshade::addon_event ev)
 {
 	using reshade::addon_event;
 	switch (ev)
@@ -129,16 +132,270 @@ static const char *addon_event_to_string(reshade::addon_event ev)
 	}
 	return "unknown";
 }
-#endif
 
 #if RESHADE_ADDON == 1
 bool reshade::addon_enabled = true;
 #endif
 bool reshade::addon_all_loaded = true;
-std::vector<void *> reshade::addon_event_list[static_cast<uint32_t>(reshade::addon_event::max)];
+bool reshade::addon_profiling = false;
+std::atomic<const reshade::addon_event_callbacks *> reshade::addon_event_list[static_cast<uint32_t>(reshade::addon_event::max)];
 std::vector<reshade::addon_info> reshade::addon_loaded_info;
 static unsigned long s_reference_count = 0;
 
+// Lists that were replaced are only freed once no thread may still read them, which is tracked with epochs:
+// Every thread reading from the lists records the epoch at which it started reading in a slot, and a replaced list is retired at the current epoch, which is then advanced
+// A retired list can be freed as soon as no slot holds an epoch up to the one it was retired at anymore, since threads that started reading later can only see the replacement
+struct alignas(64) addon_event_reader
+{
+	std::atomic<uint64_t> epoch = 0; // Zero while the thread is not reading
+	std::atomic<bool> in_use = false;
+	addon_event_reader *next = nullptr;
+};
+struct addon_event_reader_slot
+{
+	~addon_event_reader_slot()
+	{
+		// Reader slots are never freed, but can be reused by other threads after this one exited
+		if (reader != nullptr)
+			reader->in_use.store(false, std::memory_order_release);
+	}
+
+	addon_event_reader *reader = nullptr;
+	uint32_t depth = 0;
+};
+
+static std::atomic<uint64_t> s_event_list_epoch = 1;
+static std::atomic<addon_event_reader *> s_event_list_readers = nullptr;
+static thread_local addon_event_reader_slot s_event_list_reader_slot;
+// Serializes modifications of the lists, but is never taken when reading from them
+static std::mutex s_event_list_mutex;
+static std::vector<std::pair<uint64_t, const reshade::addon_event_callbacks *>> s_retired_event_lists;
+
+static addon_event_reader *acquire_event_list_reader()
+{
+	for (addon_event_reader *reader = s_event_list_readers.load(std::memory_order_acquire); reader != nullptr; reader = reader->next)
+		if (bool expected = false; reader->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			return reader;
+
+	addon_event_reader *const reader = new addon_event_reader();
+	reader->in_use.store(true, std::memory_order_relaxed);
+	reader->next = s_event_list_readers.load(std::memory_order_relaxed);
+	while (!s_event_list_readers.compare_exchange_weak(reader->next, reader, std::memory_order_release, std::memory_order_relaxed))
+		continue;
+	return reader;
+}
+
+// The time spent in callbacks is accumulated in counters that are local to each thread and only ever increase, so that no atomic read-modify-write operations are needed
+// Flushing sums up the counters of all threads and compares the sums against those of the previous flush to get the values for the last frame
+struct addon_event_counters
+{
+	std::atomic<uint64_t> duration = 0;
+	std::atomic<uint64_t> count = 0;
+};
+struct alignas(64) addon_event_profiler
+{
+	addon_event_counters counters[reshade::max_profiled_addons][static_cast<uint32_t>(reshade::addon_event::max)];
+	std::atomic<bool> in_use = false;
+	addon_event_profiler *next = nullptr;
+};
+struct addon_event_profiler_slot
+{
+	~addon_event_profiler_slot()
+	{
+		// Counters are never freed, but can be continued by other threads after this one exited
+		if (profiler != nullptr)
+			profiler->in_use.store(false, std::memory_order_release);
+	}
+
+	addon_event_profiler *profiler = nullptr;
+};
+
+static std::atomic<addon_event_profiler *> s_event_profilers = nullptr;
+static thread_local addon_event_profiler_slot s_event_profiler_slot;
+// Add-ons are identified by name, so that an add-on that is reloaded continues to use the same counters
+static std::vector<std::string> s_profiled_addon_names;
+static std::mutex s_event_statistics_mutex;
+static std::vector<std::pair<uint64_t, uint64_t>> s_event_statistics_totals;
+static reshade::addon_event_statistics s_event_statistics[reshade::max_profiled_addons][static_cast<uint32_t>(reshade::addon_event::max)];
+
+static addon_event_profiler *acquire_event_profiler()
+{
+	for (addon_event_profiler *profiler = s_event_profilers.load(std::memory_order_acquire); profiler != nullptr; profiler = profiler->next)
+		if (bool expected = false; profiler->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			return profiler;
+
+	addon_event_profiler *const profiler = new addon_event_profiler();
+	profiler->in_use.store(true, std::memory_order_relaxed);
+	profiler->next = s_event_profilers.load(std::memory_order_relaxed);
+	while (!s_event_profilers.compare_exchange_weak(profiler->next, profiler, std::memory_order_release, std::memory_order_relaxed))
+		continue;
+	return profiler;
+}
+
+static uint32_t find_profiling_index(const std::string &addon_name)
+{
+	const std::unique_lock<std::mutex> lock(s_event_statistics_mutex);
+
+	const auto it = std::find(s_profiled_addon_names.begin(), s_profiled_addon_names.end(), addon_name);
+	if (it != s_profiled_addon_names.end())
+		return static_cast<uint32_t>(it - s_profiled_addon_names.begin());
+
+	// Callbacks of add-ons beyond the limit are not measured
+	if (s_profiled_addon_names.size() == reshade::max_profiled_addons)
+		return reshade::max_profiled_addons;
+
+	s_profiled_addon_names.push_back(addon_name);
+	return static_cast<uint32_t>(s_profiled_addon_names.size() - 1);
+}
+
+void reshade::record_addon_event_duration(uint32_t ev, uint32_t owner, uint64_t start)
+{
+	const uint64_t duration = addon_event_timestamp() - start;
+
+	if (owner >= max_profiled_addons)
+		return;
+
+	if (s_event_profiler_slot.profiler == nullptr)
+		s_event_profiler_slot.profiler = acquire_event_profiler();
+
+	// Only this thread ever writes to its counters, so a plain load and store is sufficient
+	addon_event_counters &counters = s_event_profiler_slot.profiler->counters[owner][ev];
+	counters.duration.store(counters.duration.load(std::memory_order_relaxed) + duration, std::memory_order_relaxed);
+	counters.count.store(counters.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void reshade::flush_addon_event_statistics()
+{
+	constexpr uint32_t num_events = static_cast<uint32_t>(addon_event::max);
+
+	const std::unique_lock<std::mutex> lock(s_event_statistics_mutex);
+
+	std::vector<std::pair<uint64_t, uint64_t>> totals(max_profiled_addons * num_events);
+	for (addon_event_profiler *profiler = s_event_profilers.load(std::memory_order_acquire); profiler != nullptr; profiler = profiler->next)
+	{
+		for (uint32_t owner = 0; owner < s_profiled_addon_names.size(); ++owner)
+		{
+			for (uint32_t ev = 0; ev < num_events; ++ev)
+			{
+				totals[owner * num_events + ev].first += profiler->counters[owner][ev].duration.load(std::memory_order_relaxed);
+				totals[owner * num_events + ev].second += profiler->counters[owner][ev].count.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	if (s_event_statistics_totals.size() == totals.size())
+	{
+		for (uint32_t owner = 0; owner < s_profiled_addon_names.size(); ++owner)
+		{
+			for (uint32_t ev = 0; ev < num_events; ++ev)
+			{
+				const std::pair<uint64_t, uint64_t> &total = totals[owner * num_events + ev];
+				const std::pair<uint64_t, uint64_t> &previous_total = s_event_statistics_totals[owner * num_events + ev];
+
+				// Exponential moving average, so that values remain readable when displayed every frame
+				addon_event_statistics &statistics = s_event_statistics[owner][ev];
+				statistics.average_duration += (static_cast<float>(total.first - previous_total.first) - statistics.average_duration) * 0.05f;
+				statistics.average_count += (static_cast<float>(total.second - previous_total.second) - statistics.average_count) * 0.05f;
+			}
+		}
+	}
+
+	s_event_statistics_totals = std::move(totals);
+}
+
+bool reshade::get_addon_event_statistics(const std::string &name, addon_event_statistics (&statistics)[static_cast<uint32_t>(addon_event::max)])
+{
+	const std::unique_lock<std::mutex> lock(s_event_statistics_mutex);
+
+	const auto it = std::find(s_profiled_addon_names.begin(), s_profiled_addon_names.end(), name);
+	if (it == s_profiled_addon_names.end())
+		return false;
+
+	std::copy_n(s_event_statistics[it - s_profiled_addon_names.begin()], static_cast<uint32_t>(addon_event::max), statistics);
+	return true;
+}
+
+static void free_event_list(const reshade::addon_event_callbacks *list)
+{
+	::operator delete(const_cast<reshade::addon_event_callbacks *>(list), std::align_val_t(alignof(reshade::addon_event_callbacks)));
+}
+static void reclaim_event_lists()
+{
+	if (s_retired_event_lists.empty())
+		return;
+
+	uint64_t min_epoch = std::numeric_limits<uint64_t>::max();
+	for (addon_event_reader *reader = s_event_list_readers.load(std::memory_order_acquire); reader != nullptr; reader = reader->next)
+		if (const uint64_t epoch = reader->epoch.load(); epoch != 0)
+			min_epoch = std::min(min_epoch, epoch);
+
+	s_retired_event_lists.erase(
+		std::remove_if(s_retired_event_lists.begin(), s_retired_event_lists.end(),
+			[min_epoch](const std::pair<uint64_t, const reshade::addon_event_callbacks *> &retired) {
+				if (retired.first >= min_epoch)
+					return false;
+				free_event_list(retired.second);
+				return true;
+			}),
+		s_retired_event_lists.end());
+}
+static void update_event_list(uint32_t ev, void *callback, const std::string &addon_name, bool add)
+{
+	const std::unique_lock<std::mutex> lock(s_event_list_mutex);
+
+	const reshade::addon_event_callbacks *const old_list = reshade::addon_event_list[ev].load(std::memory_order_relaxed);
+
+	std::vector<std::pair<void *, uint32_t>> callbacks;
+	if (old_list != nullptr)
+		for (size_t cb = 0; cb < old_list->count; ++cb)
+			callbacks.emplace_back(old_list->callbacks[cb], old_list->owners()[cb]);
+	if (add)
+		callbacks.emplace_back(callback, find_profiling_index(addon_name));
+	else
+		callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), [callback](const std::pair<void *, uint32_t> &entry) { return entry.first == callback; }), callbacks.end());
+
+	reshade::addon_event_callbacks *new_list = nullptr;
+	if (!callbacks.empty())
+	{
+		new_list = static_cast<reshade::addon_event_callbacks *>(::operator new(
+			offsetof(reshade::addon_event_callbacks, callbacks) + callbacks.size() * (sizeof(void *) + sizeof(uint32_t)), std::align_val_t(alignof(reshade::addon_event_callbacks))));
+		new_list->count = callbacks.size();
+		uint32_t *const owners = const_cast<uint32_t *>(new_list->owners());
+		for (size_t cb = 0; cb < callbacks.size(); ++cb)
+		{
+			new_list->callbacks[cb] = callbacks[cb].first;
+			owners[cb] = callbacks[cb].second;
+		}
+	}
+
+	reshade::addon_event_list[ev].store(new_list);
+
+	if (old_list != nullptr)
+		s_retired_event_lists.emplace_back(s_event_list_epoch.fetch_add(1), old_list);
+
+	reclaim_event_lists();
+}
+
+reshade::addon_event_read_scope::addon_event_read_scope()
+{
+	// Callbacks may cause nested events, which are covered by the outermost scope
+	if (s_event_list_reader_slot.depth++ != 0)
+		return;
+
+	if (s_event_list_reader_slot.reader == nullptr)
+		s_event_list_reader_slot.reader = acquire_event_list_reader();
+
+	// Sequentially consistent store, so that it is visible before the list is loaded afterwards
+	s_event_list_reader_slot.reader->epoch.store(s_event_list_epoch.load());
+}
+reshade::addon_event_read_scope::~addon_event_read_scope()
+{
+	if (--s_event_list_reader_slot.depth != 0)
+		return;
+
+	s_event_list_reader_slot.reader->epoch.store(0, std::memory_order_release);
+}
+
 void reshade::load_addons()
 {
 	// Only load add-ons the first time a reference is added
@@ -565,8 +822,7 @@ void ReShadeRegisterEventForAddon(HMODULE module, reshade::addon_event ev, void
 	}
 #endif
 
-	std::vector<void *> &event_list = reshade::addon_event_list[static_cast<uint32_t>(ev)];
-	event_list.push_back(callback);
+	update_event_list(static_cast<uint32_t>(ev), callback, info->name, true);
 
 	info->event_callbacks.emplace_back(static_cast<uint32_t>(ev), callback);
 
@@ -594,8 +850,7 @@ void ReShadeUnregisterEventForAddon(HMODULE module, reshade::addon_event ev, voi
 		return;
 #endif
 
-	std::vector<void *> &event_list = reshade::addon_event_list[static_cast<uint32_t>(ev)];
-	event_list.erase(std::remove(event_list.begin(), event_list.end(), callback), event_list.end());
+	update_event_list(static_cast<uint32_t>(ev), callback, info->name, false);
 
 	info->event_callbacks.erase(std::remove(info->event_callbacks.begin(), info->event_callbacks.end(), std::make_pair(static_cast<uint32_t>(ev), callback)), info->event_callbacks.end());
 
@@ -7,6 +7,8 @@
 
 #include "addon.hpp"
 #include "reshade_events.hpp"
+#include <atomic>
+#include <chrono>
 
 #if RESHADE_ADDON
 
@@ -19,11 +21,80 @@ namespace reshade
 	extern bool addon_enabled;
 #endif
 	extern bool addon_all_loaded;
+	/// <summary>
+	/// Global switch to enable measuring the time spent in add-on event callbacks.
+	/// </summary>
+	extern bool addon_profiling;
+
+	/// <summary>
+	/// Maximum number of add-ons for which the time spent in event callbacks can be measured.
+	/// </summary>
+	constexpr uint32_t max_profiled_addons = 32;
+
+	/// <summary>
+	/// Immutable list of the callbacks registered for an add-on event.
+	/// Registering or unregistering a callback publishes a new list instead of modifying the existing one, so that events can be invoked concurrently without locking.
+	/// </summary>
+	struct alignas(64) addon_event_callbacks
+	{
+		size_t count;
+		void *callbacks[1]; // Allocated with space for 'count' entries, followed by the profiling index of the add-on each callback belongs to
+
+		const uint32_t *owners() const { return reinterpret_cast<const uint32_t *>(callbacks + count); }
+	};
 
 	/// <summary>
-	/// List of add-on event callbacks.
+	/// List of add-on event callbacks, or <see langword="nullptr"/> if no callbacks are registered for an event.
 	/// </summary>
-	extern std::vector<void *> addon_event_list[];
+	extern std::atomic<const addon_event_callbacks *> addon_event_list[];
+
+	/// <summary>
+	/// Marks the calling thread as reading from <see cref="addon_event_list"/> for the lifetime of this object, so that lists it may still access are not freed in the meantime.
+	/// </summary>
+	class addon_event_read_scope
+	{
+	public:
+		addon_event_read_scope();
+		~addon_event_read_scope();
+
+		addon_event_read_scope(const addon_event_read_scope &) = delete;
+		addon_event_read_scope &operator=(const addon_event_read_scope &) = delete;
+	};
+
+	/// <summary>
+	/// Time spent in the callbacks an add-on registered for an event, averaged over recent frames.
+	/// </summary>
+	struct addon_event_statistics
+	{
+		float average_duration = 0.0f; // In nanoseconds per frame
+		float average_count = 0.0f; // Calls per frame
+	};
+
+	/// <summary>
+	/// Gets a timestamp in nanoseconds to measure the time spent in an add-on event callback.
+	/// </summary>
+	inline uint64_t addon_event_timestamp()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+	/// <summary>
+	/// Adds the time since the specified <paramref name="start"/> timestamp to the counters of the calling thread for the add-on with the specified profiling index.
+	/// </summary>
+	void record_addon_event_duration(uint32_t ev, uint32_t owner, uint64_t start);
+	/// <summary>
+	/// Gathers the counters of all threads and updates the averaged statistics with the values since the last call.
+	/// This is called once per frame, from the first runtime that presents.
+	/// </summary>
+	void flush_addon_event_statistics();
+	/// <summary>
+	/// Gets the averaged statistics of all events for the add-on with the specified <paramref name="name"/>.
+	/// </summary>
+	bool get_addon_event_statistics(const std::string &name, addon_event_statistics (&statistics)[static_cast<uint32_t>(addon_event::max)]);
+
+	/// <summary>
+	/// Gets the name of the specified <paramref name="ev"/>ent.
+	/// </summary>
+	const char *addon_event_to_string(addon_event ev);
 
 	/// <summary>
 	/// List of currently loaded add-ons.
@@ -56,7 +127,7 @@ namespace reshade
 	template <addon_event ev>
 	__forceinline bool has_addon_event()
 	{
-		return !addon_event_list[static_cast<uint32_t>(ev)].empty();
+		return addon_event_list[static_cast<uint32_t>(ev)].load(std::memory_order_relaxed) != nullptr;
 	}
 
 	/// <summary>
@@ -110,9 +181,23 @@ namespace reshade
 		if (!addon_enabled)
 			return;
 #endif
-		std::vector<void *> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
-		for (size_t cb = 0, count = event_list.size(); cb < count; ++cb) // Generates better code than ranged-based for loop
-			reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb])(std::forward<Args>(args)...);
+		// Fast path for the common case of no callbacks being registered, which avoids entering a read scope
+		if (!has_addon_event<ev>())
+			return;
+
+		const addon_event_read_scope scope;
+		// Load list again after entering the read scope, since only lists loaded within the scope are guaranteed to stay alive
+		if (const addon_event_callbacks *const event_list = addon_event_list[static_cast<uint32_t>(ev)].load())
+		{
+			const bool profile = addon_profiling;
+			for (size_t cb = 0, count = event_list->count; cb < count; ++cb) // Generates better code than ranged-based for loop
+			{
+				const uint64_t start = profile ? addon_event_timestamp() : 0;
+				reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list->callbacks[cb])(std::forward<Args>(args)...);
+				if (profile)
+					record_addon_event_duration(static_cast<uint32_t>(ev), event_list->owners()[cb], start);
+			}
+		}
 	}
 	/// <summary>
 	/// Invokes registered callbacks for the specified <typeparamref name="ev"/>ent until a callback reports back as having handled this event by returning <see langword="true"/>.
@@ -146,11 +231,23 @@ namespace reshade
 		if (!addon_enabled)
 			return false;
 #endif
+		if (!has_addon_event<ev>())
+			return false;
+
 		bool skip = false;
-		std::vector<void *> &event_list = addon_event_list[static_cast<uint32_t>(ev)];
-		for (size_t cb = 0, count = event_list.size(); cb < count; ++cb)
-			if (reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list[cb])(std::forward<Args>(args)...))
-				skip = true;
+		const addon_event_read_scope scope;
+		if (const addon_event_callbacks *const event_list = addon_event_list[static_cast<uint32_t>(ev)].load())
+		{
+			const bool profile = addon_profiling;
+			for (size_t cb = 0, count = event_list->count; cb < count; ++cb)
+			{
+				const uint64_t start = profile ? addon_event_timestamp() : 0;
+				if (reinterpret_cast<typename addon_event_traits<ev>::decl>(event_list->callbacks[cb])(std::forward<Args>(args)...))
+					skip = true;
+				if (profile)
+					record_addon_event_duration(static_cast<uint32_t>(ev), event_list->owners()[cb], start);
+			}
+		}
 		return skip;
 	}
 }
@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "cache_archive.hpp"
+#include <chrono>
+#include <limits>
+#include <cstddef> // offsetof
+#include <cstring> // std::memcpy
+#include <algorithm> // std::sort
+#include <Windows.h>
+
+// The archive consists of a header followed by a list of records, each made up of a record header, the key and the data (padded to 8 bytes)
+struct archive_header
+{
+	uint32_t magic;
+	uint32_t version;
+};
+struct record_header
+{
+	uint32_t key_size;
+	uint32_t data_size;
+	uint32_t checksum; // CRC-32 of the key and data, the last access time is excluded since it is updated in place
+	uint32_t reserved;
+	uint64_t last_used;
+};
+
+static constexpr uint32_t s_archive_magic = 0x43584652; // "RFXC"
+static constexpr uint32_t s_archive_version = 2;
+
+static uint64_t record_size(const record_header &header)
+{
+	return (sizeof(record_header) + header.key_size + header.data_size + 7) & ~static_cast<uint64_t>(7);
+}
+
+static uint32_t crc32(const void *data, size_t size, uint32_t crc = 0)
+{
+	static const struct crc32_table
+	{
+		crc32_table()
+		{
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				uint32_t value = i;
+				for (int k = 0; k < 8; ++k)
+					value = (value >> 1) ^ ((value & 1) ? 0xEDB88320 : 0);
+				values[i] = value;
+			}
+		}
+
+		uint32_t values[256];
+	} table;
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i)
+		crc = table.values[(crc ^ static_cast<const uint8_t *>(data)[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static uint64_t current_time()
+{
+	return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static bool read_at(HANDLE file, uint64_t offset, void *data, size_t size)
+{
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+	DWORD size_read = 0;
+	return ReadFile(file, data, static_cast<DWORD>(size), &size_read, &overlapped) && size_read == size;
+}
+static bool write_at(HANDLE file, uint64_t offset, const void *data, size_t size)
+{
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFF);
+	overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+	DWORD size_written = 0;
+	return WriteFile(file, data, static_cast<DWORD>(size), &size_written, &overlapped) && size_written == size;
+}
+static bool truncate_file(HANDLE file, uint64_t size)
+{
+	LARGE_INTEGER position;
+	position.QuadPart = static_cast<LONGLONG>(size);
+	return SetFilePointerEx(file, position, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+}
+
+static HANDLE open_archive_file(const std::filesystem::path &path)
+{
+	// Do not allow other processes to write to the archive while it is open, those will fall back to separate cache files instead
+	return CreateFileW(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+}
+
+reshade::cache_archive::~cache_archive()
+{
+	close();
+}
+
+bool reshade::cache_archive::open(const std::filesystem::path &path, uint64_t size_limit)
+{
+	close();
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	const HANDLE file = open_archive_file(path);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	_file = file;
+	_path = path;
+	_size_limit = size_limit;
+
+	if (!map())
+	{
+		unmap();
+		CloseHandle(_file);
+		_file = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+void reshade::cache_archive::close()
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	if (_file == nullptr)
+		return;
+
+	const uint64_t time = current_time();
+
+	// Compaction closes the file and writes the updated last access times as part of the new archive
+	// It may fail after the file was already closed though (if the compacted archive could not replace the old one), in which case there is nothing left to update
+	if ((_size_limit != 0 && _append_offset > _size_limit) || _unused_size > _append_offset / 2)
+		compact();
+
+	if (_file != nullptr)
+	{
+		// Update last access time of all entries that were used, so that the least recently used ones are evicted first during compaction
+		for (const std::pair<const std::string, entry> &entry : _entries)
+			if (entry.second.used)
+				write_at(_file, entry.second.offset + offsetof(record_header, last_used), &time, sizeof(time));
+	}
+
+	unmap();
+
+	if (_file != nullptr)
+		CloseHandle(_file);
+	_file = nullptr;
+
+	_entries.clear();
+	_append_offset = 0;
+	_unused_size = 0;
+}
+
+bool reshade::cache_archive::load(const std::string &key, std::string &data, std::string_view &data_view) const
+{
+	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+	const auto it = _entries.find(key);
+	if (it == _entries.end())
+		return false;
+
+	const entry &entry = it->second;
+	entry.used = true;
+
+	if (entry.record != nullptr)
+	{
+		data_view = std::string_view(reinterpret_cast<const char *>(entry.record + sizeof(record_header) + key.size()), entry.data_size);
+		return true;
+	}
+
+	// Entry is not part of the mapped view, so read it back from the file (this is rare, since entries are usually saved once and loaded the next time the archive is opened)
+	data.resize(entry.data_size);
+	if (!read_at(_file, entry.offset + sizeof(record_header) + key.size(), data.data(), data.size()))
+		return false;
+
+	data_view = data;
+	return true;
+}
+bool reshade::cache_archive::save(const std::string &key, std::string_view data)
+{
+	if (key.size() > std::numeric_limits<uint32_t>::max() || data.size() > std::numeric_limits<uint32_t>::max())
+		return false;
+
+	record_header header = { static_cast<uint32_t>(key.size()), static_cast<uint32_t>(data.size()), 0, 0, current_time() };
+	header.checksum = crc32(data.data(), data.size(), crc32(key.data(), key.size()));
+	const uint64_t size = record_size(header);
+
+	// Build the complete record in memory, so that it can be written with a single call
+	// It is not kept around after that, lookups of this entry read it back from the file instead
+	std::vector<uint8_t> record(static_cast<size_t>(size));
+	std::memcpy(record.data(), &header, sizeof(header));
+	std::memcpy(record.data() + sizeof(header), key.data(), key.size());
+	std::memcpy(record.data() + sizeof(header) + key.size(), data.data(), data.size());
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	if (_file == nullptr || !write_at(_file, _append_offset, record.data(), record.size()))
+		return false;
+
+	entry &entry = _entries[key];
+	if (entry.size != 0)
+		_unused_size += entry.size;
+
+	entry.record = nullptr;
+	entry.offset = _append_offset;
+	entry.size = size;
+	entry.last_used = header.last_used;
+	entry.data_size = header.data_size;
+	entry.used = true;
+
+	_append_offset += size;
+
+	return true;
+}
+
+void reshade::cache_archive::clear()
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	// Cannot modify the file while it is mapped, so simply forget about all entries and let compaction remove them on close
+	_entries.clear();
+	_unused_size = _append_offset;
+}
+
+bool reshade::cache_archive::map()
+{
+	LARGE_INTEGER file_size = {};
+	if (!GetFileSizeEx(_file, &file_size))
+		return false;
+
+	archive_header header = {};
+	if (static_cast<uint64_t>(file_size.QuadPart) < sizeof(header) ||
+		!read_at(_file, 0, &header, sizeof(header)) || header.magic != s_archive_magic || header.version != s_archive_version)
+	{
+		// Start over with an empty archive if it does not exist yet or was written by a different version
+		header = { s_archive_magic, s_archive_version };
+		if (!truncate_file(_file, 0) || !write_at(_file, 0, &header, sizeof(header)))
+			return false;
+
+		file_size.QuadPart = sizeof(header);
+	}
+
+	_mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr)
+		return false;
+	_view = static_cast<const uint8_t *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (_view == nullptr)
+		return false;
+	_view_size = static_cast<uint64_t>(file_size.QuadPart);
+
+	// Build index by walking through the record headers, later records replace earlier ones with the same key
+	uint64_t offset = sizeof(archive_header);
+	while (offset + sizeof(record_header) <= _view_size)
+	{
+		record_header record;
+		std::memcpy(&record, _view + offset, sizeof(record));
+
+		const uint64_t size = record_size(record);
+		if (offset + size > _view_size)
+			break;
+
+		const char *const key_data = reinterpret_cast<const char *>(_view + offset + sizeof(record));
+
+		// Stop at the first corrupted record, everything after it is discarded below
+		if (crc32(key_data, static_cast<size_t>(record.key_size) + record.data_size) != record.checksum)
+			break;
+
+		entry &entry = _entries[std::string(key_data, record.key_size)];
+		if (entry.size != 0)
+			_unused_size += entry.size;
+
+		entry.record = _view + offset;
+		entry.offset = offset;
+		entry.size = size;
+		entry.last_used = record.last_used;
+		entry.data_size = record.data_size;
+
+		offset += size;
+	}
+
+	_append_offset = offset;
+
+	if (_append_offset != _view_size)
+	{
+		// Discard incomplete or corrupted records at the end of the file (e.g. because the application was terminated while writing them)
+		unmap();
+		_entries.clear();
+		_unused_size = 0;
+
+		return truncate_file(_file, _append_offset) && map();
+	}
+
+	return true;
+}
+void reshade::cache_archive::unmap()
+{
+	if (_view != nullptr)
+		UnmapViewOfFile(_view);
+	_view = nullptr;
+	_view_size = 0;
+
+	if (_mapping != nullptr)
+		CloseHandle(_mapping);
+	_mapping = nullptr;
+}
+
+bool reshade::cache_archive::compact()
+{
+	const uint64_t time = current_time();
+
+	struct sorted_entry
+	{
+		const cache_archive::entry *value;
+		uint64_t last_used;
+	};
+
+	std::vector<sorted_entry> sorted_entries;
+	sorted_entries.reserve(_entries.size());
+	for (const std::pair<const std::string, entry> &entry : _entries)
+		sorted_entries.push_back({ &entry.second, entry.second.used ? time : entry.second.last_used });
+
+	// Keep the most recently used entries first
+	std::sort(sorted_entries.begin(), sorted_entries.end(),
+		[](const sorted_entry &lhs, const sorted_entry &rhs) {
+			return lhs.last_used > rhs.last_used;
+		});
+
+	// Leave some headroom below the size limit, so that compaction is not required again right away
+	const uint64_t target_size = _size_limit != 0 ? _size_limit - _size_limit / 4 : std::numeric_limits<uint64_t>::max();
+
+	std::filesystem::path temp_path = _path;
+	temp_path += L".tmp";
+
+	const HANDLE temp_file = CreateFileW(temp_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (temp_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	const archive_header header = { s_archive_magic, s_archive_version };
+	bool success = write_at(temp_file, 0, &header, sizeof(header));
+
+	std::vector<uint8_t> record_data;
+
+	uint64_t offset = sizeof(header);
+	for (const sorted_entry &sorted_entry : sorted_entries)
+	{
+		if (!success || offset + sorted_entry.value->size > target_size)
+			break;
+
+		// Records appended since the archive was opened are not in the mapped view, so have to be read back from the file
+		const uint8_t *source = sorted_entry.value->record;
+		if (source == nullptr)
+		{
+			record_data.resize(static_cast<size_t>(sorted_entry.value->size));
+			if (!read_at(_file, sorted_entry.value->offset, record_data.data(), record_data.size()))
+			{
+				success = false;
+				break;
+			}
+
+			source = record_data.data();
+		}
+
+		record_header record;
+		std::memcpy(&record, source, sizeof(record));
+		record.last_used = sorted_entry.last_used;
+
+		success = write_at(temp_file, offset, &record, sizeof(record)) &&
+			write_at(temp_file, offset + sizeof(record), source + sizeof(record), static_cast<size_t>(sorted_entry.value->size - sizeof(record)));
+		offset += sorted_entry.value->size;
+	}
+
+	CloseHandle(temp_file);
+
+	if (!success)
+	{
+		DeleteFileW(temp_path.c_str());
+		return false;
+	}
+
+	// Replace the archive with the compacted one
+	unmap();
+	CloseHandle(_file);
+	_file = nullptr;
+
+	if (!MoveFileExW(temp_path.c_str(), _path.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		DeleteFileW(temp_path.c_str());
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <filesystem>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace reshade
+{
+	/// <summary>
+	/// A single-file, append-only archive of cache entries, which is memory-mapped when opened so that lookups of existing entries can be served without copying.
+	/// </summary>
+	class cache_archive
+	{
+	public:
+		cache_archive() = default;
+		~cache_archive();
+
+		cache_archive(const cache_archive &) = delete;
+		cache_archive &operator=(const cache_archive &) = delete;
+
+		/// <summary>
+		/// Opens (or creates) the archive file at the specified <paramref name="path"/> and maps it into memory.
+		/// If the archive exceeds the <paramref name="size_limit"/>, the least recently used entries are evicted first.
+		/// </summary>
+		/// <param name="path">Path to the archive file.</param>
+		/// <param name="size_limit">Maximum size of the archive file in bytes, or zero for no limit.</param>
+		/// <returns><see langword="true"/> if the archive was opened successfully, <see langword="false"/> otherwise (e.g. because it is already in use by another process).</returns>
+		bool open(const std::filesystem::path &path, uint64_t size_limit);
+		/// <summary>
+		/// Updates the last access time of all entries that were used and closes the archive.
+		/// This invalidates all views previously returned by <see cref="load"/>.
+		/// </summary>
+		void close();
+
+		/// <summary>
+		/// Checks whether the archive is currently open.
+		/// </summary>
+		bool is_open() const { return _file != nullptr; }
+
+		/// <summary>
+		/// Looks up the data of the entry with the specified <paramref name="key"/>.
+		/// </summary>
+		/// <param name="key">Unique key identifying the entry.</param>
+		/// <param name="data">Reference filled with the entry data if it was appended since the archive was opened and therefore has to be read from the file.</param>
+		/// <param name="data_view">Reference filled with a view of the entry data, which either points into the mapped archive and stays valid until it is closed, or points to <paramref name="data"/>.</param>
+		/// <returns><see langword="true"/> if the entry exists, <see langword="false"/> otherwise.</returns>
+		bool load(const std::string &key, std::string &data, std::string_view &data_view) const;
+		/// <summary>
+		/// Appends a new entry to the archive, replacing any existing entry with the same <paramref name="key"/>.
+		/// </summary>
+		/// <param name="key">Unique key identifying the entry.</param>
+		/// <param name="data">Data to store.</param>
+		bool save(const std::string &key, std::string_view data);
+
+		/// <summary>
+		/// Removes all entries from the archive.
+		/// Views previously returned by <see cref="load"/> stay valid, the file is only truncated once the archive is closed.
+		/// </summary>
+		void clear();
+
+	private:
+		struct entry
+		{
+			const uint8_t *record = nullptr; // Pointer to the record in the mapped view, or null if it was appended after the archive was opened
+			uint64_t offset = 0;
+			uint64_t size = 0;
+			uint64_t last_used = 0;
+			uint32_t data_size = 0;
+			mutable std::atomic<bool> used = false;
+		};
+
+		bool map();
+		void unmap();
+		bool compact();
+
+		std::filesystem::path _path;
+		uint64_t _size_limit = 0;
+		void *_file = nullptr;
+		void *_mapping = nullptr;
+		const uint8_t *_view = nullptr;
+		uint64_t _view_size = 0;
+		uint64_t _append_offset = 0;
+		uint64_t _unused_size = 0;
+
+		mutable std::shared_mutex _mutex;
+		std::unordered_map<std::string, entry> _entries;
+	};
+}
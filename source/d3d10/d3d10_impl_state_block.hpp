@@ -7,6 +7,7 @@
 
 #include <d3d10_1.h>
 #include "com_ptr.hpp"
+#include "state_block.hpp"
 
 namespace reshade::d3d10
 {
@@ -16,11 +17,15 @@ namespace reshade::d3d10
 		explicit state_block(com_ptr<ID3D10Device> device);
 		~state_block();
 
-		void capture();
+		void capture(const api::state_block_subset &subset = {});
 		void apply_and_release();
 
 	private:
 		com_ptr<ID3D10Device> _device;
+		bool _capture_vertex_buffers = false;
+		UINT _num_constant_buffers = 0;
+		UINT _num_samplers = 0;
+		UINT _num_shader_resources = 0;
 		com_ptr<ID3D10InputLayout> _ia_input_layout;
 		D3D10_PRIMITIVE_TOPOLOGY _ia_primitive_topology = D3D10_PRIMITIVE_TOPOLOGY_UNDEFINED;
 		com_ptr<ID3D10Buffer> _ia_vertex_buffers[D3D10_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
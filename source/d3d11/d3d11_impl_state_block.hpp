@@ -7,6 +7,7 @@
 
 #include <d3d11_1.h>
 #include "com_ptr.hpp"
+#include "state_block.hpp"
 
 #define RESHADE_D3D11_STATE_BLOCK_TYPE 0
 
@@ -18,12 +19,17 @@ namespace reshade::d3d11
 		explicit state_block(com_ptr<ID3D11Device> device);
 		~state_block();
 
-		void capture(ID3D11DeviceContext *device_context);
+		void capture(ID3D11DeviceContext *device_context, const api::state_block_subset &subset = {});
 		void apply_and_release();
 
 	private:
 		D3D_FEATURE_LEVEL _device_feature_level;
 		com_ptr<ID3D11DeviceContext> _device_context;
+		bool _capture_vertex_buffers = false;
+		bool _capture_compute = false;
+		UINT _num_constant_buffers = 0;
+		UINT _num_samplers = 0;
+		UINT _num_shader_resources = 0;
 #if RESHADE_D3D11_STATE_BLOCK_TYPE
 		com_ptr<ID3DDeviceContextState> _state;
 		com_ptr<ID3DDeviceContextState> _captured_state;
@@ -25,6 +25,10 @@ reshade::d3d12::command_list_immediate_impl::command_list_immediate_impl(device_
 			return;
 	}
 
+	// Track transient descriptors used by this command list separately from those of other queues
+	_device_impl->_gpu_view_heap.register_transient_owner(this);
+	_device_impl->_gpu_sampler_heap.register_transient_owner(this);
+
 	// Create auto-reset event for synchronization
 	_fence_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
 	if (_fence_event == nullptr)
@@ -44,6 +48,9 @@ reshade::d3d12::command_list_immediate_impl::~command_list_immediate_impl()
 	if (this == s_last_immediate_command_list)
 		s_last_immediate_command_list = nullptr;
 
+	_device_impl->_gpu_view_heap.unregister_transient_owner(this);
+	_device_impl->_gpu_sampler_heap.unregister_transient_owner(this);
+
 	if (_orig != nullptr)
 		_orig->Release();
 	if (_fence_event != nullptr)
@@ -141,8 +148,14 @@ bool reshade::d3d12::command_list_immediate_impl::flush()
 
 	if (const UINT64 sync_value = _fence_value[_cmd_index] + NUM_COMMAND_FRAMES;
 		SUCCEEDED(_parent_queue->Signal(_fence[_cmd_index].get(), sync_value)))
+	{
 		_fence_value[_cmd_index] = sync_value;
 
+		// Transient descriptors used by this command list may not be overwritten before it finished executing
+		_device_impl->_gpu_view_heap.signal_transient(this, _fence[_cmd_index].get(), sync_value);
+		_device_impl->_gpu_sampler_heap.signal_transient(this, _fence[_cmd_index].get(), sync_value);
+	}
+
 	// Signal all the fences associated with queries that ran with this command list
 	for (const std::pair<ID3D12Fence *, UINT64> &fence : _current_query_fences)
 		_parent_queue->Signal(fence.first, fence.second);
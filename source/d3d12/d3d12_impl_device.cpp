@@ -1600,6 +1600,11 @@ bool reshade::d3d12::device_impl::allocate_descriptor_tables(uint32_t count, api
 					!_gpu_view_heap.allocate_static(total_count, base_handle, base_handle_gpu) :
 					!_gpu_sampler_heap.allocate_static(total_count, base_handle, base_handle_gpu))
 			{
+				const descriptor_range_allocator::statistics stats = heap_type != D3D12_DESCRIPTOR_HEAP_TYPE_SAMPLER ?
+					_gpu_view_heap.get_static_statistics() :
+					_gpu_sampler_heap.get_static_statistics();
+				log::message(log::level::error, "Failed to allocate descriptor table with %u descriptor(s) (%u descriptors are in use, %u are free in %u range(s) with the largest one being %u descriptors)!", total_count, stats.used_count, stats.free_count, stats.free_block_count, stats.largest_free_block);
+
 				free_descriptor_tables(count - i - 1, out_tables);
 				goto exit_failure;
 			}
@@ -7,82 +7,161 @@
 
 #include <d3d12.h>
 #include "com_ptr.hpp"
+#include "dll_log.hpp"
+#include <deque>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm> // std::fill_n, std::max
 #include <cassert>
+#include <mutex>
 #include <shared_mutex>
 
 namespace reshade::d3d12
 {
+	/// <summary>
+	/// Allocator for non-shader-visible descriptors, which are spread over a growing list of descriptor heaps with a fixed number of descriptors each.
+	/// Allocating and freeing descriptors only touches atomic bitmaps, so it does not block other threads. Only creating a new heap when all existing ones are full takes a lock.
+	/// </summary>
 	class descriptor_heap_cpu
 	{
+		static constexpr UINT pool_size = 1024;
+		// Heaps are stored in segments that are never moved once allocated, so that other threads can keep accessing them while new heaps are added
+		static constexpr UINT segment_size = 1024;
+		static constexpr UINT max_segments = 1024;
+		static constexpr UINT initial_lookup_size_bits = 12;
+
 		struct heap_info
 		{
 			com_ptr<ID3D12DescriptorHeap> heap;
-			std::vector<bool> state;
 			SIZE_T heap_base = 0;
+			std::atomic<int> num_free = pool_size;
+			std::atomic<uint32_t> state[pool_size / 32] = {}; // A set bit marks an entry as being in use
 		};
 
-		const UINT pool_size = 1024;
+		struct lookup_entry
+		{
+			std::atomic<uint64_t> block = 0; // Address block plus one, so that zero marks an empty slot
+			std::atomic<UINT> heap_index = 0;
+		};
+		struct lookup_table
+		{
+			explicit lookup_table(UINT size_bits) : size_bits(size_bits), entries(new lookup_entry[static_cast<size_t>(1) << size_bits]) {}
+
+			UINT size() const { return 1u << size_bits; }
+
+			const UINT size_bits;
+			const std::unique_ptr<lookup_entry[]> entries;
+		};
 
 	public:
 		descriptor_heap_cpu(ID3D12Device *device, D3D12_DESCRIPTOR_HEAP_TYPE type) :
 			_device(device), _type(type)
 		{
 			_increment_size = device->GetDescriptorHandleIncrementSize(type);
+
+			// Split the address space into blocks at least the size of a heap, which are then used to find the heap a handle belongs to in the lookup table
+			while ((static_cast<SIZE_T>(1) << _block_shift) < pool_size * _increment_size)
+				_block_shift++;
+
+			_lookup_tables.push_back(std::make_unique<lookup_table>(initial_lookup_size_bits));
+			_lookup.store(_lookup_tables.back().get(), std::memory_order_relaxed);
+		}
+		~descriptor_heap_cpu()
+		{
+			for (UINT i = 0; i < _num_heaps.load(std::memory_order_relaxed); ++i)
+				delete get_heap(i);
+			for (UINT i = 0; i < max_segments; ++i)
+				delete[] _segments[i].load(std::memory_order_relaxed);
 		}
 
 		bool allocate(D3D12_CPU_DESCRIPTOR_HANDLE &handle)
 		{
-			const std::unique_lock<std::shared_mutex> lock(_mutex);
+			// Each thread remembers the heap it last allocated from and starts searching there, so that concurrent threads tend to work on different bitmaps
+			static thread_local UINT s_last_heap_index = 0;
 
-			for (int attempt = 0; attempt < 2; ++attempt)
+			while (true)
 			{
-				for (heap_info &heap_info : _heap_infos)
+				const UINT num_heaps = _num_heaps.load(std::memory_order_acquire);
+
+				for (UINT i = 0; i < num_heaps; ++i)
 				{
-					// Find free empty in the heap
-					if (const auto it = std::find(heap_info.state.begin(), heap_info.state.end(), false);
-						it != heap_info.state.end())
-					{
-						const size_t index = it - heap_info.state.begin();
-						heap_info.state[index] = true; // Mark this entry as being in use
+					const UINT heap_index = (s_last_heap_index + i) % num_heaps;
 
-						handle.ptr = heap_info.heap_base + index * _increment_size;
+					if (heap_info &heap_info = *get_heap(heap_index);
+						heap_info.num_free.load(std::memory_order_relaxed) > 0 && allocate_from_heap(heap_info, handle))
+					{
+						s_last_heap_index = heap_index;
 						return true;
 					}
 				}
 
-				// No more space available in the existing heaps, so create a new one and try again
-				if (!allocate_heap())
-					break;
-			}
+				// No more space available in the existing heaps, so create a new one and try again (unless another thread already did so in the meantime)
+				const std::unique_lock<std::mutex> lock(_mutex);
 
-			return false;
+				if (_num_heaps.load(std::memory_order_relaxed) == num_heaps && !allocate_heap())
+					return false;
+			}
 		}
 
 		void free(D3D12_CPU_DESCRIPTOR_HANDLE handle)
 		{
-			const std::unique_lock<std::shared_mutex> lock(_mutex);
+			heap_info *const heap_info = find_heap(handle.ptr);
+			if (heap_info == nullptr)
+				return;
+
+			const SIZE_T index = (handle.ptr - heap_info->heap_base) / _increment_size;
+
+			// Mark free slot in the descriptor heap
+			heap_info->state[index / 32].fetch_and(~(1u << (index % 32)), std::memory_order_release);
+			heap_info->num_free.fetch_add(1, std::memory_order_relaxed);
+		}
+
+	private:
+		heap_info *get_heap(UINT heap_index) const
+		{
+			return _segments[heap_index / segment_size].load(std::memory_order_relaxed)[heap_index % segment_size];
+		}
+
+		bool allocate_from_heap(heap_info &heap_info, D3D12_CPU_DESCRIPTOR_HANDLE &handle)
+		{
+			// Start at a different word for each thread, to reduce the chance of multiple threads competing for the same bits
+			const UINT start_word = GetCurrentThreadId() % ARRAYSIZE(heap_info.state);
 
-			for (heap_info &heap_info : _heap_infos)
+			for (UINT i = 0; i < ARRAYSIZE(heap_info.state); ++i)
 			{
-				const SIZE_T heap_beg = heap_info.heap_base;
-				const SIZE_T heap_end = heap_info.heap_base + pool_size * _increment_size;
+				const UINT word_index = (start_word + i) % ARRAYSIZE(heap_info.state);
+				std::atomic<uint32_t> &word = heap_info.state[word_index];
 
-				if (handle.ptr >= heap_beg && handle.ptr < heap_end)
+				// Find free entry in this part of the heap and try to mark it as being in use, retrying if another thread modified the word in the meantime
+				for (uint32_t bits = word.load(std::memory_order_relaxed); bits != 0xFFFFFFFF;)
 				{
-					const SIZE_T index = (handle.ptr - heap_beg) / _increment_size;
+					unsigned long bit_index;
+					_BitScanForward(&bit_index, ~bits);
 
-					// Mark free slot in the descriptor heap
-					heap_info.state[index] = false;
-					break;
+					if (word.compare_exchange_weak(bits, bits | (1u << bit_index), std::memory_order_acquire, std::memory_order_relaxed))
+					{
+						heap_info.num_free.fetch_sub(1, std::memory_order_relaxed);
+
+						handle.ptr = heap_info.heap_base + (word_index * 32 + bit_index) * _increment_size;
+						return true;
+					}
 				}
 			}
+
+			return false;
 		}
 
-	private:
 		bool allocate_heap()
 		{
-			heap_info &heap_info = _heap_infos.emplace_back();
+			const UINT heap_index = _num_heaps.load(std::memory_order_relaxed);
+			if (heap_index >= segment_size * max_segments)
+			{
+				log::message(log::level::error, "Failed to create descriptor heap of type %d, because the limit of %u descriptors was reached.", static_cast<int>(_type), segment_size * max_segments * pool_size);
+				return false;
+			}
+
+			const auto heap_info = new descriptor_heap_cpu::heap_info();
 
 			D3D12_DESCRIPTOR_HEAP_DESC desc;
 			desc.Type = _type;
@@ -90,30 +169,355 @@ namespace reshade::d3d12
 			desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
 			desc.NodeMask = 0;
 
-			if (FAILED(_device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap_info.heap))))
+			if (const HRESULT hr = _device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap_info->heap)); FAILED(hr))
 			{
-				_heap_infos.pop_back();
+				log::message(log::level::error, "Failed to create descriptor heap of type %d with error code %s, after %u descriptors were allocated.", static_cast<int>(_type), log::hr_to_string(hr).c_str(), heap_index * pool_size);
+				delete heap_info;
 				return false;
 			}
 
-			heap_info.heap_base = heap_info.heap->GetCPUDescriptorHandleForHeapStart().ptr;
-			heap_info.state.resize(pool_size);
+			heap_info->heap_base = heap_info->heap->GetCPUDescriptorHandleForHeapStart().ptr;
+
+			if (heap_index % segment_size == 0)
+				_segments[heap_index / segment_size].store(new heap_info_ptr[segment_size], std::memory_order_relaxed);
+			_segments[heap_index / segment_size].load(std::memory_order_relaxed)[heap_index % segment_size] = heap_info;
+
+			// Every heap covers at most two address blocks, so this keeps the lookup table at most half full
+			lookup_table *table = _lookup.load(std::memory_order_relaxed);
+			if ((heap_index + 1) * 4 > table->size())
+				table = grow_lookup_table(*table);
+
+			// Add lookup entries for the first and last address block the heap covers, which may be the same one
+			const uint64_t first_block = heap_info->heap_base >> _block_shift;
+			const uint64_t last_block = (heap_info->heap_base + pool_size * _increment_size - 1) >> _block_shift;
+			insert_lookup_entry(*table, first_block, heap_index);
+			if (last_block != first_block)
+				insert_lookup_entry(*table, last_block, heap_index);
+
+			// Publish the new heap to other threads only after it is fully initialized
+			_num_heaps.store(heap_index + 1, std::memory_order_release);
 
 			return true;
 		}
 
+		lookup_table *grow_lookup_table(const lookup_table &old_table)
+		{
+			// Old tables stay alive until destruction, since other threads may still be searching through them
+			_lookup_tables.push_back(std::make_unique<lookup_table>(old_table.size_bits + 1));
+			lookup_table *const new_table = _lookup_tables.back().get();
+
+			for (UINT i = 0; i < old_table.size(); ++i)
+				if (const uint64_t block = old_table.entries[i].block.load(std::memory_order_relaxed); block != 0)
+					insert_lookup_entry(*new_table, block - 1, old_table.entries[i].heap_index.load(std::memory_order_relaxed));
+
+			// Publish the new table only after it contains all entries of the old one
+			_lookup.store(new_table, std::memory_order_release);
+
+			return new_table;
+		}
+
+		static UINT lookup_hash(const lookup_table &table, uint64_t block)
+		{
+			// Fibonacci hashing to spread adjacent blocks over the table
+			return static_cast<UINT>((block * 11400714819323198485ull) >> (64 - table.size_bits));
+		}
+
+		static void insert_lookup_entry(lookup_table &table, uint64_t block, UINT heap_index)
+		{
+			for (UINT i = lookup_hash(table, block);; i = (i + 1) & (table.size() - 1))
+			{
+				if (lookup_entry &entry = table.entries[i];
+					entry.block.load(std::memory_order_relaxed) == 0)
+				{
+					entry.heap_index.store(heap_index, std::memory_order_relaxed);
+					entry.block.store(block + 1, std::memory_order_release);
+					break;
+				}
+			}
+		}
+
+		heap_info *find_heap(SIZE_T ptr) const
+		{
+			const uint64_t block = ptr >> _block_shift;
+			const lookup_table &table = *_lookup.load(std::memory_order_acquire);
+
+			// Probe until an empty slot is reached, since there may be entries for two different heaps sharing the same address block
+			for (UINT i = lookup_hash(table, block);; i = (i + 1) & (table.size() - 1))
+			{
+				const lookup_entry &entry = table.entries[i];
+
+				const uint64_t entry_block = entry.block.load(std::memory_order_acquire);
+				if (entry_block == 0)
+					return nullptr;
+
+				if (entry_block - 1 == block)
+				{
+					heap_info *const heap_info = get_heap(entry.heap_index.load(std::memory_order_relaxed));
+					if (ptr >= heap_info->heap_base && ptr < heap_info->heap_base + pool_size * _increment_size)
+						return heap_info;
+				}
+			}
+		}
+
+		using heap_info_ptr = heap_info *;
+
 		ID3D12Device *const _device;
-		std::vector<heap_info> _heap_infos;
 		SIZE_T _increment_size;
+		UINT _block_shift = 0;
 		D3D12_DESCRIPTOR_HEAP_TYPE _type;
-		std::shared_mutex _mutex;
+		std::atomic<UINT> _num_heaps = 0;
+		std::atomic<heap_info_ptr *> _segments[max_segments] = {};
+		std::atomic<lookup_table *> _lookup = nullptr;
+		std::vector<std::unique_ptr<lookup_table>> _lookup_tables;
+		std::mutex _mutex;
+	};
+
+	/// <summary>
+	/// Two-level segregated fit allocator for ranges of descriptors, which allocates and frees ranges in constant time.
+	/// Free ranges are kept in lists bucketed by size, first by power of two and then by a linear subdivision of that, with bitmaps to quickly find a non-empty bucket.
+	/// </summary>
+	class descriptor_range_allocator
+	{
+		static constexpr UINT sl_index_bits = 4;
+		static constexpr UINT sl_index_count = 1 << sl_index_bits;
+		static constexpr UINT fl_index_count = 32 - sl_index_bits;
+		static constexpr UINT invalid_index = 0xFFFFFFFF;
+
+		struct block
+		{
+			UINT size : 31;
+			UINT is_free : 1;
+			UINT prev_phys; // Start of the physically preceding block
+			UINT next_free;
+			UINT prev_free;
+		};
+
+	public:
+		struct statistics
+		{
+			UINT used_count;
+			UINT free_count;
+			UINT free_block_count;
+			UINT largest_free_block;
+		};
+
+		explicit descriptor_range_allocator(UINT capacity) :
+			_blocks(capacity), _capacity(capacity)
+		{
+			for (UINT(&sl_heads)[sl_index_count] : _free_heads)
+				std::fill_n(sl_heads, sl_index_count, invalid_index);
+
+			if (capacity != 0)
+			{
+				_blocks[0].size = capacity;
+				_blocks[0].prev_phys = invalid_index;
+				insert_free_block(0);
+			}
+		}
+
+		bool allocate(UINT count, UINT &index)
+		{
+			if (count == 0 || count > _capacity)
+				return false;
+
+			UINT fl, sl;
+			mapping_search(count, fl, sl);
+			if (!find_suitable_bucket(fl, sl))
+				return false;
+
+			index = _free_heads[fl][sl];
+			remove_free_block(index, fl, sl);
+
+			block &block = _blocks[index];
+			// Split off the remainder of the block and return it to the free lists
+			if (block.size > count)
+			{
+				const UINT remainder_index = index + count;
+				_blocks[remainder_index].size = block.size - count;
+				_blocks[remainder_index].prev_phys = index;
+				if (const UINT next_index = index + block.size; next_index < _capacity)
+					_blocks[next_index].prev_phys = remainder_index;
+
+				block.size = count;
+				insert_free_block(remainder_index);
+			}
+
+			_used_count += count;
+			return true;
+		}
+
+		/// <summary>
+		/// Frees the range starting at the specified <paramref name="index"/> and returns the number of descriptors it contained (or zero if there was no range allocated at that index).
+		/// </summary>
+		UINT free(UINT index)
+		{
+			if (index >= _capacity || _blocks[index].size == 0 || _blocks[index].is_free)
+				return 0;
+
+			const UINT count = _blocks[index].size;
+			_used_count -= count;
+
+			// Merge with the physically following block if that is free too
+			if (const UINT next_index = index + _blocks[index].size;
+				next_index < _capacity && _blocks[next_index].is_free)
+			{
+				remove_free_block(next_index);
+				_blocks[index].size += _blocks[next_index].size;
+				_blocks[next_index].size = 0;
+			}
+
+			// Merge with the physically preceding block if that is free too
+			if (const UINT prev_index = _blocks[index].prev_phys;
+				prev_index != invalid_index && _blocks[prev_index].is_free)
+			{
+				remove_free_block(prev_index);
+				_blocks[prev_index].size += _blocks[index].size;
+				_blocks[index].size = 0;
+				index = prev_index;
+			}
+
+			if (const UINT next_index = index + _blocks[index].size; next_index < _capacity)
+				_blocks[next_index].prev_phys = index;
+
+			insert_free_block(index);
+
+			return count;
+		}
+
+		statistics get_statistics() const
+		{
+			statistics stats = { _used_count, _capacity - _used_count, _free_block_count, 0 };
+
+			// The largest free block is in the highest non-empty bucket, but blocks in a bucket differ in size, so have to look at all of them
+			if (_fl_bitmap != 0)
+			{
+				const UINT fl = find_last_set(_fl_bitmap);
+				const UINT sl = find_last_set(_sl_bitmap[fl]);
+				for (UINT index = _free_heads[fl][sl]; index != invalid_index; index = _blocks[index].next_free)
+					stats.largest_free_block = std::max(stats.largest_free_block, static_cast<UINT>(_blocks[index].size));
+			}
+
+			return stats;
+		}
+
+	private:
+		static UINT find_first_set(UINT mask)
+		{
+			unsigned long bit_index = 0;
+			_BitScanForward(&bit_index, mask);
+			return bit_index;
+		}
+		static UINT find_last_set(UINT mask)
+		{
+			unsigned long bit_index = 0;
+			_BitScanReverse(&bit_index, mask);
+			return bit_index;
+		}
+
+		static void mapping_insert(UINT size, UINT &fl, UINT &sl)
+		{
+			if (size < sl_index_count)
+			{
+				fl = 0;
+				sl = size;
+			}
+			else
+			{
+				const UINT log2_size = find_last_set(size);
+				sl = (size >> (log2_size - sl_index_bits)) ^ sl_index_count;
+				fl = log2_size - (sl_index_bits - 1);
+			}
+		}
+		static void mapping_search(UINT size, UINT &fl, UINT &sl)
+		{
+			// Round up to the next bucket, so that any block found there is large enough
+			if (size >= sl_index_count)
+				size += (1u << (find_last_set(size) - sl_index_bits)) - 1;
+
+			mapping_insert(size, fl, sl);
+		}
+
+		bool find_suitable_bucket(UINT &fl, UINT &sl) const
+		{
+			if (fl >= fl_index_count)
+				return false;
+
+			if (UINT sl_map = _sl_bitmap[fl] & (~0u << sl); sl_map != 0)
+			{
+				sl = find_first_set(sl_map);
+				return true;
+			}
+
+			const UINT fl_map = fl + 1 < fl_index_count ? _fl_bitmap & (~0u << (fl + 1)) : 0;
+			if (fl_map == 0)
+				return false;
+
+			fl = find_first_set(fl_map);
+			sl = find_first_set(_sl_bitmap[fl]);
+			return true;
+		}
+
+		void insert_free_block(UINT index)
+		{
+			block &block = _blocks[index];
+
+			UINT fl, sl;
+			mapping_insert(block.size, fl, sl);
+
+			block.is_free = 1;
+			block.prev_free = invalid_index;
+			block.next_free = _free_heads[fl][sl];
+			if (block.next_free != invalid_index)
+				_blocks[block.next_free].prev_free = index;
+			_free_heads[fl][sl] = index;
+
+			_fl_bitmap |= 1u << fl;
+			_sl_bitmap[fl] |= 1u << sl;
+			_free_block_count++;
+		}
+		void remove_free_block(UINT index)
+		{
+			UINT fl, sl;
+			mapping_insert(_blocks[index].size, fl, sl);
+			remove_free_block(index, fl, sl);
+		}
+		void remove_free_block(UINT index, UINT fl, UINT sl)
+		{
+			block &block = _blocks[index];
+
+			if (block.prev_free != invalid_index)
+				_blocks[block.prev_free].next_free = block.next_free;
+			else
+				_free_heads[fl][sl] = block.next_free;
+			if (block.next_free != invalid_index)
+				_blocks[block.next_free].prev_free = block.prev_free;
+
+			if (_free_heads[fl][sl] == invalid_index)
+			{
+				_sl_bitmap[fl] &= ~(1u << sl);
+				if (_sl_bitmap[fl] == 0)
+					_fl_bitmap &= ~(1u << fl);
+			}
+
+			block.is_free = 0;
+			_free_block_count--;
+		}
+
+		std::vector<block> _blocks;
+		const UINT _capacity;
+		UINT _used_count = 0;
+		UINT _free_block_count = 0;
+		UINT _fl_bitmap = 0;
+		UINT _sl_bitmap[fl_index_count] = {};
+		UINT _free_heads[fl_index_count][sl_index_count];
 	};
 
 	template <D3D12_DESCRIPTOR_HEAP_TYPE type, UINT static_size, UINT transient_size>
 	class descriptor_heap_gpu
 	{
 	public:
-		explicit descriptor_heap_gpu(ID3D12Device *device, UINT node_mask = 0)
+		explicit descriptor_heap_gpu(ID3D12Device *device, UINT node_mask = 0) :
+			_static_allocator(static_size)
 		{
 			// Manage all descriptors in a single heap, to avoid costly descriptor heap switches during rendering
 			// The lower portion of the heap is reserved for static bindings, the upper portion for transient bindings (which change frequently and are managed like a ring buffer)
@@ -134,7 +538,8 @@ namespace reshade::d3d12
 		}
 		~descriptor_heap_gpu()
 		{
-			assert(_count_list.empty());
+			if (const UINT used_count = _static_allocator.get_statistics().used_count; used_count != 0)
+				log::message(log::level::warning, "Destroying descriptor heap with %u static descriptor(s) still in use.", used_count);
 		}
 
 		bool allocate_static(UINT count, D3D12_CPU_DESCRIPTOR_HANDLE &base_handle, D3D12_GPU_DESCRIPTOR_HANDLE &base_handle_gpu)
@@ -144,121 +549,163 @@ namespace reshade::d3d12
 
 			const std::unique_lock<std::shared_mutex> lock(_mutex);
 
-			// First try to allocate from the list of freed blocks
-			for (auto block = _free_list.begin(); block != _free_list.end(); ++block)
+			UINT index = 0;
+			if (!_static_allocator.allocate(count, index))
+				return false; // The heap is full
+
+			const SIZE_T offset = index * _increment_size;
+			base_handle.ptr = _static_heap_base + offset;
+			base_handle_gpu.ptr = _static_heap_base_gpu + offset;
+
+			return true;
+		}
+		/// <summary>
+		/// Allocates <paramref name="count"/> contiguous transient descriptors for the specified <paramref name="owner"/>.
+		/// Descriptors allocated for a registered owner stay in use until that owner signals a fence that covers them, all others may be overwritten as soon as the ring buffer wraps around.
+		/// </summary>
+		bool allocate_transient(const void *owner, UINT count, D3D12_CPU_DESCRIPTOR_HANDLE &base_handle, D3D12_GPU_DESCRIPTOR_HANDLE &base_handle_gpu)
+		{
+			if (_heap == nullptr || count > transient_size)
+				return false;
+
+			std::unique_lock<std::shared_mutex> lock(_mutex);
+
+			while (true)
 			{
-				if (count <= (block->second - block->first) / _increment_size)
+				UINT64 allocation_start = _current_transient_tail;
+				SIZE_T index = static_cast<SIZE_T>(allocation_start % transient_size);
+
+				// Allocations need to be contiguous
+				if (index + count > transient_size)
+					allocation_start += transient_size - index, index = 0;
+
+				const UINT64 allocation_end = allocation_start + count;
+
+				// Make sure the GPU finished using the descriptors that are about to be overwritten
+				com_ptr<ID3D12Fence> wait_fence;
+				UINT64 wait_value = 0;
+				while (allocation_end - _current_transient_head > transient_size)
 				{
-					base_handle.ptr = _static_heap_base + static_cast<SIZE_T>(block->first - _static_heap_base_gpu);
-					base_handle_gpu.ptr = block->first;
+					retire_transient();
 
-					_count_list.emplace_back(base_handle_gpu.ptr, count);
+					if (allocation_end - _current_transient_head <= transient_size)
+						break;
 
-					// Remove the allocated range from the freed block and optionally remove it from the free list if no space is left afterwards
-					block->first += count * _increment_size;
-					if (block->first == block->second)
-						_free_list.erase(block);
+					// The oldest descriptors still in use determine how far the head can advance, so look at the owner holding them
+					const auto oldest_owner_it = std::min_element(_transient_owners.begin(), _transient_owners.end(),
+						[](const transient_owner &a, const transient_owner &b) { return a.oldest() < b.oldest(); });
+					if (oldest_owner_it == _transient_owners.end() || oldest_owner_it->oldest() == UINT64_MAX)
+					{
+						// Nothing in the ring buffer is tracked anymore, so it can simply be reused
+						_current_transient_head = allocation_end - transient_size;
+						break;
+					}
+
+					transient_owner &oldest_owner = *oldest_owner_it;
+					if (oldest_owner.fences.empty())
+					{
+						// The descriptors were not submitted with a tracked fence yet (e.g. because the owner is still recording them), so there is nothing to wait on and they are simply reused
+						oldest_owner.pending_begin = UINT64_MAX;
+						continue;
+					}
 
-					return true;
+					wait_fence = oldest_owner.fences.front().fence;
+					wait_value = oldest_owner.fences.front().value;
+					break;
 				}
-			}
 
-			// Otherwise follow a linear allocation schema
-			if (_current_static_index + count > static_size)
-				return false; // The heap is full
+				if (wait_fence != nullptr)
+				{
+					// Wait without holding the lock, so that other threads can keep allocating static descriptors and signaling fences in the meantime
+					// The ring buffer may have changed once the lock is acquired again, so start over afterwards
+					lock.unlock();
+					wait_fence->SetEventOnCompletion(wait_value, nullptr); // Blocks until the fence reached the value
+					lock.lock();
+					continue;
+				}
 
-			const SIZE_T offset = _current_static_index * _increment_size;
-			base_handle.ptr = _static_heap_base + offset;
-			base_handle_gpu.ptr = _static_heap_base_gpu + offset;
+				const SIZE_T offset = index * _increment_size;
+				base_handle.ptr = _transient_heap_base + offset;
+				base_handle_gpu.ptr = _transient_heap_base_gpu + offset;
 
-			_count_list.emplace_back(base_handle_gpu.ptr, count);
+				_current_transient_tail = allocation_end;
 
-			_current_static_index += count;
+				if (owner != nullptr)
+				{
+					if (const auto it = std::find_if(_transient_owners.begin(), _transient_owners.end(), [owner](const transient_owner &item) { return item.key == owner; });
+						it != _transient_owners.end() && it->pending_begin == UINT64_MAX)
+						it->pending_begin = allocation_start;
+				}
 
-			return true;
+				return true;
+			}
 		}
-		bool allocate_transient(UINT count, D3D12_CPU_DESCRIPTOR_HANDLE &base_handle, D3D12_GPU_DESCRIPTOR_HANDLE &base_handle_gpu)
+
+		/// <summary>
+		/// Starts tracking transient descriptors allocated for the specified <paramref name="owner"/> (e.g. a command list that is submitted to a queue), so that they are not overwritten before the GPU finished using them.
+		/// Every owner has its own list of fences, so that fences signaled on one queue never release descriptors that are still in use on another queue.
+		/// </summary>
+		void register_transient_owner(const void *owner)
 		{
 			if (_heap == nullptr)
-				return false;
+				return;
 
 			const std::unique_lock<std::shared_mutex> lock(_mutex);
 
-			SIZE_T index = static_cast<SIZE_T>(_current_transient_tail % transient_size);
-
-			// Allocations need to be contiguous
-			if (index + count > transient_size)
-				_current_transient_tail += transient_size - index, index = 0;
+			_transient_owners.push_back({ owner });
+		}
+		/// <summary>
+		/// Stops tracking transient descriptors allocated for the specified <paramref name="owner"/>.
+		/// Descriptors that were already signaled stay in use until their fences complete.
+		/// </summary>
+		void unregister_transient_owner(const void *owner)
+		{
+			if (_heap == nullptr)
+				return;
 
-			const SIZE_T offset = index * _increment_size;
-			base_handle.ptr = _transient_heap_base + offset;
-			base_handle_gpu.ptr = _transient_heap_base_gpu + offset;
+			const std::unique_lock<std::shared_mutex> lock(_mutex);
 
-			_current_transient_tail += count;
+			if (const auto it = std::find_if(_transient_owners.begin(), _transient_owners.end(), [owner](const transient_owner &item) { return item.key == owner; });
+				it != _transient_owners.end())
+			{
+				it->key = nullptr;
+				it->pending_begin = UINT64_MAX;
+			}
 
-			return true;
+			retire_transient();
 		}
 
-		void free(D3D12_GPU_DESCRIPTOR_HANDLE base_handle_gpu)
+		/// <summary>
+		/// Marks all transient descriptors allocated for the specified <paramref name="owner"/> since its last signal as being in use by the GPU until the specified <paramref name="fence"/> reaches the specified <paramref name="value"/>.
+		/// Must be called after the command lists using those descriptors were submitted and the queue was asked to signal the fence.
+		/// </summary>
+		void signal_transient(const void *owner, ID3D12Fence *fence, UINT64 value)
 		{
-			// Ensure this handle falls into the static range of this heap
-			if (base_handle_gpu.ptr < _static_heap_base_gpu || base_handle_gpu.ptr >= _transient_heap_base_gpu)
+			if (_heap == nullptr)
 				return;
 
-			UINT count = 1;
-
 			const std::unique_lock<std::shared_mutex> lock(_mutex);
 
-			// Find the number of descriptors allocated for this base handle
-			for (auto it = _count_list.begin(); it != _count_list.end(); ++it)
+			if (const auto it = std::find_if(_transient_owners.begin(), _transient_owners.end(), [owner](const transient_owner &item) { return item.key == owner; });
+				it != _transient_owners.end() && it->pending_begin != UINT64_MAX) // Nothing to do if no descriptors were allocated since the last signal
 			{
-				if (base_handle_gpu.ptr == it->first)
-				{
-					count = it->second;
-					_count_list.erase(it);
-					break;
-				}
+				it->fences.push_back({ fence, value, it->pending_begin });
+				it->pending_begin = UINT64_MAX;
 			}
 
-			// First try to append to an existing freed block
-			for (auto block = _free_list.begin(); block != _free_list.end(); ++block)
-			{
-				if (base_handle_gpu.ptr == block->second)
-				{
-					block->second += count * _increment_size;
+			// Retire descriptors the GPU is already done with, to keep the lists short
+			retire_transient();
+		}
 
-					// Try and merge with other blocks that are adjacent
-					for (auto block_adj = _free_list.begin(); block_adj != _free_list.end(); ++block_adj)
-					{
-						if (block_adj->first == block->second)
-						{
-							block->second = block_adj->second;
-							_free_list.erase(block_adj);
-							break;
-						}
-					}
-					return;
-				}
-				if (base_handle_gpu.ptr == (block->first - (count * _increment_size)))
-				{
-					block->first -= count * _increment_size;
+		void free(D3D12_GPU_DESCRIPTOR_HANDLE base_handle_gpu)
+		{
+			// Ensure this handle falls into the static range of this heap
+			if (base_handle_gpu.ptr < _static_heap_base_gpu || base_handle_gpu.ptr >= _transient_heap_base_gpu)
+				return;
 
-					// Try and merge with other blocks that are adjacent
-					for (auto block_adj = _free_list.begin(); block_adj != _free_list.end(); ++block_adj)
-					{
-						if (block_adj->second == block->first)
-						{
-							block->first = block_adj->first;
-							_free_list.erase(block_adj);
-							break;
-						}
-					}
-					return;
-				}
-			}
+			const std::unique_lock<std::shared_mutex> lock(_mutex);
 
-			// Otherwise add a new block to the free list
-			_free_list.emplace_back(base_handle_gpu.ptr, base_handle_gpu.ptr + count * _increment_size);
+			_static_allocator.free(static_cast<UINT>((base_handle_gpu.ptr - _static_heap_base_gpu) / _increment_size));
 		}
 
 		bool contains(D3D12_GPU_DESCRIPTOR_HANDLE handle_gpu) const
@@ -280,19 +727,71 @@ namespace reshade::d3d12
 			}
 		}
 
+		/// <summary>
+		/// Gets the current occupancy and fragmentation of the static portion of the heap.
+		/// </summary>
+		descriptor_range_allocator::statistics get_static_statistics() const
+		{
+			const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+			return _static_allocator.get_statistics();
+		}
+
 		ID3D12DescriptorHeap *get() const { assert(_heap != nullptr); return _heap.get(); }
 
 	private:
+		struct transient_fence
+		{
+			com_ptr<ID3D12Fence> fence;
+			UINT64 value;
+			UINT64 begin; // Transient descriptors of the owner from this position on are in use until the fence reaches the value
+		};
+		struct transient_owner
+		{
+			const void *key;
+			std::deque<transient_fence> fences;
+			UINT64 pending_begin = UINT64_MAX; // Position of the first transient descriptor allocated since the last signal
+
+			UINT64 oldest() const { return fences.empty() ? pending_begin : fences.front().begin; }
+		};
+
+		/// <summary>
+		/// Drops fences that completed and advances the head to the oldest transient descriptor any owner still uses.
+		/// </summary>
+		void retire_transient()
+		{
+			UINT64 head = _current_transient_tail;
+
+			for (auto it = _transient_owners.begin(); it != _transient_owners.end();)
+			{
+				while (!it->fences.empty() && it->fences.front().fence->GetCompletedValue() >= it->fences.front().value)
+					it->fences.pop_front();
+
+				// Owners that were unregistered are only kept around until all their descriptors retired
+				if (it->key == nullptr && it->fences.empty())
+				{
+					it = _transient_owners.erase(it);
+					continue;
+				}
+
+				head = std::min(head, it->oldest());
+				++it;
+			}
+
+			// Never move the head backwards, descriptors before it may already have been overwritten
+			_current_transient_head = std::max(_current_transient_head, head);
+		}
+
 		com_ptr<ID3D12DescriptorHeap> _heap;
 		SIZE_T _increment_size;
 		SIZE_T _static_heap_base;
 		UINT64 _static_heap_base_gpu;
 		SIZE_T _transient_heap_base;
 		UINT64 _transient_heap_base_gpu;
-		SIZE_T _current_static_index = 0;
+		UINT64 _current_transient_head = 0;
 		UINT64 _current_transient_tail = 0;
-		std::vector<std::pair<UINT64, UINT64>> _free_list;
-		std::vector<std::pair<UINT64, UINT32>> _count_list;
-		std::shared_mutex _mutex;
+		std::vector<transient_owner> _transient_owners;
+		descriptor_range_allocator _static_allocator;
+		mutable std::shared_mutex _mutex;
 	};
 }
@@ -377,6 +377,9 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD fdwReason, LPVOID)
 
 			reshade::hooks::uninstall();
 
+			// Make sure changes to INI files are not lost, in case the process is exiting and the background thread that saves them was terminated
+			reshade::ini_file::flush_pending_saves();
+
 			// Module is now invalid, so break out of any message loops that may still have it in the call stack (see 'HookGetMessage' implementation in input.cpp)
 			// This is necessary since a different thread may have called into the 'GetMessage' hook from ReShade, but may not receive a message until after the ReShade module was unloaded
 			// At that point it would return to code that was already unloaded and crash
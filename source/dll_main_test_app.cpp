@@ -11,12 +11,26 @@
 #include "addon_manager.hpp"
 #include "com_ptr.hpp"
 #include "ini_file.hpp"
+#include "effect_lexer.hpp"
+#include "effect_preprocessor.hpp"
+#include "effect_parser.hpp"
+#include "effect_codegen.hpp"
+#include "effect_cache.hpp"
 #include <d3d9.h>
 #include <d3d11.h>
 #include <d3d12.h>
 #include <D3D12Downlevel.h>
 #include <glad/wgl.h>
 #include <glad/vulkan.h>
+#include <chrono>
+#include <thread>
+#include "dll_main_test_app_mocks.hpp"
+#include "d3d9/d3d9_impl_state_block.hpp"
+#include "d3d10/d3d10_impl_state_block.hpp"
+#include "d3d11/d3d11_impl_state_block.hpp"
+#include "d3d12/descriptor_heap.hpp"
+#include "opengl/opengl_impl_device.hpp"
+#include "opengl/opengl_impl_state_block.hpp"
 
 extern HMODULE g_module_handle;
 extern std::filesystem::path g_reshade_dll_path;
@@ -62,6 +76,321 @@ static LONG APIENTRY HookD3DKMTQueryAdapterInfo(const void *pData)
 	return reshade::hooks::call(HookD3DKMTQueryAdapterInfo)(pData);
 }
 
+static std::string generate_benchmark_effect(int num_functions)
+{
+	// Lean on function-like macros and use distinct constants in every function, like big shader libraries do
+	std::string source =
+		"#define BUFFER_PIXEL_SIZE float2(1.0 / 1920.0, 1.0 / 1080.0)\n"
+		"#define SCALE(x, s) ((x) * (s))\n"
+		"#define LERP3(a, b, t) lerp(SCALE(a, 1.0), SCALE(b, 1.0), t)\n"
+		"#define SAMPLE_OFFSET(tex, uv, x, y) tex2D(tex, (uv) + SCALE(float2(x, y), BUFFER_PIXEL_SIZE))\n"
+		"texture BackBufferTex : COLOR;\n"
+		"sampler BackBuffer { Texture = BackBufferTex; };\n"
+		"void VS(uint id : SV_VertexID, out float4 position : SV_Position, out float2 uv : TEXCOORD)\n"
+		"{\n"
+		"\tuv = float2((id == 2) ? 2.0 : 0.0, (id == 1) ? 2.0 : 0.0);\n"
+		"\tposition = float4(uv * float2(2.0, -2.0) + float2(-1.0, 1.0), 0.0, 1.0);\n"
+		"}\n";
+
+	for (int i = 0; i < num_functions; ++i)
+	{
+		const std::string index = std::to_string(i);
+		source +=
+			"float4 Func" + index + "(float2 uv)\n"
+			"{\n"
+			"\t// Function " + index + "\n"
+			"\tfloat4 color = SAMPLE_OFFSET(BackBuffer, uv, " + std::to_string(i % 7) + ".0, " + std::to_string(i % 5) + ".0);\n"
+			"\tcolor.rgb = LERP3(color.rgb, float3(" + index + ".25, " + index + ".5, " + index + ".75), " + index + ".0 / " + std::to_string(num_functions) + ".0);\n"
+			"\treturn color;\n"
+			"}\n";
+	}
+
+	source += "float4 PS(float4 position : SV_Position, float2 uv : TEXCOORD) : SV_Target\n{\n\tfloat4 color = 0.0;\n";
+	for (int i = 0; i < num_functions; ++i)
+		source += "\tcolor += Func" + std::to_string(i) + "(uv);\n";
+	source += "\treturn color / " + std::to_string(num_functions) + ".0;\n}\n";
+	source += "technique Benchmark { pass { VertexShader = VS; PixelShader = PS; } }\n";
+
+	return source;
+}
+
+// Runs the workload and logs how long it took, together with the throughput based on the number of operations the workload returns
+// All benchmarks go through this, so that they only have to provide their workload and report results the same way
+template <typename F>
+static double run_benchmark(const std::string &name, F &&workload)
+{
+	const auto start_time = std::chrono::high_resolution_clock::now();
+	const size_t num_operations = workload();
+	const auto end_time = std::chrono::high_resolution_clock::now();
+
+	const double duration = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+	reshade::log::message(reshade::log::level::info, "%s: %zu operations in %.3f ms (%.0f operations per second).", name.c_str(), num_operations, duration, num_operations * 1000.0 / std::max(duration, 0.001));
+	return duration;
+}
+
+static void benchmark_hooks()
+{
+	// Measure how long it takes to resolve the trampoline of a hook, which happens in every call to a hooked function
+	const auto target = reinterpret_cast<reshade::hook::address>(GetProcAddress(GetModuleHandleW(L"gdi32.dll"), "D3DKMTQueryAdapterInfo"));
+
+	run_benchmark("Resolve hook pairs", [target]() -> size_t {
+		constexpr size_t num_iterations = 10000000;
+		for (size_t i = 0; i < num_iterations; ++i)
+			if (reshade::hooks::call(HookD3DKMTQueryAdapterInfo) == nullptr || reshade::hooks::find_trampoline(target) == nullptr)
+				return i;
+		return num_iterations;
+	});
+}
+
+static void benchmark_descriptor_heaps()
+{
+	// Run the allocator in isolation, since only its bookkeeping is measured here and not how long the driver takes to create heaps
+	mock_d3d12_device device;
+
+	reshade::d3d12::descriptor_heap_cpu heap(&device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+	// Keep a large number of descriptors alive with some holes in between, like after a game streamed in and out resources for a while
+	std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> persistent_handles(50000);
+	for (D3D12_CPU_DESCRIPTOR_HANDLE &handle : persistent_handles)
+		heap.allocate(handle);
+	for (size_t i = 0; i < persistent_handles.size(); i += 7)
+		heap.free(persistent_handles[i]);
+
+	// Then measure how long it takes multiple threads to create and destroy views concurrently
+	const unsigned int num_threads = std::max(std::thread::hardware_concurrency(), 4u);
+
+	run_benchmark("Allocate and free descriptors on " + std::to_string(num_threads) + " threads", [&heap, num_threads]() -> size_t {
+		constexpr size_t num_iterations = 1000000;
+
+		std::vector<std::thread> threads;
+		for (unsigned int t = 0; t < num_threads; ++t)
+		{
+			threads.emplace_back([&heap]() {
+				std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> handles;
+				for (size_t i = 0; i < num_iterations; ++i)
+				{
+					if (handles.size() < 64 && (i % 3) != 2)
+					{
+						if (D3D12_CPU_DESCRIPTOR_HANDLE handle; heap.allocate(handle))
+							handles.push_back(handle);
+					}
+					else if (!handles.empty())
+					{
+						heap.free(handles.back());
+						handles.pop_back();
+					}
+				}
+				for (const D3D12_CPU_DESCRIPTOR_HANDLE handle : handles)
+					heap.free(handle);
+			});
+		}
+		for (std::thread &thread : threads)
+			thread.join();
+
+		// Report the total over all threads
+		return num_iterations * num_threads;
+	});
+
+	for (size_t i = 0; i < persistent_handles.size(); ++i)
+		if (i % 7 != 0)
+			heap.free(persistent_handles[i]);
+}
+
+static void benchmark_state_blocks()
+{
+	// Run against devices that do nothing, so that only the cost of capturing and applying state in ReShade is measured and not how long the driver takes for it
+	constexpr size_t num_iterations = 100000;
+
+	// Compare capturing all state with capturing only what a typical effect without compute passes modifies
+	const auto benchmark_subsets = [](const char *api_name, const auto &capture_and_apply) {
+		const reshade::api::state_block_subset subsets[2] = { {}, { 1, 1, 1, false, false } };
+		for (const reshade::api::state_block_subset &subset : subsets)
+		{
+			run_benchmark(std::string(subset.compute ? "Capture and apply all " : "Capture and apply a subset of the ") + api_name + " state", [&]() -> size_t {
+				for (size_t i = 0; i < num_iterations; ++i)
+					capture_and_apply(subset);
+				return num_iterations;
+			});
+		}
+	};
+
+	{
+		mock_d3d9_device device;
+		reshade::d3d9::state_block state_block(&device);
+
+		// D3D9 always captures all state, since it uses a state block object of the runtime for that
+		run_benchmark("Capture and apply all D3D9 state", [&state_block]() -> size_t {
+			for (size_t i = 0; i < num_iterations; ++i)
+			{
+				state_block.capture();
+				state_block.apply_and_release();
+			}
+			return num_iterations;
+		});
+	}
+
+	{
+		mock_d3d10_device device;
+		reshade::d3d10::state_block state_block(&device);
+
+		benchmark_subsets("D3D10", [&state_block](const reshade::api::state_block_subset &subset) {
+			state_block.capture(subset);
+			state_block.apply_and_release();
+		});
+	}
+
+	{
+		mock_d3d11_device device;
+		mock_d3d11_device_context device_context;
+		reshade::d3d11::state_block state_block(&device);
+
+		benchmark_subsets("D3D11", [&state_block, &device_context](const reshade::api::state_block_subset &subset) {
+			state_block.capture(&device_context, subset);
+			state_block.apply_and_release();
+		});
+	}
+
+	{
+		reshade::opengl::device_impl device(nullptr, nullptr, mock_gl_dispatch_table());
+		reshade::opengl::state_block state_block(&device);
+
+		benchmark_subsets("OpenGL", [&state_block](const reshade::api::state_block_subset &subset) {
+			state_block.capture(subset);
+			state_block.apply();
+		});
+	}
+}
+
+static void benchmark_lexer()
+{
+	// Lex the preprocessed output, which is what the parser sees, and the raw source, which is what the preprocessor sees
+	reshadefx::preprocessor pp;
+	pp.append_string(generate_benchmark_effect(500));
+	const std::string preprocessed = pp.output();
+	const std::string source = generate_benchmark_effect(500);
+
+	// Compare lexing a copy of the input, which is what every lexer had to do before it could reference its input, against referencing it
+	for (const bool borrow : { false, true })
+	{
+		run_benchmark(borrow ? "Lex tokens referencing the input" : "Lex tokens from a copy of the input", [&]() -> size_t {
+			size_t num_tokens = 0;
+			for (int i = 0; i < 100; ++i)
+			{
+				for (const std::string *input : { &preprocessed, &source })
+				{
+					reshadefx::lexer lexer = borrow ?
+						reshadefx::lexer(reshadefx::lexer::borrow_input, *input, true, true, input == &preprocessed) :
+						reshadefx::lexer(std::string(*input), true, true, input == &preprocessed);
+					while (lexer.lex().id != reshadefx::tokenid::end_of_file)
+						num_tokens++;
+				}
+			}
+			return num_tokens;
+		});
+	}
+}
+
+static void benchmark_spirv_codegen()
+{
+	reshade::effect_cache_key key;
+	key.renderer_id = 0x20000; // Vulkan
+	key.width = 1920;
+	key.height = 1080;
+	key.color_format = reshade::api::format::r8g8b8a8_unorm;
+	reshade::global_config().get("GENERAL", "EffectSearchPaths", key.search_paths);
+
+	// Preprocess the effects in the configured effect search paths (e.g. the shaders installed alongside ReShade) up front, so that only parsing and code generation is measured
+	std::error_code ec;
+	std::vector<std::pair<std::string, std::string>> effects;
+	const std::set<std::filesystem::path> include_paths = key.resolve_include_paths(g_reshade_base_path);
+	for (const std::filesystem::path &include_path : include_paths)
+	{
+		for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
+		{
+			if (entry.path().extension() != L".fx")
+				continue;
+
+			key.source_file = entry.path();
+
+			reshadefx::preprocessor pp;
+			key.setup_preprocessor(pp, false, include_paths);
+			if (pp.append_file(entry.path()))
+				effects.emplace_back(entry.path().filename().u8string(), pp.output());
+		}
+	}
+
+	if (effects.empty())
+		reshade::log::message(reshade::log::level::warning, "Found no effects in the effect search paths, so only the generated effect is measured.");
+
+	// Keep a generated effect with a large number of functions as an additional stress case
+	{
+		reshadefx::preprocessor pp;
+		pp.append_string(generate_benchmark_effect(500));
+		effects.emplace_back("generated", pp.output());
+	}
+
+	// Compare with and without the optimizations in the parser (see 'NoEffectOptimization' setting), both in how long code generation takes and how much code it produces
+	for (const bool optimize : { true, false })
+	{
+		const char *const mode = optimize ? "with optimizations" : "without optimizations";
+
+		size_t num_effects = 0;
+		size_t total_code_size = 0;
+		double total_duration = 0;
+		for (const std::pair<std::string, std::string> &effect : effects)
+		{
+			bool success = true;
+			size_t code_size = 0;
+			const double duration = run_benchmark("Generate SPIR-V for '" + effect.first + "' " + mode, [&effect, optimize, &success, &code_size]() -> size_t {
+				constexpr size_t num_iterations = 20;
+				for (size_t i = 0; i < num_iterations; ++i)
+				{
+					const std::unique_ptr<reshadefx::codegen> codegen(reshadefx::create_codegen_spirv(true, false, false));
+
+					reshadefx::parser parser;
+					if (!parser.parse(effect.second, codegen.get(), optimize))
+					{
+						success = false;
+						return i;
+					}
+
+					if (i == 0)
+						code_size = codegen->finalize_code().size();
+				}
+				return num_iterations;
+			});
+
+			if (!success)
+			{
+				reshade::log::message(reshade::log::level::warning, "Failed to compile '%s' %s, skipping it.", effect.first.c_str(), mode);
+				continue;
+			}
+
+			num_effects++;
+			total_code_size += code_size;
+			total_duration += duration;
+		}
+
+		reshade::log::message(reshade::log::level::info, "Generated %zu bytes of SPIR-V for %zu effects %s in %.3f ms.", total_code_size, num_effects, mode, total_duration);
+	}
+}
+
+static void benchmark_preprocessor()
+{
+	const std::string source = generate_benchmark_effect(500);
+
+	run_benchmark("Preprocess effects", [&source]() -> size_t {
+		constexpr size_t num_iterations = 100;
+		for (size_t i = 0; i < num_iterations; ++i)
+		{
+			reshadefx::preprocessor pp;
+			if (!pp.append_string(source))
+				return i;
+		}
+		return num_iterations;
+	});
+}
+
 int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow)
 {
 	g_module_handle = hInstance;
@@ -76,6 +405,26 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE, LPSTR lpCmdLine, int nCmdShow
 
 	reshade::hooks::install("D3DKMTQueryAdapterInfo", GetProcAddress(GetModuleHandleW(L"gdi32.dll"), "D3DKMTQueryAdapterInfo"), HookD3DKMTQueryAdapterInfo);
 
+	// Run a benchmark instead of the test application if one was requested
+	static const std::pair<const char *, void(*)()> benchmarks[] = {
+		{ "-benchmark-hooks", benchmark_hooks },
+		{ "-benchmark-descriptor-heaps", benchmark_descriptor_heaps },
+		{ "-benchmark-state-blocks", benchmark_state_blocks },
+		{ "-benchmark-lexer", benchmark_lexer },
+		{ "-benchmark-spirv-codegen", benchmark_spirv_codegen },
+		{ "-benchmark-preprocessor", benchmark_preprocessor },
+	};
+	for (const auto &[name, benchmark] : benchmarks)
+	{
+		if (strstr(lpCmdLine, name))
+		{
+			benchmark();
+
+			reshade::hooks::uninstall();
+			return 0;
+		}
+	}
+
 	static UINT s_resize_w = 0, s_resize_h = 0;
 
 	// Register window class
@@ -0,0 +1,705 @@
+/*
+ * Copyright (C) 2022 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <d3d9.h>
+#include <d3d10_1.h>
+#include <d3d11.h>
+#include <d3d12.h>
+#include <glad/gl.h>
+
+// Devices that accept every call and do nothing, so that the CPU overhead of ReShade code can be measured in isolation from any driver
+// Getters leave their output arguments untouched and creating objects fails, unless it is needed by the code under test
+
+struct mock_d3d9_state_block final : IDirect3DStateBlock9
+{
+	explicit mock_d3d9_state_block(IDirect3DDevice9 *device) : _device(device) {}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObj) override
+	{
+		if (ppvObj == nullptr)
+			return E_POINTER;
+		if (riid != __uuidof(IUnknown) && riid != __uuidof(IDirect3DStateBlock9))
+		{
+			*ppvObj = nullptr;
+			return E_NOINTERFACE;
+		}
+		AddRef();
+		*ppvObj = this;
+		return S_OK;
+	}
+	ULONG   STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&_ref); }
+	ULONG   STDMETHODCALLTYPE Release() override
+	{
+		const ULONG ref = InterlockedDecrement(&_ref);
+		if (ref == 0)
+			delete this;
+		return ref;
+	}
+
+	HRESULT STDMETHODCALLTYPE GetDevice(IDirect3DDevice9 **ppDevice) override
+	{
+		if (ppDevice == nullptr)
+			return D3DERR_INVALIDCALL;
+		_device->AddRef();
+		*ppDevice = _device;
+		return D3D_OK;
+	}
+	HRESULT STDMETHODCALLTYPE Capture() override { return D3D_OK; }
+	HRESULT STDMETHODCALLTYPE Apply() override { return D3D_OK; }
+
+private:
+	ULONG _ref = 1;
+	IDirect3DDevice9 *const _device;
+};
+
+struct mock_d3d9_device final : IDirect3DDevice9
+{
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObj) override
+	{
+		if (ppvObj == nullptr)
+			return E_POINTER;
+		if (riid != __uuidof(IUnknown) && riid != __uuidof(IDirect3DDevice9))
+		{
+			*ppvObj = nullptr;
+			return E_NOINTERFACE;
+		}
+		*ppvObj = this;
+		return S_OK;
+	}
+	// Lives on the stack for the duration of a benchmark, so does not need reference counting
+	ULONG   STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG   STDMETHODCALLTYPE Release() override { return 1; }
+
+	HRESULT STDMETHODCALLTYPE TestCooperativeLevel() override { return S_OK; }
+	UINT    STDMETHODCALLTYPE GetAvailableTextureMem() override { return {}; }
+	HRESULT STDMETHODCALLTYPE EvictManagedResources() override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetDirect3D(IDirect3D9 **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE GetDeviceCaps(D3DCAPS9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetDisplayMode(UINT, D3DDISPLAYMODE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE GetCreationParameters(D3DDEVICE_CREATION_PARAMETERS *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetCursorProperties(UINT, UINT, IDirect3DSurface9 *) override { return S_OK; }
+	void    STDMETHODCALLTYPE SetCursorPosition(int, int, DWORD) override {}
+	BOOL    STDMETHODCALLTYPE ShowCursor(BOOL) override { return {}; }
+	HRESULT STDMETHODCALLTYPE CreateAdditionalSwapChain(D3DPRESENT_PARAMETERS *, IDirect3DSwapChain9 **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE GetSwapChain(UINT, IDirect3DSwapChain9 **) override { return E_NOTIMPL; }
+	   UINT STDMETHODCALLTYPE GetNumberOfSwapChains() override { return {}; }
+	HRESULT STDMETHODCALLTYPE Reset(D3DPRESENT_PARAMETERS *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE Present(const RECT *, const RECT *, HWND, const RGNDATA *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetBackBuffer(UINT, UINT, D3DBACKBUFFER_TYPE, IDirect3DSurface9 **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE GetRasterStatus(UINT, D3DRASTER_STATUS *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetDialogBoxMode(BOOL) override { return S_OK; }
+	void    STDMETHODCALLTYPE SetGammaRamp(UINT, DWORD, const D3DGAMMARAMP *) override {}
+	void    STDMETHODCALLTYPE GetGammaRamp(UINT, D3DGAMMARAMP *) override {}
+	HRESULT STDMETHODCALLTYPE CreateTexture(UINT, UINT, UINT, DWORD, D3DFORMAT, D3DPOOL, IDirect3DTexture9 **, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateVolumeTexture(UINT, UINT, UINT, UINT, DWORD, D3DFORMAT, D3DPOOL, IDirect3DVolumeTexture9 **, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateCubeTexture(UINT, UINT, DWORD, D3DFORMAT, D3DPOOL, IDirect3DCubeTexture9 **, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateVertexBuffer(UINT, DWORD, DWORD, D3DPOOL, IDirect3DVertexBuffer9 **, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateIndexBuffer(UINT, DWORD, D3DFORMAT, D3DPOOL, IDirect3DIndexBuffer9 **, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateRenderTarget(UINT, UINT, D3DFORMAT, D3DMULTISAMPLE_TYPE, DWORD, BOOL, IDirect3DSurface9 **, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateDepthStencilSurface(UINT, UINT, D3DFORMAT, D3DMULTISAMPLE_TYPE, DWORD, BOOL, IDirect3DSurface9 **, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE UpdateSurface(IDirect3DSurface9 *, const RECT *, IDirect3DSurface9 *, const POINT *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE UpdateTexture(IDirect3DBaseTexture9 *, IDirect3DBaseTexture9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetRenderTargetData(IDirect3DSurface9 *, IDirect3DSurface9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetFrontBufferData(UINT, IDirect3DSurface9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE StretchRect(IDirect3DSurface9 *, const RECT *, IDirect3DSurface9 *, const RECT *, D3DTEXTUREFILTERTYPE) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE ColorFill(IDirect3DSurface9 *, const RECT *, D3DCOLOR) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE CreateOffscreenPlainSurface(UINT, UINT, D3DFORMAT, D3DPOOL, IDirect3DSurface9 **, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetRenderTarget(DWORD, IDirect3DSurface9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetRenderTarget(DWORD, IDirect3DSurface9 **) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetDepthStencilSurface(IDirect3DSurface9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetDepthStencilSurface(IDirect3DSurface9 **) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE BeginScene() override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE EndScene() override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE Clear(DWORD, const D3DRECT *, DWORD, D3DCOLOR, float, DWORD) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetTransform(D3DTRANSFORMSTATETYPE, const D3DMATRIX *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetTransform(D3DTRANSFORMSTATETYPE, D3DMATRIX *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE MultiplyTransform(D3DTRANSFORMSTATETYPE, const D3DMATRIX *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetViewport(const D3DVIEWPORT9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetViewport(D3DVIEWPORT9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetMaterial(const D3DMATERIAL9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetMaterial(D3DMATERIAL9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetLight(DWORD, const D3DLIGHT9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetLight(DWORD, D3DLIGHT9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE LightEnable(DWORD, BOOL) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetLightEnable(DWORD, BOOL *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetClipPlane(DWORD, const float *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetClipPlane(DWORD, float *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetRenderState(D3DRENDERSTATETYPE, DWORD) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetRenderState(D3DRENDERSTATETYPE, DWORD *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE CreateStateBlock(D3DSTATEBLOCKTYPE, IDirect3DStateBlock9 **ppSB) override
+	{
+		if (ppSB == nullptr)
+			return D3DERR_INVALIDCALL;
+		*ppSB = new mock_d3d9_state_block(this);
+		return D3D_OK;
+	}
+	HRESULT STDMETHODCALLTYPE BeginStateBlock() override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE EndStateBlock(IDirect3DStateBlock9 **) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetClipStatus(const D3DCLIPSTATUS9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetClipStatus(D3DCLIPSTATUS9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetTexture(DWORD, IDirect3DBaseTexture9 **) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetTexture(DWORD, IDirect3DBaseTexture9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetTextureStageState(DWORD, D3DTEXTURESTAGESTATETYPE, DWORD *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetTextureStageState(DWORD, D3DTEXTURESTAGESTATETYPE, DWORD) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetSamplerState(DWORD, D3DSAMPLERSTATETYPE, DWORD *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetSamplerState(DWORD, D3DSAMPLERSTATETYPE, DWORD) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE ValidateDevice(DWORD *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetPaletteEntries(UINT, const PALETTEENTRY *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetPaletteEntries(UINT, PALETTEENTRY *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetCurrentTexturePalette(UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetCurrentTexturePalette(UINT *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetScissorRect(const RECT *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetScissorRect(RECT *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetSoftwareVertexProcessing(BOOL) override { return S_OK; }
+	BOOL    STDMETHODCALLTYPE GetSoftwareVertexProcessing() override { return {}; }
+	HRESULT STDMETHODCALLTYPE SetNPatchMode(float) override { return S_OK; }
+	float   STDMETHODCALLTYPE GetNPatchMode() override { return {}; }
+	HRESULT STDMETHODCALLTYPE DrawPrimitive(D3DPRIMITIVETYPE, UINT, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE DrawIndexedPrimitive(D3DPRIMITIVETYPE, INT, UINT, UINT, UINT, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE DrawPrimitiveUP(D3DPRIMITIVETYPE, UINT, const void *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE, UINT, UINT, UINT, const void *, D3DFORMAT, const void *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE ProcessVertices(UINT, UINT, UINT, IDirect3DVertexBuffer9 *, IDirect3DVertexDeclaration9 *, DWORD) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE CreateVertexDeclaration(const D3DVERTEXELEMENT9 *, IDirect3DVertexDeclaration9 **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetVertexDeclaration(IDirect3DVertexDeclaration9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetVertexDeclaration(IDirect3DVertexDeclaration9 **) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetFVF(DWORD) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetFVF(DWORD *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE CreateVertexShader(const DWORD *, IDirect3DVertexShader9 **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetVertexShader(IDirect3DVertexShader9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetVertexShader(IDirect3DVertexShader9 **) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetVertexShaderConstantF(UINT, const float *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetVertexShaderConstantF(UINT, float *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetVertexShaderConstantI(UINT, const int *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetVertexShaderConstantI(UINT, int *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetVertexShaderConstantB(UINT, const BOOL *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetVertexShaderConstantB(UINT, BOOL *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetStreamSource(UINT, IDirect3DVertexBuffer9 *, UINT, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetStreamSource(UINT, IDirect3DVertexBuffer9 **, UINT *, UINT *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetStreamSourceFreq(UINT, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetStreamSourceFreq(UINT, UINT *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetIndices(IDirect3DIndexBuffer9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetIndices(IDirect3DIndexBuffer9 **) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE CreatePixelShader(const DWORD *, IDirect3DPixelShader9 **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPixelShader(IDirect3DPixelShader9 *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetPixelShader(IDirect3DPixelShader9 **) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetPixelShaderConstantF(UINT, const float *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetPixelShaderConstantF(UINT, float *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetPixelShaderConstantI(UINT, const int *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetPixelShaderConstantI(UINT, int *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetPixelShaderConstantB(UINT, const BOOL *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE GetPixelShaderConstantB(UINT, BOOL *, UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE DrawRectPatch(UINT, const float *, const D3DRECTPATCH_INFO *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE DrawTriPatch(UINT, const float *, const D3DTRIPATCH_INFO *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE DeletePatch(UINT) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE CreateQuery(D3DQUERYTYPE, IDirect3DQuery9 **) override { return E_NOTIMPL; }
+};
+
+struct mock_d3d10_device final : ID3D10Device
+{
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObj) override
+	{
+		if (ppvObj == nullptr)
+			return E_POINTER;
+		if (riid != __uuidof(IUnknown) && riid != __uuidof(ID3D10Device))
+		{
+			*ppvObj = nullptr;
+			return E_NOINTERFACE;
+		}
+		*ppvObj = this;
+		return S_OK;
+	}
+	// Lives on the stack for the duration of a benchmark, so does not need reference counting
+	ULONG   STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG   STDMETHODCALLTYPE Release() override { return 1; }
+
+	void    STDMETHODCALLTYPE VSSetConstantBuffers(UINT, UINT, ID3D10Buffer *const *) override {}
+	void    STDMETHODCALLTYPE PSSetShaderResources(UINT, UINT, ID3D10ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE PSSetShader(ID3D10PixelShader *) override {}
+	void    STDMETHODCALLTYPE PSSetSamplers(UINT, UINT, ID3D10SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE VSSetShader(ID3D10VertexShader *) override {}
+	void    STDMETHODCALLTYPE DrawIndexed(UINT, UINT, INT) override {}
+	void    STDMETHODCALLTYPE Draw(UINT, UINT) override {}
+	void    STDMETHODCALLTYPE PSSetConstantBuffers(UINT, UINT, ID3D10Buffer *const *) override {}
+	void    STDMETHODCALLTYPE IASetInputLayout(ID3D10InputLayout *) override {}
+	void    STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, ID3D10Buffer *const *, const UINT *, const UINT *) override {}
+	void    STDMETHODCALLTYPE IASetIndexBuffer(ID3D10Buffer *, DXGI_FORMAT, UINT) override {}
+	void    STDMETHODCALLTYPE DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override {}
+	void    STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT) override {}
+	void    STDMETHODCALLTYPE GSSetConstantBuffers(UINT, UINT, ID3D10Buffer *const *) override {}
+	void    STDMETHODCALLTYPE GSSetShader(ID3D10GeometryShader *) override {}
+	void    STDMETHODCALLTYPE IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY) override {}
+	void    STDMETHODCALLTYPE VSSetShaderResources(UINT, UINT, ID3D10ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE VSSetSamplers(UINT, UINT, ID3D10SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE SetPredication(ID3D10Predicate *, BOOL) override {}
+	void    STDMETHODCALLTYPE GSSetShaderResources(UINT, UINT, ID3D10ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE GSSetSamplers(UINT, UINT, ID3D10SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE OMSetRenderTargets(UINT, ID3D10RenderTargetView *const *, ID3D10DepthStencilView *) override {}
+	void    STDMETHODCALLTYPE OMSetBlendState(ID3D10BlendState *, const FLOAT [4], UINT) override {}
+	void    STDMETHODCALLTYPE OMSetDepthStencilState(ID3D10DepthStencilState *, UINT) override {}
+	void    STDMETHODCALLTYPE SOSetTargets(UINT, ID3D10Buffer *const *, const UINT *) override {}
+	void    STDMETHODCALLTYPE DrawAuto() override {}
+	void    STDMETHODCALLTYPE RSSetState(ID3D10RasterizerState *) override {}
+	void    STDMETHODCALLTYPE RSSetViewports(UINT, const D3D10_VIEWPORT *) override {}
+	void    STDMETHODCALLTYPE RSSetScissorRects(UINT, const D3D10_RECT *) override {}
+	void    STDMETHODCALLTYPE CopySubresourceRegion(ID3D10Resource *, UINT, UINT, UINT, UINT, ID3D10Resource *, UINT, const D3D10_BOX *) override {}
+	void    STDMETHODCALLTYPE CopyResource(ID3D10Resource *, ID3D10Resource *) override {}
+	void    STDMETHODCALLTYPE UpdateSubresource(ID3D10Resource *, UINT, const D3D10_BOX *, const void *, UINT, UINT) override {}
+	void    STDMETHODCALLTYPE ClearRenderTargetView(ID3D10RenderTargetView *, const FLOAT [4]) override {}
+	void    STDMETHODCALLTYPE ClearDepthStencilView(ID3D10DepthStencilView *, UINT, FLOAT, UINT8) override {}
+	void    STDMETHODCALLTYPE GenerateMips(ID3D10ShaderResourceView *) override {}
+	void    STDMETHODCALLTYPE ResolveSubresource(ID3D10Resource *, UINT, ID3D10Resource *, UINT, DXGI_FORMAT) override {}
+	void    STDMETHODCALLTYPE VSGetConstantBuffers(UINT, UINT, ID3D10Buffer **) override {}
+	void    STDMETHODCALLTYPE PSGetShaderResources(UINT, UINT, ID3D10ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE PSGetShader(ID3D10PixelShader **) override {}
+	void    STDMETHODCALLTYPE PSGetSamplers(UINT, UINT, ID3D10SamplerState **) override {}
+	void    STDMETHODCALLTYPE VSGetShader(ID3D10VertexShader **) override {}
+	void    STDMETHODCALLTYPE PSGetConstantBuffers(UINT, UINT, ID3D10Buffer **) override {}
+	void    STDMETHODCALLTYPE IAGetInputLayout(ID3D10InputLayout **) override {}
+	void    STDMETHODCALLTYPE IAGetVertexBuffers(UINT, UINT, ID3D10Buffer **, UINT *, UINT *) override {}
+	void    STDMETHODCALLTYPE IAGetIndexBuffer(ID3D10Buffer **, DXGI_FORMAT *, UINT *) override {}
+	void    STDMETHODCALLTYPE GSGetConstantBuffers(UINT, UINT, ID3D10Buffer **) override {}
+	void    STDMETHODCALLTYPE GSGetShader(ID3D10GeometryShader **) override {}
+	void    STDMETHODCALLTYPE IAGetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY *) override {}
+	void    STDMETHODCALLTYPE VSGetShaderResources(UINT, UINT, ID3D10ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE VSGetSamplers(UINT, UINT, ID3D10SamplerState **) override {}
+	void    STDMETHODCALLTYPE GetPredication(ID3D10Predicate **, BOOL *) override {}
+	void    STDMETHODCALLTYPE GSGetShaderResources(UINT, UINT, ID3D10ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE GSGetSamplers(UINT, UINT, ID3D10SamplerState **) override {}
+	void    STDMETHODCALLTYPE OMGetRenderTargets(UINT, ID3D10RenderTargetView **, ID3D10DepthStencilView **) override {}
+	void    STDMETHODCALLTYPE OMGetBlendState(ID3D10BlendState **, FLOAT [4], UINT *) override {}
+	void    STDMETHODCALLTYPE OMGetDepthStencilState(ID3D10DepthStencilState **, UINT *) override {}
+	void    STDMETHODCALLTYPE SOGetTargets(UINT, ID3D10Buffer **, UINT *) override {}
+	void    STDMETHODCALLTYPE RSGetState(ID3D10RasterizerState **) override {}
+	void    STDMETHODCALLTYPE RSGetViewports(UINT *, D3D10_VIEWPORT *) override {}
+	void    STDMETHODCALLTYPE RSGetScissorRects(UINT *, D3D10_RECT *) override {}
+	HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetExceptionMode(UINT) override { return S_OK; }
+	UINT    STDMETHODCALLTYPE GetExceptionMode() override { return {}; }
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT *, void *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown *) override { return S_OK; }
+	void    STDMETHODCALLTYPE ClearState() override {}
+	void    STDMETHODCALLTYPE Flush() override {}
+	HRESULT STDMETHODCALLTYPE CreateBuffer(const D3D10_BUFFER_DESC *, const D3D10_SUBRESOURCE_DATA *, ID3D10Buffer **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateTexture1D(const D3D10_TEXTURE1D_DESC *, const D3D10_SUBRESOURCE_DATA *, ID3D10Texture1D **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateTexture2D(const D3D10_TEXTURE2D_DESC *, const D3D10_SUBRESOURCE_DATA *, ID3D10Texture2D **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateTexture3D(const D3D10_TEXTURE3D_DESC *, const D3D10_SUBRESOURCE_DATA *, ID3D10Texture3D **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateShaderResourceView(ID3D10Resource *, const D3D10_SHADER_RESOURCE_VIEW_DESC *, ID3D10ShaderResourceView **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateRenderTargetView(ID3D10Resource *, const D3D10_RENDER_TARGET_VIEW_DESC *, ID3D10RenderTargetView **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateDepthStencilView(ID3D10Resource *, const D3D10_DEPTH_STENCIL_VIEW_DESC *, ID3D10DepthStencilView **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateInputLayout(const D3D10_INPUT_ELEMENT_DESC *, UINT, const void *, SIZE_T, ID3D10InputLayout **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateVertexShader(const void *, SIZE_T, ID3D10VertexShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateGeometryShader(const void *, SIZE_T, ID3D10GeometryShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateGeometryShaderWithStreamOutput(const void *, SIZE_T, const D3D10_SO_DECLARATION_ENTRY *, UINT, UINT, ID3D10GeometryShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreatePixelShader(const void *, SIZE_T, ID3D10PixelShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateBlendState(const D3D10_BLEND_DESC *, ID3D10BlendState **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateDepthStencilState(const D3D10_DEPTH_STENCIL_DESC *, ID3D10DepthStencilState **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateRasterizerState(const D3D10_RASTERIZER_DESC *, ID3D10RasterizerState **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateSamplerState(const D3D10_SAMPLER_DESC *, ID3D10SamplerState **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateQuery(const D3D10_QUERY_DESC *, ID3D10Query **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreatePredicate(const D3D10_QUERY_DESC *, ID3D10Predicate **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateCounter(const D3D10_COUNTER_DESC *, ID3D10Counter **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CheckFormatSupport(DXGI_FORMAT, UINT *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CheckMultisampleQualityLevels(DXGI_FORMAT, UINT, UINT *) override { return E_NOTIMPL; }
+	void    STDMETHODCALLTYPE CheckCounterInfo(D3D10_COUNTER_INFO *) override {}
+	HRESULT STDMETHODCALLTYPE CheckCounter(const D3D10_COUNTER_DESC *, D3D10_COUNTER_TYPE *, UINT *, LPSTR, UINT *, LPSTR, UINT *, LPSTR, UINT *) override { return E_NOTIMPL; }
+	UINT    STDMETHODCALLTYPE GetCreationFlags() override { return {}; }
+	HRESULT STDMETHODCALLTYPE OpenSharedResource(HANDLE, REFIID, void **) override { return E_NOTIMPL; }
+	void    STDMETHODCALLTYPE SetTextFilterSize(UINT, UINT) override {}
+	void    STDMETHODCALLTYPE GetTextFilterSize(UINT *, UINT *) override {}
+};
+
+struct mock_d3d11_device final : ID3D11Device
+{
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObj) override
+	{
+		if (ppvObj == nullptr)
+			return E_POINTER;
+		if (riid != __uuidof(IUnknown) && riid != __uuidof(ID3D11Device))
+		{
+			*ppvObj = nullptr;
+			return E_NOINTERFACE;
+		}
+		*ppvObj = this;
+		return S_OK;
+	}
+	// Lives on the stack for the duration of a benchmark, so does not need reference counting
+	ULONG   STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG   STDMETHODCALLTYPE Release() override { return 1; }
+
+	HRESULT STDMETHODCALLTYPE CreateBuffer(const D3D11_BUFFER_DESC *, const D3D11_SUBRESOURCE_DATA *, ID3D11Buffer **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateTexture1D(const D3D11_TEXTURE1D_DESC *, const D3D11_SUBRESOURCE_DATA *, ID3D11Texture1D **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateTexture2D(const D3D11_TEXTURE2D_DESC *, const D3D11_SUBRESOURCE_DATA *, ID3D11Texture2D **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateTexture3D(const D3D11_TEXTURE3D_DESC *, const D3D11_SUBRESOURCE_DATA *, ID3D11Texture3D **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateShaderResourceView(ID3D11Resource *, const D3D11_SHADER_RESOURCE_VIEW_DESC *, ID3D11ShaderResourceView **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D11Resource *, const D3D11_UNORDERED_ACCESS_VIEW_DESC *, ID3D11UnorderedAccessView **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateRenderTargetView(ID3D11Resource *, const D3D11_RENDER_TARGET_VIEW_DESC *, ID3D11RenderTargetView **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateDepthStencilView(ID3D11Resource *, const D3D11_DEPTH_STENCIL_VIEW_DESC *, ID3D11DepthStencilView **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC *, UINT, const void *, SIZE_T, ID3D11InputLayout **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateVertexShader(const void *, SIZE_T, ID3D11ClassLinkage *, ID3D11VertexShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateGeometryShader(const void *, SIZE_T, ID3D11ClassLinkage *, ID3D11GeometryShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateGeometryShaderWithStreamOutput(const void *, SIZE_T, const D3D11_SO_DECLARATION_ENTRY *, UINT, const UINT *, UINT, UINT, ID3D11ClassLinkage *, ID3D11GeometryShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreatePixelShader(const void *, SIZE_T, ID3D11ClassLinkage *, ID3D11PixelShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateHullShader(const void *, SIZE_T, ID3D11ClassLinkage *, ID3D11HullShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateDomainShader(const void *, SIZE_T, ID3D11ClassLinkage *, ID3D11DomainShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateComputeShader(const void *, SIZE_T, ID3D11ClassLinkage *, ID3D11ComputeShader **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateClassLinkage(ID3D11ClassLinkage **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateBlendState(const D3D11_BLEND_DESC *, ID3D11BlendState **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC *, ID3D11DepthStencilState **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateRasterizerState(const D3D11_RASTERIZER_DESC *, ID3D11RasterizerState **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateSamplerState(const D3D11_SAMPLER_DESC *, ID3D11SamplerState **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateQuery(const D3D11_QUERY_DESC *, ID3D11Query **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreatePredicate(const D3D11_QUERY_DESC *, ID3D11Predicate **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateCounter(const D3D11_COUNTER_DESC *, ID3D11Counter **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateDeferredContext(UINT, ID3D11DeviceContext **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE OpenSharedResource(HANDLE, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CheckFormatSupport(DXGI_FORMAT, UINT *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CheckMultisampleQualityLevels(DXGI_FORMAT, UINT, UINT *) override { return E_NOTIMPL; }
+	void    STDMETHODCALLTYPE CheckCounterInfo(D3D11_COUNTER_INFO *) override {}
+	HRESULT STDMETHODCALLTYPE CheckCounter(const D3D11_COUNTER_DESC *, D3D11_COUNTER_TYPE *, UINT *, LPSTR, UINT *, LPSTR, UINT *, LPSTR, UINT *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D11_FEATURE, void *, UINT) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT *, void *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown *) override { return S_OK; }
+	UINT    STDMETHODCALLTYPE GetCreationFlags() override { return {}; }
+	HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override { return S_OK; }
+	void    STDMETHODCALLTYPE GetImmediateContext(ID3D11DeviceContext **) override {}
+	HRESULT STDMETHODCALLTYPE SetExceptionMode(UINT) override { return S_OK; }
+	UINT    STDMETHODCALLTYPE GetExceptionMode() override { return {}; }
+	D3D_FEATURE_LEVEL STDMETHODCALLTYPE GetFeatureLevel() override { return D3D_FEATURE_LEVEL_11_0; }
+};
+
+struct mock_d3d11_device_context final : ID3D11DeviceContext
+{
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObj) override
+	{
+		if (ppvObj == nullptr)
+			return E_POINTER;
+		if (riid != __uuidof(IUnknown) && riid != __uuidof(ID3D11DeviceChild) && riid != __uuidof(ID3D11DeviceContext))
+		{
+			*ppvObj = nullptr;
+			return E_NOINTERFACE;
+		}
+		*ppvObj = this;
+		return S_OK;
+	}
+	// Lives on the stack for the duration of a benchmark, so does not need reference counting
+	ULONG   STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG   STDMETHODCALLTYPE Release() override { return 1; }
+
+	void    STDMETHODCALLTYPE GetDevice(ID3D11Device **) override {}
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT *, void *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown *) override { return S_OK; }
+
+	void    STDMETHODCALLTYPE VSSetConstantBuffers(UINT, UINT, ID3D11Buffer *const *) override {}
+	void    STDMETHODCALLTYPE PSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE PSSetShader(ID3D11PixelShader *, ID3D11ClassInstance *const *, UINT) override {}
+	void    STDMETHODCALLTYPE PSSetSamplers(UINT, UINT, ID3D11SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE VSSetShader(ID3D11VertexShader *, ID3D11ClassInstance *const *, UINT) override {}
+	void    STDMETHODCALLTYPE DrawIndexed(UINT, UINT, INT) override {}
+	void    STDMETHODCALLTYPE Draw(UINT, UINT) override {}
+	HRESULT STDMETHODCALLTYPE Map(ID3D11Resource *, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE *) override { return E_NOTIMPL; }
+	void    STDMETHODCALLTYPE Unmap(ID3D11Resource *, UINT) override {}
+	void    STDMETHODCALLTYPE PSSetConstantBuffers(UINT, UINT, ID3D11Buffer *const *) override {}
+	void    STDMETHODCALLTYPE IASetInputLayout(ID3D11InputLayout *) override {}
+	void    STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, ID3D11Buffer *const *, const UINT *, const UINT *) override {}
+	void    STDMETHODCALLTYPE IASetIndexBuffer(ID3D11Buffer *, DXGI_FORMAT, UINT) override {}
+	void    STDMETHODCALLTYPE DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT) override {}
+	void    STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT) override {}
+	void    STDMETHODCALLTYPE GSSetConstantBuffers(UINT, UINT, ID3D11Buffer *const *) override {}
+	void    STDMETHODCALLTYPE GSSetShader(ID3D11GeometryShader *, ID3D11ClassInstance *const *, UINT) override {}
+	void    STDMETHODCALLTYPE IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY) override {}
+	void    STDMETHODCALLTYPE VSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE VSSetSamplers(UINT, UINT, ID3D11SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE Begin(ID3D11Asynchronous *) override {}
+	void    STDMETHODCALLTYPE End(ID3D11Asynchronous *) override {}
+	HRESULT STDMETHODCALLTYPE GetData(ID3D11Asynchronous *, void *, UINT, UINT) override { return E_NOTIMPL; }
+	void    STDMETHODCALLTYPE SetPredication(ID3D11Predicate *, BOOL) override {}
+	void    STDMETHODCALLTYPE GSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE GSSetSamplers(UINT, UINT, ID3D11SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE OMSetRenderTargets(UINT, ID3D11RenderTargetView *const *, ID3D11DepthStencilView *) override {}
+	void    STDMETHODCALLTYPE OMSetRenderTargetsAndUnorderedAccessViews(UINT, ID3D11RenderTargetView *const *, ID3D11DepthStencilView *, UINT, UINT, ID3D11UnorderedAccessView *const *, const UINT *) override {}
+	void    STDMETHODCALLTYPE OMSetBlendState(ID3D11BlendState *, const FLOAT [4], UINT) override {}
+	void    STDMETHODCALLTYPE OMSetDepthStencilState(ID3D11DepthStencilState *, UINT) override {}
+	void    STDMETHODCALLTYPE SOSetTargets(UINT, ID3D11Buffer *const *, const UINT *) override {}
+	void    STDMETHODCALLTYPE DrawAuto() override {}
+	void    STDMETHODCALLTYPE DrawIndexedInstancedIndirect(ID3D11Buffer *, UINT) override {}
+	void    STDMETHODCALLTYPE DrawInstancedIndirect(ID3D11Buffer *, UINT) override {}
+	void    STDMETHODCALLTYPE Dispatch(UINT, UINT, UINT) override {}
+	void    STDMETHODCALLTYPE DispatchIndirect(ID3D11Buffer *, UINT) override {}
+	void    STDMETHODCALLTYPE RSSetState(ID3D11RasterizerState *) override {}
+	void    STDMETHODCALLTYPE RSSetViewports(UINT, const D3D11_VIEWPORT *) override {}
+	void    STDMETHODCALLTYPE RSSetScissorRects(UINT, const D3D11_RECT *) override {}
+	void    STDMETHODCALLTYPE CopySubresourceRegion(ID3D11Resource *, UINT, UINT, UINT, UINT, ID3D11Resource *, UINT, const D3D11_BOX *) override {}
+	void    STDMETHODCALLTYPE CopyResource(ID3D11Resource *, ID3D11Resource *) override {}
+	void    STDMETHODCALLTYPE UpdateSubresource(ID3D11Resource *, UINT, const D3D11_BOX *, const void *, UINT, UINT) override {}
+	void    STDMETHODCALLTYPE CopyStructureCount(ID3D11Buffer *, UINT, ID3D11UnorderedAccessView *) override {}
+	void    STDMETHODCALLTYPE ClearRenderTargetView(ID3D11RenderTargetView *, const FLOAT [4]) override {}
+	void    STDMETHODCALLTYPE ClearUnorderedAccessViewUint(ID3D11UnorderedAccessView *, const UINT [4]) override {}
+	void    STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(ID3D11UnorderedAccessView *, const FLOAT [4]) override {}
+	void    STDMETHODCALLTYPE ClearDepthStencilView(ID3D11DepthStencilView *, UINT, FLOAT, UINT8) override {}
+	void    STDMETHODCALLTYPE GenerateMips(ID3D11ShaderResourceView *) override {}
+	void    STDMETHODCALLTYPE SetResourceMinLOD(ID3D11Resource *, FLOAT) override {}
+	FLOAT   STDMETHODCALLTYPE GetResourceMinLOD(ID3D11Resource *) override { return {}; }
+	void    STDMETHODCALLTYPE ResolveSubresource(ID3D11Resource *, UINT, ID3D11Resource *, UINT, DXGI_FORMAT) override {}
+	void    STDMETHODCALLTYPE ExecuteCommandList(ID3D11CommandList *, BOOL) override {}
+	void    STDMETHODCALLTYPE HSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE HSSetShader(ID3D11HullShader *, ID3D11ClassInstance *const *, UINT) override {}
+	void    STDMETHODCALLTYPE HSSetSamplers(UINT, UINT, ID3D11SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE HSSetConstantBuffers(UINT, UINT, ID3D11Buffer *const *) override {}
+	void    STDMETHODCALLTYPE DSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE DSSetShader(ID3D11DomainShader *, ID3D11ClassInstance *const *, UINT) override {}
+	void    STDMETHODCALLTYPE DSSetSamplers(UINT, UINT, ID3D11SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE DSSetConstantBuffers(UINT, UINT, ID3D11Buffer *const *) override {}
+	void    STDMETHODCALLTYPE CSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView *const *) override {}
+	void    STDMETHODCALLTYPE CSSetUnorderedAccessViews(UINT, UINT, ID3D11UnorderedAccessView *const *, const UINT *) override {}
+	void    STDMETHODCALLTYPE CSSetShader(ID3D11ComputeShader *, ID3D11ClassInstance *const *, UINT) override {}
+	void    STDMETHODCALLTYPE CSSetSamplers(UINT, UINT, ID3D11SamplerState *const *) override {}
+	void    STDMETHODCALLTYPE CSSetConstantBuffers(UINT, UINT, ID3D11Buffer *const *) override {}
+	void    STDMETHODCALLTYPE VSGetConstantBuffers(UINT, UINT, ID3D11Buffer **) override {}
+	void    STDMETHODCALLTYPE PSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE PSGetShader(ID3D11PixelShader **, ID3D11ClassInstance **, UINT *) override {}
+	void    STDMETHODCALLTYPE PSGetSamplers(UINT, UINT, ID3D11SamplerState **) override {}
+	void    STDMETHODCALLTYPE VSGetShader(ID3D11VertexShader **, ID3D11ClassInstance **, UINT *) override {}
+	void    STDMETHODCALLTYPE PSGetConstantBuffers(UINT, UINT, ID3D11Buffer **) override {}
+	void    STDMETHODCALLTYPE IAGetInputLayout(ID3D11InputLayout **) override {}
+	void    STDMETHODCALLTYPE IAGetVertexBuffers(UINT, UINT, ID3D11Buffer **, UINT *, UINT *) override {}
+	void    STDMETHODCALLTYPE IAGetIndexBuffer(ID3D11Buffer **, DXGI_FORMAT *, UINT *) override {}
+	void    STDMETHODCALLTYPE GSGetConstantBuffers(UINT, UINT, ID3D11Buffer **) override {}
+	void    STDMETHODCALLTYPE GSGetShader(ID3D11GeometryShader **, ID3D11ClassInstance **, UINT *) override {}
+	void    STDMETHODCALLTYPE IAGetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY *) override {}
+	void    STDMETHODCALLTYPE VSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE VSGetSamplers(UINT, UINT, ID3D11SamplerState **) override {}
+	void    STDMETHODCALLTYPE GetPredication(ID3D11Predicate **, BOOL *) override {}
+	void    STDMETHODCALLTYPE GSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE GSGetSamplers(UINT, UINT, ID3D11SamplerState **) override {}
+	void    STDMETHODCALLTYPE OMGetRenderTargets(UINT, ID3D11RenderTargetView **, ID3D11DepthStencilView **) override {}
+	void    STDMETHODCALLTYPE OMGetRenderTargetsAndUnorderedAccessViews(UINT, ID3D11RenderTargetView **, ID3D11DepthStencilView **, UINT, UINT, ID3D11UnorderedAccessView **) override {}
+	void    STDMETHODCALLTYPE OMGetBlendState(ID3D11BlendState **, FLOAT [4], UINT *) override {}
+	void    STDMETHODCALLTYPE OMGetDepthStencilState(ID3D11DepthStencilState **, UINT *) override {}
+	void    STDMETHODCALLTYPE SOGetTargets(UINT, ID3D11Buffer **) override {}
+	void    STDMETHODCALLTYPE RSGetState(ID3D11RasterizerState **) override {}
+	void    STDMETHODCALLTYPE RSGetViewports(UINT *, D3D11_VIEWPORT *) override {}
+	void    STDMETHODCALLTYPE RSGetScissorRects(UINT *, D3D11_RECT *) override {}
+	void    STDMETHODCALLTYPE HSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE HSGetShader(ID3D11HullShader **, ID3D11ClassInstance **, UINT *) override {}
+	void    STDMETHODCALLTYPE HSGetSamplers(UINT, UINT, ID3D11SamplerState **) override {}
+	void    STDMETHODCALLTYPE HSGetConstantBuffers(UINT, UINT, ID3D11Buffer **) override {}
+	void    STDMETHODCALLTYPE DSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE DSGetShader(ID3D11DomainShader **, ID3D11ClassInstance **, UINT *) override {}
+	void    STDMETHODCALLTYPE DSGetSamplers(UINT, UINT, ID3D11SamplerState **) override {}
+	void    STDMETHODCALLTYPE DSGetConstantBuffers(UINT, UINT, ID3D11Buffer **) override {}
+	void    STDMETHODCALLTYPE CSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView **) override {}
+	void    STDMETHODCALLTYPE CSGetUnorderedAccessViews(UINT, UINT, ID3D11UnorderedAccessView **) override {}
+	void    STDMETHODCALLTYPE CSGetShader(ID3D11ComputeShader **, ID3D11ClassInstance **, UINT *) override {}
+	void    STDMETHODCALLTYPE CSGetSamplers(UINT, UINT, ID3D11SamplerState **) override {}
+	void    STDMETHODCALLTYPE CSGetConstantBuffers(UINT, UINT, ID3D11Buffer **) override {}
+	void    STDMETHODCALLTYPE ClearState() override {}
+	void    STDMETHODCALLTYPE Flush() override {}
+	UINT    STDMETHODCALLTYPE GetContextFlags() override { return {}; }
+	HRESULT STDMETHODCALLTYPE FinishCommandList(BOOL, ID3D11CommandList **) override { return S_OK; }
+	D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE GetType() override { return D3D11_DEVICE_CONTEXT_IMMEDIATE; }
+};
+
+// Descriptor handles are never dereferenced by the allocator, so these heaps just reserve address space for them
+struct mock_d3d12_descriptor_heap final : ID3D12DescriptorHeap
+{
+	explicit mock_d3d12_descriptor_heap(const D3D12_DESCRIPTOR_HEAP_DESC &desc, UINT increment_size) :
+		_desc(desc), _base(reinterpret_cast<SIZE_T>(VirtualAlloc(nullptr, static_cast<SIZE_T>(desc.NumDescriptors) * increment_size, MEM_RESERVE, PAGE_NOACCESS)))
+	{
+	}
+	~mock_d3d12_descriptor_heap()
+	{
+		VirtualFree(reinterpret_cast<LPVOID>(_base), 0, MEM_RELEASE);
+	}
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObj) override
+	{
+		if (ppvObj == nullptr)
+			return E_POINTER;
+		if (riid != __uuidof(IUnknown) && riid != __uuidof(ID3D12Object) && riid != __uuidof(ID3D12DeviceChild) && riid != __uuidof(ID3D12Pageable) && riid != __uuidof(ID3D12DescriptorHeap))
+		{
+			*ppvObj = nullptr;
+			return E_NOINTERFACE;
+		}
+		AddRef();
+		*ppvObj = this;
+		return S_OK;
+	}
+	ULONG   STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&_ref); }
+	ULONG   STDMETHODCALLTYPE Release() override
+	{
+		const ULONG ref = InterlockedDecrement(&_ref);
+		if (ref == 0)
+			delete this;
+		return ref;
+	}
+
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT *, void *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override { return S_OK; }
+
+	HRESULT STDMETHODCALLTYPE GetDevice(REFIID, void **) override { return E_NOTIMPL; }
+
+	D3D12_DESCRIPTOR_HEAP_DESC  STDMETHODCALLTYPE GetDesc() override { return _desc; }
+	D3D12_CPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetCPUDescriptorHandleForHeapStart() override { return { _base }; }
+	D3D12_GPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GetGPUDescriptorHandleForHeapStart() override { return { (_desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) != 0 ? static_cast<UINT64>(_base) : 0 }; }
+
+private:
+	ULONG _ref = 1;
+	const D3D12_DESCRIPTOR_HEAP_DESC _desc;
+	const SIZE_T _base;
+};
+
+struct mock_d3d12_device final : ID3D12Device
+{
+	static constexpr UINT increment_size = 32;
+
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObj) override
+	{
+		if (ppvObj == nullptr)
+			return E_POINTER;
+		if (riid != __uuidof(IUnknown) && riid != __uuidof(ID3D12Object) && riid != __uuidof(ID3D12Device))
+		{
+			*ppvObj = nullptr;
+			return E_NOINTERFACE;
+		}
+		*ppvObj = this;
+		return S_OK;
+	}
+	// Lives on the stack for the duration of a benchmark, so does not need reference counting
+	ULONG   STDMETHODCALLTYPE AddRef() override { return 1; }
+	ULONG   STDMETHODCALLTYPE Release() override { return 1; }
+
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT *, void *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetName(LPCWSTR) override { return S_OK; }
+
+	UINT    STDMETHODCALLTYPE GetNodeCount() override { return 1; }
+	HRESULT STDMETHODCALLTYPE CreateCommandQueue(const D3D12_COMMAND_QUEUE_DESC *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateGraphicsPipelineState(const D3D12_GRAPHICS_PIPELINE_STATE_DESC *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateComputePipelineState(const D3D12_COMPUTE_PIPELINE_STATE_DESC *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateCommandList(UINT, D3D12_COMMAND_LIST_TYPE, ID3D12CommandAllocator *, ID3D12PipelineState *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D12_FEATURE, void *, UINT) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateDescriptorHeap(const D3D12_DESCRIPTOR_HEAP_DESC *pDescriptorHeapDesc, REFIID riid, void **ppvHeap) override
+	{
+		if (pDescriptorHeapDesc == nullptr || ppvHeap == nullptr)
+			return E_INVALIDARG;
+		const auto heap = new mock_d3d12_descriptor_heap(*pDescriptorHeapDesc, increment_size);
+		const HRESULT hr = heap->QueryInterface(riid, ppvHeap);
+		heap->Release();
+		return hr;
+	}
+	UINT    STDMETHODCALLTYPE GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE) override { return increment_size; }
+	HRESULT STDMETHODCALLTYPE CreateRootSignature(UINT, const void *, SIZE_T, REFIID, void **) override { return E_NOTIMPL; }
+	void    STDMETHODCALLTYPE CreateConstantBufferView(const D3D12_CONSTANT_BUFFER_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+	void    STDMETHODCALLTYPE CreateShaderResourceView(ID3D12Resource *, const D3D12_SHADER_RESOURCE_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+	void    STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D12Resource *, ID3D12Resource *, const D3D12_UNORDERED_ACCESS_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+	void    STDMETHODCALLTYPE CreateRenderTargetView(ID3D12Resource *, const D3D12_RENDER_TARGET_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+	void    STDMETHODCALLTYPE CreateDepthStencilView(ID3D12Resource *, const D3D12_DEPTH_STENCIL_VIEW_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+	void    STDMETHODCALLTYPE CreateSampler(const D3D12_SAMPLER_DESC *, D3D12_CPU_DESCRIPTOR_HANDLE) override {}
+	void    STDMETHODCALLTYPE CopyDescriptors(UINT, const D3D12_CPU_DESCRIPTOR_HANDLE *, const UINT *, UINT, const D3D12_CPU_DESCRIPTOR_HANDLE *, const UINT *, D3D12_DESCRIPTOR_HEAP_TYPE) override {}
+	void    STDMETHODCALLTYPE CopyDescriptorsSimple(UINT, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_CPU_DESCRIPTOR_HANDLE, D3D12_DESCRIPTOR_HEAP_TYPE) override {}
+	D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE GetResourceAllocationInfo(UINT, UINT, const D3D12_RESOURCE_DESC *) override { return {}; }
+	D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE GetCustomHeapProperties(UINT, D3D12_HEAP_TYPE) override { return {}; }
+	HRESULT STDMETHODCALLTYPE CreateCommittedResource(const D3D12_HEAP_PROPERTIES *, D3D12_HEAP_FLAGS, const D3D12_RESOURCE_DESC *, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateHeap(const D3D12_HEAP_DESC *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreatePlacedResource(ID3D12Heap *, UINT64, const D3D12_RESOURCE_DESC *, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateReservedResource(const D3D12_RESOURCE_DESC *, D3D12_RESOURCE_STATES, const D3D12_CLEAR_VALUE *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateSharedHandle(ID3D12DeviceChild *, const SECURITY_ATTRIBUTES *, DWORD, LPCWSTR, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE OpenSharedHandle(HANDLE, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE OpenSharedHandleByName(LPCWSTR, DWORD, HANDLE *) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE MakeResident(UINT, ID3D12Pageable *const *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE Evict(UINT, ID3D12Pageable *const *) override { return S_OK; }
+	HRESULT STDMETHODCALLTYPE CreateFence(UINT64, D3D12_FENCE_FLAGS, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override { return S_OK; }
+	void    STDMETHODCALLTYPE GetCopyableFootprints(const D3D12_RESOURCE_DESC *, UINT, UINT, UINT64, D3D12_PLACED_SUBRESOURCE_FOOTPRINT *, UINT *, UINT64 *, UINT64 *) override {}
+	HRESULT STDMETHODCALLTYPE CreateQueryHeap(const D3D12_QUERY_HEAP_DESC *, REFIID, void **) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE SetStablePowerState(BOOL) override { return E_NOTIMPL; }
+	HRESULT STDMETHODCALLTYPE CreateCommandSignature(const D3D12_COMMAND_SIGNATURE_DESC *, ID3D12RootSignature *, REFIID, void **) override { return E_NOTIMPL; }
+	void    STDMETHODCALLTYPE GetResourceTiling(ID3D12Resource *, UINT *, D3D12_PACKED_MIP_INFO *, D3D12_TILE_SHAPE *, UINT *, UINT, D3D12_SUBRESOURCE_TILING *) override {}
+	LUID    STDMETHODCALLTYPE GetAdapterLuid() override { return {}; }
+};
+
+template <typename T>
+struct mock_gl_function;
+template <typename R, typename... Args>
+struct mock_gl_function<R (APIENTRY *)(Args...)>
+{
+	static R APIENTRY call(Args...) { return R(); }
+};
+
+/// <summary>
+/// Builds an OpenGL dispatch table with the functions used by the device and state block implementations, which all do nothing.
+/// </summary>
+inline GladGLContext mock_gl_dispatch_table()
+{
+	GladGLContext gl = {};
+	gl.VERSION_4_5 = 1;
+
+#define MOCK_GL_FUNCTION(name) gl.name = mock_gl_function<decltype(gl.name)>::call
+	MOCK_GL_FUNCTION(ActiveTexture);
+	MOCK_GL_FUNCTION(AttachShader);
+	MOCK_GL_FUNCTION(BindBuffer);
+	MOCK_GL_FUNCTION(BindBufferBase);
+	MOCK_GL_FUNCTION(BindBufferRange);
+	MOCK_GL_FUNCTION(BindFramebuffer);
+	MOCK_GL_FUNCTION(BindSampler);
+	MOCK_GL_FUNCTION(BindTexture);
+	MOCK_GL_FUNCTION(BindVertexArray);
+	MOCK_GL_FUNCTION(BlendColor);
+	MOCK_GL_FUNCTION(BlendEquationSeparatei);
+	MOCK_GL_FUNCTION(BlendFuncSeparatei);
+	MOCK_GL_FUNCTION(ClipControl);
+	MOCK_GL_FUNCTION(ColorMaski);
+	MOCK_GL_FUNCTION(CompileShader);
+	MOCK_GL_FUNCTION(CreateProgram);
+	MOCK_GL_FUNCTION(CreateShader);
+	MOCK_GL_FUNCTION(CullFace);
+	MOCK_GL_FUNCTION(DeleteBuffers);
+	MOCK_GL_FUNCTION(DeleteProgram);
+	MOCK_GL_FUNCTION(DeleteShader);
+	MOCK_GL_FUNCTION(DeleteTextures);
+	MOCK_GL_FUNCTION(DepthFunc);
+	MOCK_GL_FUNCTION(DepthMask);
+	MOCK_GL_FUNCTION(Disable);
+	MOCK_GL_FUNCTION(Disablei);
+	MOCK_GL_FUNCTION(DrawBuffers);
+	MOCK_GL_FUNCTION(Enable);
+	MOCK_GL_FUNCTION(Enablei);
+	MOCK_GL_FUNCTION(FrontFace);
+	MOCK_GL_FUNCTION(GenBuffers);
+	MOCK_GL_FUNCTION(GenTextures);
+	MOCK_GL_FUNCTION(GetBooleani_v);
+	MOCK_GL_FUNCTION(GetBooleanv);
+	MOCK_GL_FUNCTION(GetFloatv);
+	MOCK_GL_FUNCTION(GetInteger64i_v);
+	MOCK_GL_FUNCTION(GetIntegeri_v);
+	MOCK_GL_FUNCTION(GetIntegerv);
+	MOCK_GL_FUNCTION(GetStringi);
+	MOCK_GL_FUNCTION(IsEnabled);
+	MOCK_GL_FUNCTION(IsEnabledi);
+	MOCK_GL_FUNCTION(LinkProgram);
+	MOCK_GL_FUNCTION(LogicOp);
+	MOCK_GL_FUNCTION(PolygonMode);
+	MOCK_GL_FUNCTION(ReadBuffer);
+	MOCK_GL_FUNCTION(SampleMaski);
+	MOCK_GL_FUNCTION(Scissor);
+	MOCK_GL_FUNCTION(ShaderSource);
+	MOCK_GL_FUNCTION(StencilFuncSeparate);
+	MOCK_GL_FUNCTION(StencilMaskSeparate);
+	MOCK_GL_FUNCTION(StencilOpSeparate);
+	MOCK_GL_FUNCTION(UseProgram);
+	MOCK_GL_FUNCTION(Viewport);
+#undef MOCK_GL_FUNCTION
+
+	return gl;
+}
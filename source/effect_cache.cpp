@@ -0,0 +1,416 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "effect_cache.hpp"
+#include "effect_codegen.hpp"
+#include "effect_preprocessor.hpp"
+#include "version.h"
+#include "ini_file.hpp" // trim
+#include <cassert>
+#include <charconv> // std::from_chars
+#include <algorithm> // std::sort
+#include <d3dcompiler.h>
+
+static std::filesystem::path make_search_path_relative(const std::filesystem::path &file, const std::vector<std::filesystem::path> &search_paths, const std::filesystem::path &base_path)
+{
+	std::error_code ec;
+
+	for (std::filesystem::path search_path : search_paths)
+	{
+		if (search_path.filename() == L"**")
+			search_path.remove_filename();
+
+		std::filesystem::path resolved_search_path = search_path.is_relative() ? base_path / search_path : search_path;
+		if (resolved_search_path = std::filesystem::canonical(resolved_search_path, ec); ec)
+			continue;
+
+		if (const std::filesystem::path relative_path = file.lexically_relative(resolved_search_path);
+			!relative_path.empty() && *relative_path.begin() != L"..")
+			return (search_path / relative_path).lexically_normal();
+	}
+
+	return file;
+}
+
+std::string reshade::effect_cache_key::attributes() const
+{
+	std::string attributes;
+	attributes += "app=" + application + ';';
+	attributes += "width=" + std::to_string(width) + ';';
+	attributes += "height=" + std::to_string(height) + ';';
+	attributes += "color_space=" + std::to_string(static_cast<uint32_t>(color_space)) + ';';
+	attributes += "color_format=" + std::to_string(static_cast<uint32_t>(color_format)) + ';';
+	attributes += "version=" + std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION) + ';';
+	attributes += "performance_mode=" + std::string(performance_mode ? "1" : "0") + ';';
+	attributes += "vendor=" + std::to_string(vendor_id) + ';';
+	attributes += "device=" + std::to_string(device_id) + ';';
+
+	for (const std::pair<std::string, std::string> &definition : definitions)
+		attributes += definition.first + '=' + definition.second + ';';
+
+	// Include the search paths, since they decide which files '#include' directives resolve to
+	for (const std::filesystem::path &search_path : search_paths)
+		attributes += "include=" + search_path.u8string() + ';';
+
+	attributes += source_file.filename().u8string();
+	attributes += ';';
+
+	return attributes;
+}
+
+std::string reshade::effect_cache_key::cache_id(uint64_t hash) const
+{
+	return source_file.stem().u8string() + '-' + std::to_string(renderer_id) + '-' + std::to_string(hash);
+}
+
+std::set<std::filesystem::path> reshade::effect_cache_key::resolve_include_paths(const std::filesystem::path &base_path) const
+{
+	std::error_code ec;
+	std::set<std::filesystem::path> include_paths;
+	if (source_file.is_absolute())
+		include_paths.emplace(source_file.parent_path());
+
+	for (std::filesystem::path include_path : search_paths)
+	{
+		const bool recursive_search = include_path.filename() == L"**";
+		if (recursive_search)
+			include_path.remove_filename();
+
+		// Start relative paths at the base path, rather than the working directory
+		if (include_path.is_relative())
+			include_path = base_path / include_path;
+		// The canonicalization step fails if the path does not exist
+		if (include_path = std::filesystem::canonical(include_path, ec); ec)
+			continue;
+
+		include_paths.emplace(include_path);
+
+		if (recursive_search)
+		{
+			for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
+				if (entry.is_directory(ec))
+					include_paths.emplace(entry);
+		}
+	}
+
+	return include_paths;
+}
+
+void reshade::effect_cache_key::setup_preprocessor(reshadefx::preprocessor &pp, bool permutation, const std::set<std::filesystem::path> &include_paths) const
+{
+	pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
+	pp.add_macro_definition("__RESHADE_PERMUTATION__", permutation ? "1" : "0");
+	pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", performance_mode ? "1" : "0");
+	pp.add_macro_definition("__VENDOR__", std::to_string(vendor_id));
+	pp.add_macro_definition("__DEVICE__", std::to_string(device_id));
+	pp.add_macro_definition("__RENDERER__", std::to_string(renderer_id));
+	pp.add_macro_definition("__APPLICATION__", std::to_string( // Truncate hash to 32-bit, since lexer currently only supports 32-bit numbers anyway
+		std::hash<std::string>()(application) & 0xFFFFFFFF));
+	pp.add_macro_definition("BUFFER_WIDTH", std::to_string(width));
+	pp.add_macro_definition("BUFFER_HEIGHT", std::to_string(height));
+	pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
+	pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
+	pp.add_macro_definition("BUFFER_COLOR_SPACE", std::to_string(static_cast<uint32_t>(color_space)));
+	pp.add_macro_definition("BUFFER_COLOR_FORMAT", std::to_string(static_cast<uint32_t>(color_format)));
+	pp.add_macro_definition("BUFFER_COLOR_BIT_DEPTH", std::to_string(api::format_bit_depth(color_format)));
+
+	for (const std::pair<std::string, std::string> &definition : definitions)
+	{
+		if (definition.first.empty())
+			continue; // Skip invalid definitions
+
+		pp.add_macro_definition(definition.first, definition.second.empty() ? "1" : definition.second);
+	}
+
+	for (const std::filesystem::path &include_path : include_paths)
+		pp.add_include_path(include_path);
+
+	// Add some conversion macros for compatibility with older versions of ReShade
+	pp.append_string(
+		"#define tex2Doffset(s, coords, offset) tex2D(s, coords, offset)\n"
+		"#define tex2Dlodoffset(s, coords, offset) tex2Dlod(s, coords, offset)\n"
+		"#define tex2Dgather(s, t, c) tex2Dgather##c(s, t)\n"
+		"#define tex2Dgatheroffset(s, t, o, c) tex2Dgather##c(s, t, o)\n"
+		"#define tex2Dgather0 tex2DgatherR\n"
+		"#define tex2Dgather1 tex2DgatherG\n"
+		"#define tex2Dgather2 tex2DgatherB\n"
+		"#define tex2Dgather3 tex2DgatherA\n");
+}
+
+bool reshade::finalize_preprocessed_effect(const reshadefx::preprocessor &pp, std::string &source, std::string &code_preamble, std::vector<std::pair<std::string, std::string>> &definitions)
+{
+	bool skip_optimization = false;
+
+	source = pp.output();
+
+	for (const std::pair<std::string, std::string> &pragma : pp.used_pragma_directives())
+	{
+		if (pragma.first == "reshade")
+		{
+			if (pragma.second == "skipoptimization" || pragma.second == "nooptimization")
+				skip_optimization = true;
+			continue;
+		}
+
+		const std::string pragma_directive = "#pragma " + pragma.first + ' ' + pragma.second + '\n';
+
+		code_preamble += pragma_directive;
+		source = "// " + pragma_directive + source;
+	}
+
+	// Keep track of used preprocessor definitions (so they can be displayed in the overlay)
+	definitions.clear();
+	for (const std::pair<std::string, std::string> &definition : pp.used_macro_definitions())
+	{
+		if (definition.first.size() < 8 ||
+			definition.first[0] == '_' ||
+			definition.first.compare(0, 7, "BUFFER_") == 0 ||
+			definition.first.compare(0, 8, "RESHADE_") == 0 ||
+			definition.first.find("INCLUDE_") != std::string::npos)
+			continue;
+
+		definitions.emplace_back(definition.first, trim(definition.second));
+
+		// Write used preprocessor definitions to the cached source
+		source = "// " + definition.first + '=' + definition.second + '\n' + source;
+	}
+
+	std::sort(definitions.begin(), definitions.end());
+
+	return skip_optimization;
+}
+
+bool reshade::build_effect_dependencies(const std::vector<std::filesystem::path> &files, const std::vector<std::filesystem::path> &missing_files, const std::vector<std::filesystem::path> &search_paths, const std::filesystem::path &base_path, reshadefx::include_cache &cache, std::string &manifest)
+{
+	std::error_code ec;
+	manifest.clear();
+
+	for (const std::filesystem::path &file : files)
+	{
+		// Files were usually just preprocessed, so reuse the hash the include cache computed when it read them
+		uint64_t content_hash = 0;
+		uintmax_t file_size = 0;
+		std::filesystem::file_time_type last_write_time;
+		if (!cache.lookup(file, content_hash, file_size, last_write_time))
+		{
+			if (!reshadefx::include_cache::hash(file, content_hash))
+				return false;
+
+			file_size = std::filesystem::file_size(file, ec);
+			if (ec)
+				return false;
+			last_write_time = std::filesystem::last_write_time(file, ec);
+			if (ec)
+				return false;
+		}
+
+		manifest += std::to_string(content_hash) + '?' + std::to_string(file_size) + '?' + std::to_string(last_write_time.time_since_epoch().count()) + '?' + make_search_path_relative(file, search_paths, base_path).u8string() + '\n';
+	}
+
+	for (const std::filesystem::path &file : missing_files)
+		manifest += '!' + make_search_path_relative(file, search_paths, base_path).u8string() + '\n';
+
+	return true;
+}
+bool reshade::check_effect_dependencies(std::string &manifest, const std::filesystem::path &base_path, std::string &key, std::vector<std::filesystem::path> &files)
+{
+	std::error_code ec;
+	std::string updated_manifest;
+	updated_manifest.reserve(manifest.size());
+
+	key.clear();
+	files.clear();
+
+	for (size_t offset = 0, next; offset < manifest.size(); offset = next + 1)
+	{
+		next = manifest.find('\n', offset);
+		if (next == std::string::npos)
+			return false;
+
+		const char *const line_begin = manifest.data() + offset;
+		const char *const line_end = manifest.data() + next;
+
+		if (*line_begin == '!')
+		{
+			std::filesystem::path file = std::filesystem::u8path(line_begin + 1, line_end);
+			if (file.is_relative())
+				file = base_path / file;
+
+			if (std::filesystem::exists(file, ec) || ec)
+				return false; // File was created since, so an include might now resolve to it
+
+			updated_manifest.append(line_begin, line_end);
+			updated_manifest += '\n';
+
+			key.append(line_begin, line_end);
+			key += ';';
+			continue;
+		}
+
+		uint64_t values[3] = {};
+		const char *value_end = line_begin;
+		for (uint64_t &value : values)
+		{
+			const std::from_chars_result result = std::from_chars(value_end, line_end, value);
+			if (result.ec != std::errc() || result.ptr == line_end || *result.ptr != '?')
+				return false;
+			value_end = result.ptr + 1;
+		}
+
+		std::filesystem::path file = std::filesystem::u8path(value_end, line_end);
+		if (file.is_relative())
+			file = base_path / file;
+
+		const uint64_t file_size = std::filesystem::file_size(file, ec);
+		if (ec)
+			return false; // File no longer exists
+		const uint64_t last_write_time = std::filesystem::last_write_time(file, ec).time_since_epoch().count();
+		if (ec)
+			return false;
+
+		// Only read and hash the file contents again if the file was touched, the content hash is what decides whether it actually changed
+		if (file_size != values[1] || last_write_time != values[2])
+		{
+			if (uint64_t content_hash = 0;
+				!reshadefx::include_cache::hash(file, content_hash) || content_hash != values[0])
+				return false;
+		}
+
+		updated_manifest += std::to_string(values[0]) + '?' + std::to_string(file_size) + '?' + std::to_string(last_write_time) + '?';
+		updated_manifest.append(value_end, line_end);
+		updated_manifest += '\n';
+
+		key.append(value_end, line_end);
+		key += '?' + std::to_string(values[0]) + ';';
+
+		files.push_back(std::move(file));
+	}
+
+	manifest = std::move(updated_manifest);
+	return !files.empty();
+}
+
+reshadefx::codegen *reshade::create_effect_codegen(uint32_t renderer_id, bool debug_info, bool performance_mode)
+{
+	unsigned shader_model;
+	if (renderer_id == 0x9000)
+		shader_model = 30; // D3D9
+	else if (renderer_id < 0xa100)
+		shader_model = 40; // D3D10 (including feature level 9)
+	else if (renderer_id < 0xb000)
+		shader_model = 41; // D3D10.1
+	else if (renderer_id < 0xc000)
+		shader_model = 50; // D3D11
+	else
+		shader_model = 51; // D3D12
+
+	if ((renderer_id & 0xF0000) == 0)
+		return reshadefx::create_codegen_hlsl(shader_model, debug_info, performance_mode);
+	else if (renderer_id < 0x20000)
+		return reshadefx::create_codegen_glsl(false, debug_info, performance_mode, false, true);
+	else // Vulkan uses SPIR-V input
+		return reshadefx::create_codegen_spirv(true, debug_info, performance_mode, false, false);
+}
+
+std::string reshade::build_effect_hlsl(const reshadefx::codegen &codegen, const reshadefx::effect_module &module, const std::string &code_preamble, const std::string &entry_point, uint32_t renderer_id, uint32_t width, uint32_t height)
+{
+	// Copy string, since this has to be repeated for every entry point
+	std::string hlsl = code_preamble;
+
+	if (renderer_id == 0x9000)
+	{
+		// Create SEMANTIC_PIXEL_SIZE constants
+		hlsl += "#define COLOR_PIXEL_SIZE 1.0 / " + std::to_string(width) + ", 1.0 / " + std::to_string(height) + '\n';
+
+		uint32_t semantic_index = 0;
+		for (const reshadefx::texture &tex : module.textures)
+		{
+			if (tex.semantic.empty() || tex.semantic == "COLOR")
+				continue;
+
+			semantic_index++;
+			assert(((module.total_uniform_size + 15) / 16) <= (224 - semantic_index));
+
+			// Avoid duplicate declarations if the semantic was used multiple times
+			if (hlsl.find(tex.semantic + "_PIXEL_SIZE") == std::string::npos)
+				hlsl += "uniform float2 " + tex.semantic + "_PIXEL_SIZE : register(c" + std::to_string(224 - semantic_index) + ");\n";
+		}
+	}
+
+	hlsl += "#line 1\n"; // Reset line number, so it matches what is shown when viewing the generated code
+	hlsl += codegen.finalize_code_for_entry_point(entry_point);
+
+	return hlsl;
+}
+
+std::string reshade::effect_hlsl_profile(reshadefx::shader_type type, uint32_t renderer_id)
+{
+	std::string profile;
+	switch (type)
+	{
+	case reshadefx::shader_type::vertex:
+		profile = "vs";
+		break;
+	case reshadefx::shader_type::pixel:
+		profile = "ps";
+		break;
+	case reshadefx::shader_type::compute:
+		profile = "cs";
+		break;
+	}
+
+	switch (renderer_id)
+	{
+	default:
+	case D3D_FEATURE_LEVEL_11_0:
+		profile += "_5_0";
+		break;
+	case D3D_FEATURE_LEVEL_10_1:
+		profile += "_4_1";
+		break;
+	case D3D_FEATURE_LEVEL_10_0:
+		profile += "_4_0";
+		break;
+	case D3D_FEATURE_LEVEL_9_1:
+	case D3D_FEATURE_LEVEL_9_2:
+		profile += "_4_0_level_9_1";
+		break;
+	case D3D_FEATURE_LEVEL_9_3:
+		profile += "_4_0_level_9_3";
+		break;
+	case 0x9000:
+		profile += "_3_0";
+		break;
+	}
+
+	return profile;
+}
+
+uint32_t reshade::effect_hlsl_compile_flags(uint32_t renderer_id, bool skip_optimization, bool performance_mode)
+{
+	uint32_t compile_flags = 0;
+	if (skip_optimization)
+		compile_flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
+	else if (performance_mode)
+		compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
+	if (renderer_id >= D3D_FEATURE_LEVEL_10_0)
+		compile_flags |= D3DCOMPILE_ENABLE_STRICTNESS;
+#ifndef NDEBUG
+	compile_flags |= D3DCOMPILE_DEBUG;
+#endif
+	return compile_flags;
+}
+
+std::string reshade::effect_shader_cache_id(const std::filesystem::path &source_file, const std::string &entry_point, uint32_t renderer_id, const std::string &profile, uint32_t compile_flags, const std::string &hlsl)
+{
+	std::string hlsl_attributes;
+	hlsl_attributes += "entrypoint=" + entry_point + ';';
+	hlsl_attributes += "profile=" + profile + ';';
+	hlsl_attributes += "flags=" + std::to_string(compile_flags) + ';';
+
+	return
+		source_file.stem().u8string() + '-' + entry_point + '-' + std::to_string(renderer_id) + '-' +
+		std::to_string(reshadefx::hash_data(hlsl, reshadefx::hash_data(hlsl_attributes)));
+}
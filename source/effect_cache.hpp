@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include "reshade_api_format.hpp"
+#include "effect_module.hpp"
+#include <set>
+#include <filesystem>
+
+namespace reshadefx
+{
+	class codegen;
+	class preprocessor;
+	class include_cache;
+}
+
+namespace reshade
+{
+	/// <summary>
+	/// Everything that identifies the preprocessed source of an effect in the effect cache.
+	/// This is shared between the runtime and the offline compiler, so that both produce the same cache layout and keys.
+	/// </summary>
+	struct effect_cache_key
+	{
+		std::filesystem::path source_file;
+		std::string application;
+		uint32_t renderer_id = 0;
+		uint32_t vendor_id = 0;
+		uint32_t device_id = 0;
+		bool performance_mode = false;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		api::color_space color_space = api::color_space::unknown;
+		api::format color_format = api::format::unknown;
+		std::vector<std::pair<std::string, std::string>> definitions;
+		std::vector<std::filesystem::path> search_paths;
+
+		/// <summary>
+		/// Builds the string of attributes that is hashed to identify this effect.
+		/// </summary>
+		std::string attributes() const;
+
+		/// <summary>
+		/// Builds the cache identifier for the specified hash (of the attributes or of the attributes combined with the dependencies, see <see cref="reshadefx::hash_data"/>).
+		/// </summary>
+		std::string cache_id(uint64_t hash) const;
+
+		/// <summary>
+		/// Resolves the search paths to the set of include directories passed to the preprocessor.
+		/// </summary>
+		/// <param name="base_path">Directory relative search paths are relative to.</param>
+		std::set<std::filesystem::path> resolve_include_paths(const std::filesystem::path &base_path) const;
+
+		/// <summary>
+		/// Adds all predefined macros, the preprocessor definitions and include paths to the specified preprocessor <paramref name="pp"/>.
+		/// </summary>
+		void setup_preprocessor(reshadefx::preprocessor &pp, bool permutation, const std::set<std::filesystem::path> &include_paths) const;
+	};
+
+	/// <summary>
+	/// Prepends the used pragma directives and preprocessor definitions to the preprocessed <paramref name="source"/>, so that they can be read again from the cached source.
+	/// </summary>
+	/// <param name="pp">Preprocessor that successfully preprocessed the effect.</param>
+	/// <param name="source">Reference filled with the source that is written to the effect cache.</param>
+	/// <param name="code_preamble">Reference to which pragma directives that have to be passed on to the backend compiler are appended.</param>
+	/// <param name="definitions">Reference filled with the used preprocessor definitions (sorted by name).</param>
+	/// <returns><see langword="true"/> if optimization was disabled via a "#pragma reshade" directive, <see langword="false"/> otherwise.</returns>
+	bool finalize_preprocessed_effect(const reshadefx::preprocessor &pp, std::string &source, std::string &code_preamble, std::vector<std::pair<std::string, std::string>> &definitions);
+
+	/// <summary>
+	/// Builds the dependency manifest for the specified files, with one line per file in the format "&lt;content hash&gt;?&lt;file size&gt;?&lt;last write time&gt;?&lt;path&gt;".
+	/// Files in one of the effect search paths are stored relative to it (as the search path was specified), so that the manifest and the key derived from it do not depend on where ReShade is installed.
+	/// Paths that were probed during include resolution but did not exist are added as "!&lt;path&gt;" lines, so that a file created there later on (e.g. one shadowing an include in a later search path) invalidates the manifest.
+	/// </summary>
+	/// <param name="missing_files">Paths that were probed but did not exist (see <see cref="reshadefx::preprocessor::missing_files"/>).</param>
+	/// <param name="search_paths">Effect search paths as specified in the configuration.</param>
+	/// <param name="base_path">Directory relative search paths are relative to.</param>
+	/// <param name="cache">Include cache the files were preprocessed with, so that files in it do not have to be read and hashed again.</param>
+	bool build_effect_dependencies(const std::vector<std::filesystem::path> &files, const std::vector<std::filesystem::path> &missing_files, const std::vector<std::filesystem::path> &search_paths, const std::filesystem::path &base_path, reshadefx::include_cache &cache, std::string &manifest);
+	/// <summary>
+	/// Checks that all files in a dependency manifest still have the same contents, only reading those again whose size or last write time changed, and that all files recorded as missing still do not exist.
+	/// </summary>
+	/// <param name="manifest">Dependency manifest, which is updated with the current file sizes and last write times.</param>
+	/// <param name="base_path">Directory relative paths in the manifest are relative to.</param>
+	/// <param name="key">Reference filled with a string made up of the paths and content hashes of all files and the paths of all missing files, which is combined with the effect attributes.</param>
+	/// <param name="files">Reference filled with the absolute paths of all files in the manifest.</param>
+	bool check_effect_dependencies(std::string &manifest, const std::filesystem::path &base_path, std::string &key, std::vector<std::filesystem::path> &files);
+
+	/// <summary>
+	/// Creates the code generator used to compile effects for the specified renderer.
+	/// </summary>
+	reshadefx::codegen *create_effect_codegen(uint32_t renderer_id, bool debug_info, bool performance_mode);
+
+	/// <summary>
+	/// Builds the HLSL code for a single entry point, as passed to the D3DCompiler.
+	/// </summary>
+	std::string build_effect_hlsl(const reshadefx::codegen &codegen, const reshadefx::effect_module &module, const std::string &code_preamble, const std::string &entry_point, uint32_t renderer_id, uint32_t width, uint32_t height);
+	/// <summary>
+	/// Gets the HLSL target profile for the specified shader type and renderer.
+	/// </summary>
+	std::string effect_hlsl_profile(reshadefx::shader_type type, uint32_t renderer_id);
+	/// <summary>
+	/// Gets the D3DCompiler flags used to compile effects for the specified renderer.
+	/// </summary>
+	uint32_t effect_hlsl_compile_flags(uint32_t renderer_id, bool skip_optimization, bool performance_mode);
+	/// <summary>
+	/// Builds the cache identifier for the compiled shader object of a single entry point.
+	/// </summary>
+	std::string effect_shader_cache_id(const std::filesystem::path &source_file, const std::string &entry_point, uint32_t renderer_id, const std::string &profile, uint32_t compile_flags, const std::string &hlsl);
+}
@@ -296,6 +296,10 @@ namespace reshadefx
 		/// <returns>ID of the current basic block.</returns>
 		virtual id   leave_block_and_branch_conditional(id condition, id true_target, id false_target) = 0;
 		/// <summary>
+		/// Removes all code added to the current basic block since it was entered, including that of the blocks merged into it by structured control flow.
+		/// </summary>
+		virtual void discard_block() = 0;
+		/// <summary>
 		/// Leaves the current function. Any code added after this call is added in the global scope.
 		/// </summary>
 		virtual void leave_function() = 0;
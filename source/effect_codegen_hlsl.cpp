@@ -621,11 +621,11 @@ private:
 		// Avoid writing the file name every time to reduce output text size
 		if constexpr (force_source)
 		{
-			s += " \"" + loc.source + '\"';
+			s += " \"" + loc.source.str() + '\"';
 		}
 		else if (loc.source != _current_location)
 		{
-			s += " \"" + loc.source + '\"';
+			s += " \"" + loc.source.str() + '\"';
 
 			_current_location = loc.source;
 		}
@@ -2130,6 +2130,13 @@ private:
 
 		return set_block(0);
 	}
+	void discard_block() override
+	{
+		assert(is_in_block());
+
+		// Code of all blocks merged into the current one by structured control flow was concatenated into it, so this removes everything since the block was entered
+		_blocks.at(_current_block).clear();
+	}
 	void leave_function() override
 	{
 		assert(_current_function != nullptr && _last_block != 0);
@@ -19,6 +19,12 @@ namespace spv {
 
 using namespace reshadefx;
 
+template <typename T>
+static inline void hash_combine(size_t &seed, const T &v)
+{
+	seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
 inline uint32_t align_up(uint32_t size, uint32_t alignment)
 {
 	alignment -= 1;
@@ -160,24 +166,78 @@ private:
 		{
 			return lhs.type == rhs.type && lhs.is_ptr == rhs.is_ptr && lhs.array_stride == rhs.array_stride && lhs.storage == rhs.storage;
 		}
+
+		struct hash
+		{
+			size_t operator()(const type_lookup &value) const
+			{
+				size_t hash = reshadefx::type::hash()(value.type);
+				hash_combine(hash, value.is_ptr);
+				hash_combine(hash, value.array_stride);
+				hash_combine(hash, static_cast<uint32_t>(value.storage.first));
+				hash_combine(hash, static_cast<uint32_t>(value.storage.second));
+				return hash;
+			}
+		};
 	};
-	struct function_blocks
+	struct function_type_lookup
 	{
-		spirv_basic_block declaration;
-		spirv_basic_block variables;
-		spirv_basic_block definition;
 		reshadefx::type return_type;
 		std::vector<reshadefx::type> param_types;
 
-		friend bool operator==(const function_blocks &lhs, const function_blocks &rhs)
+		friend bool operator==(const function_type_lookup &lhs, const function_type_lookup &rhs)
+		{
+			return lhs.return_type == rhs.return_type && lhs.param_types == rhs.param_types;
+		}
+
+		struct hash
 		{
-			if (lhs.param_types.size() != rhs.param_types.size())
+			size_t operator()(const function_type_lookup &value) const
+			{
+				size_t hash = reshadefx::type::hash()(value.return_type);
+				for (const reshadefx::type &param_type : value.param_types)
+					hash_combine(hash, reshadefx::type::hash()(param_type));
+				return hash;
+			}
+		};
+	};
+	struct constant_lookup
+	{
+		reshadefx::type type;
+		reshadefx::constant data;
+
+		static bool equal(const reshadefx::constant &lhs, const reshadefx::constant &rhs)
+		{
+			if (std::memcmp(lhs.as_uint, rhs.as_uint, sizeof(lhs.as_uint)) != 0 || lhs.string_data != rhs.string_data || lhs.array_data.size() != rhs.array_data.size())
 				return false;
-			for (size_t i = 0; i < lhs.param_types.size(); ++i)
-				if (!(lhs.param_types[i] == rhs.param_types[i]))
+			for (size_t i = 0; i < lhs.array_data.size(); ++i)
+				if (!equal(lhs.array_data[i], rhs.array_data[i]))
 					return false;
-			return lhs.return_type == rhs.return_type;
+			return true;
+		}
+
+		friend bool operator==(const constant_lookup &lhs, const constant_lookup &rhs)
+		{
+			return lhs.type == rhs.type && equal(lhs.data, rhs.data);
 		}
+
+		struct hash
+		{
+			size_t operator()(const constant_lookup &value) const
+			{
+				size_t hash = reshadefx::type::hash()(value.type);
+				hash_combine(hash, reshadefx::constant::hash()(value.data));
+				return hash;
+			}
+		};
+	};
+	struct function_blocks
+	{
+		spirv_basic_block declaration;
+		spirv_basic_block variables;
+		spirv_basic_block definition;
+		reshadefx::type return_type;
+		std::vector<reshadefx::type> param_types;
 	};
 
 	bool _debug_info = false;
@@ -204,10 +264,10 @@ private:
 	std::vector<spv::Id> _global_ubo_types;
 	function_blocks *_current_function_blocks = nullptr;
 
-	std::vector<std::pair<type_lookup, spv::Id>> _type_lookup;
-	std::vector<std::tuple<type, constant, spv::Id>> _constant_lookup;
-	std::vector<std::pair<function_blocks, spv::Id>> _function_type_lookup;
-	std::unordered_map<std::string, spv::Id> _string_lookup;
+	std::unordered_map<type_lookup, spv::Id, type_lookup::hash> _type_lookup;
+	std::unordered_map<constant_lookup, spv::Id, constant_lookup::hash> _constant_lookup;
+	std::unordered_map<function_type_lookup, spv::Id, function_type_lookup::hash> _function_type_lookup;
+	std::unordered_map<string_atom, spv::Id, string_atom::hash> _string_lookup;
 	std::unordered_map<spv::Id, std::pair<spv::StorageClass, spv::ImageFormat>> _storage_lookup;
 	std::unordered_map<std::string, uint32_t> _semantic_to_location;
 
@@ -523,8 +583,7 @@ private:
 
 		const type_lookup lookup { info, is_ptr, array_stride, { storage, format } };
 
-		if (const auto lookup_it = std::find_if(_type_lookup.begin(), _type_lookup.end(),
-				[&lookup](const std::pair<type_lookup, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		if (const auto lookup_it = _type_lookup.find(lookup);
 			lookup_it != _type_lookup.end())
 			return lookup_it->second;
 
@@ -692,14 +751,15 @@ private:
 			}
 		}
 
-		_type_lookup.push_back({ lookup, type_id });
+		_type_lookup.emplace(lookup, type_id);
 
 		return type_id;
 	}
 	spv::Id convert_type(const function_blocks &info)
 	{
-		if (const auto lookup_it = std::find_if(_function_type_lookup.begin(), _function_type_lookup.end(),
-				[&lookup = info](const std::pair<function_blocks, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		function_type_lookup lookup { info.return_type, info.param_types };
+
+		if (const auto lookup_it = _function_type_lookup.find(lookup);
 			lookup_it != _function_type_lookup.end())
 			return lookup_it->second;
 
@@ -715,7 +775,7 @@ private:
 			.add(return_type_id)
 			.add(param_type_ids.begin(), param_type_ids.end());
 
-		_function_type_lookup.push_back({ info, inst });
+		_function_type_lookup.emplace(std::move(lookup), inst);
 
 		return inst;
 	}
@@ -743,8 +803,7 @@ private:
 			lookup.type.struct_definition = static_cast<uint32_t>(elem_info.base);
 		}
 
-		if (const auto lookup_it = std::find_if(_type_lookup.begin(), _type_lookup.end(),
-				[&lookup](const std::pair<type_lookup, spv::Id> &lookup_entry) { return lookup_entry.first == lookup; });
+		if (const auto lookup_it = _type_lookup.find(lookup);
 			lookup_it != _type_lookup.end())
 			return lookup_it->second;
 
@@ -759,7 +818,7 @@ private:
 				.add(info.is_storage() ? 2 : 1) // Used with a sampler or as storage
 				.add(format);
 
-		_type_lookup.push_back({ lookup, type_id });
+		_type_lookup.emplace(lookup, type_id);
 
 		return type_id;
 	}
@@ -1996,17 +2055,9 @@ private:
 	{
 		if (!spec_constant) // Specialization constants cannot reuse other constants
 		{
-			if (const auto it = std::find_if(_constant_lookup.begin(), _constant_lookup.end(),
-					[&data_type, &data](std::tuple<type, constant, spv::Id> &x) {
-						if (!(std::get<0>(x) == data_type && std::memcmp(&std::get<1>(x).as_uint[0], &data.as_uint[0], sizeof(uint32_t) * 16) == 0 && std::get<1>(x).array_data.size() == data.array_data.size()))
-							return false;
-						for (size_t i = 0; i < data.array_data.size(); ++i)
-							if (std::memcmp(&std::get<1>(x).array_data[i].as_uint[0], &data.array_data[i].as_uint[0], sizeof(uint32_t) * 16) != 0)
-								return false;
-						return true;
-					});
+			if (const auto it = _constant_lookup.find({ data_type, data });
 				it != _constant_lookup.end())
-				return std::get<2>(*it); // Reuse existing constant instead of duplicating the definition
+				return it->second; // Reuse existing constant instead of duplicating the definition
 		}
 
 		spv::Id result;
@@ -2086,7 +2137,7 @@ private:
 		if (spec_constant) // Keep track of all specialization constants
 			_spec_constants.insert(result);
 		else
-			_constant_lookup.push_back({ data_type, data, result });
+			_constant_lookup.emplace(constant_lookup { data_type, data }, result);
 
 		return result;
 	}
@@ -2569,6 +2620,14 @@ private:
 
 		return set_block(0);
 	}
+	void discard_block() override
+	{
+		assert(is_in_block());
+
+		// Instructions of all blocks merged into the current one by structured control flow were appended to it, so only keep the label the first of them started with
+		assert(_current_block_data->instructions.front().op == spv::OpLabel);
+		_current_block_data->instructions.erase(_current_block_data->instructions.begin() + 1, _current_block_data->instructions.end());
+	}
 	void leave_function() override
 	{
 		assert(is_in_function()); // Can only leave if there was a function to begin with
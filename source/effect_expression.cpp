@@ -8,6 +8,34 @@
 #include <cassert>
 #include <cstring> // std::memcpy, std::memset
 #include <algorithm> // std::max, std::min
+#include <functional> // std::hash
+
+template <typename T>
+static inline void hash_combine(size_t &seed, const T &v)
+{
+	seed ^= std::hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+size_t reshadefx::type::hash::operator()(const type &value) const
+{
+	size_t hash = 0;
+	hash_combine(hash, static_cast<uint32_t>(value.base));
+	hash_combine(hash, (value.rows << 4) | value.cols);
+	hash_combine(hash, value.array_length);
+	hash_combine(hash, value.struct_definition);
+	return hash;
+}
+
+size_t reshadefx::constant::hash::operator()(const constant &value) const
+{
+	size_t hash = 0;
+	for (const uint32_t element : value.as_uint)
+		hash_combine(hash, element);
+	hash_combine(hash, value.string_data);
+	for (const constant &element : value.array_data)
+		hash_combine(hash, operator()(element));
+	return hash;
+}
 
 reshadefx::type reshadefx::type::merge(const type &lhs, const type &rhs)
 {
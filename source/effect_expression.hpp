@@ -119,6 +119,14 @@ namespace reshadefx
 			return !operator==(lhs, rhs);
 		}
 
+		/// <summary>
+		/// Hash function for types that is consistent with the equality comparison above (so it ignores qualifiers).
+		/// </summary>
+		struct hash
+		{
+			size_t operator()(const type &value) const;
+		};
+
 		// Underlying base type ('int', 'float', ...)
 		datatype base : 8;
 		// Number of rows if this is a vector type
@@ -149,6 +157,14 @@ namespace reshadefx
 		std::string string_data;
 		// Optional additional elements if this is an array constant
 		std::vector<constant> array_data;
+
+		/// <summary>
+		/// Hash function for constants, which covers the values of this constant and all its array elements.
+		/// </summary>
+		struct hash
+		{
+			size_t operator()(const constant &value) const;
+		};
 	};
 
 	/// <summary>
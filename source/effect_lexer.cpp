@@ -4,8 +4,13 @@
  */
 
 #include "effect_lexer.hpp"
+#include <deque>
+#include <mutex>
 #include <cassert>
+#include <iterator> // std::size
 #include <string_view>
+#include <shared_mutex>
+#include <type_traits> // std::is_trivially_copyable_v
 #include <unordered_map> // Used for static lookup tables
 
 using namespace reshadefx;
@@ -502,6 +507,53 @@ static long long octal_to_decimal(long long n)
 	return n;
 }
 
+static_assert(std::is_trivially_copyable_v<token>, "tokens should be cheap to copy");
+
+// Split the string table into multiple shards with separate locks, to reduce contention when effects are compiled on multiple threads
+struct string_table_shard
+{
+	std::shared_mutex mutex;
+	std::unordered_map<std::string_view, const std::string *> lookup;
+	std::deque<std::string> strings; // Elements of a deque do not move when more are added, so the lookup table and atoms can point to them
+};
+static string_table_shard s_string_table[16];
+
+void reshadefx::string_atom::clear_table()
+{
+	for (string_table_shard &shard : s_string_table)
+	{
+		const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+		// Swap with empty containers to actually release the memory
+		std::unordered_map<std::string_view, const std::string *>().swap(shard.lookup);
+		std::deque<std::string>().swap(shard.strings);
+	}
+}
+const std::string *reshadefx::string_atom::intern(std::string_view value)
+{
+	const size_t hash = std::hash<std::string_view>()(value);
+	string_table_shard &shard = s_string_table[hash % std::size(s_string_table)];
+
+	{
+		const std::shared_lock<std::shared_mutex> lock(shard.mutex);
+
+		if (const auto it = shard.lookup.find(value);
+			it != shard.lookup.end())
+			return it->second;
+	}
+
+	const std::unique_lock<std::shared_mutex> lock(shard.mutex);
+
+	// Another thread may have added the same string in the meantime
+	if (const auto it = shard.lookup.find(value);
+		it != shard.lookup.end())
+		return it->second;
+
+	const std::string &string = shard.strings.emplace_back(value);
+	shard.lookup.emplace(string, &string);
+	return &string;
+}
+
 std::string reshadefx::token::id_to_name(tokenid id)
 {
 	const auto it = s_token_lookup.find(id);
@@ -521,7 +573,7 @@ next_token:
 	tok.offset = input_offset();
 	tok.length = 1;
 	tok.literal_as_double = 0;
-	tok.literal_as_string.clear();
+	tok.literal_as_string = string_atom();
 
 	assert(_cur <= _end);
 
@@ -847,12 +899,14 @@ void reshadefx::lexer::parse_identifier(token &tok) const
 	tok.id = tokenid::identifier;
 	tok.offset = input_offset();
 	tok.length = end - begin;
-	tok.literal_as_string.assign(begin, end);
+
+	const std::string_view identifier(begin, tok.length);
+	tok.literal_as_string = string_atom(identifier);
 
 	if (_ignore_keywords)
 		return;
 
-	if (const auto it = s_keyword_lookup.find(tok.literal_as_string);
+	if (const auto it = s_keyword_lookup.find(identifier);
 		it != s_keyword_lookup.end())
 		tok.id = it->second;
 }
@@ -862,7 +916,7 @@ bool reshadefx::lexer::parse_pp_directive(token &tok)
 	skip_space(); // Skip any space between the '#' and directive
 	parse_identifier(tok);
 
-	if (const auto it = s_pp_directive_lookup.find(tok.literal_as_string);
+	if (const auto it = s_pp_directive_lookup.find(tok.literal_as_string.str());
 		it != s_pp_directive_lookup.end())
 	{
 		tok.id = it->second;
@@ -904,6 +958,8 @@ void reshadefx::lexer::parse_string_literal(token &tok, bool escape)
 {
 	auto *const begin = _cur, *end = begin + 1; // Skip first quote character right away
 
+	std::string literal;
+
 	for (auto c = *end; c != '"'; c = *++end)
 	{
 		if (c == '\n' || end >= _end)
@@ -994,14 +1050,12 @@ void reshadefx::lexer::parse_string_literal(token &tok, bool escape)
 			}
 		}
 
-		tok.literal_as_string += c;
+		literal += c;
 	}
 
 	tok.id = tokenid::string_literal;
 	tok.length = end - begin + 1;
-
-	// Free up unused memory
-	tok.literal_as_string.shrink_to_fit();
+	tok.literal_as_string = string_atom(literal);
 }
 void reshadefx::lexer::parse_numeric_literal(token &tok) const
 {
@@ -6,6 +6,8 @@
 #pragma once
 
 #include "effect_token.hpp"
+#include <memory> // std::shared_ptr
+#include <string_view>
 
 namespace reshadefx
 {
@@ -15,6 +17,16 @@ namespace reshadefx
 	class lexer
 	{
 	public:
+		/// <summary>
+		/// Tag type to select the constructor that references its input instead of taking ownership of it.
+		/// </summary>
+		struct borrow_input_t { explicit borrow_input_t() = default; };
+		static constexpr borrow_input_t borrow_input { };
+
+		/// <summary>
+		/// Creates a lexical analyzer that takes ownership of the <paramref name="input"/> string.
+		/// Copies of this lexer share the input with it, rather than copying it.
+		/// </summary>
 		explicit lexer(
 			std::string input,
 			bool ignore_comments = true,
@@ -24,7 +36,24 @@ namespace reshadefx
 			bool ignore_keywords = false,
 			bool escape_string_literals = true,
 			const location &start_location = location()) :
-			_input(std::move(input)),
+			lexer(std::make_shared<const std::string>(std::move(input)), ignore_comments, ignore_whitespace, ignore_pp_directives, ignore_line_directives, ignore_keywords, escape_string_literals, start_location)
+		{
+		}
+		/// <summary>
+		/// Creates a lexical analyzer that operates on <paramref name="input"/> without taking ownership of it (e.g. a memory-mapped file).
+		/// The input has to stay alive for as long as this lexer and any copies of it are in use and has to be followed by a null character.
+		/// </summary>
+		explicit lexer(
+			borrow_input_t,
+			std::string_view input,
+			bool ignore_comments = true,
+			bool ignore_whitespace = true,
+			bool ignore_pp_directives = true,
+			bool ignore_line_directives = false,
+			bool ignore_keywords = false,
+			bool escape_string_literals = true,
+			const location &start_location = location()) :
+			_input(input),
 			_cur_location(start_location),
 			_ignore_comments(ignore_comments),
 			_ignore_whitespace(ignore_whitespace),
@@ -37,12 +66,14 @@ namespace reshadefx
 			_end = _cur + _input.size();
 		}
 
+		// Copies share the input with the original, so this does not duplicate the input string
 		lexer(const lexer &lexer) { operator=(lexer); }
 		lexer &operator=(const lexer &lexer)
 		{
 			_input = lexer._input;
+			_input_storage = lexer._input_storage;
 			_cur_location = lexer._cur_location;
-			reset_to_offset(lexer._cur - lexer._input.data());
+			_cur = _input.data() + (lexer._cur - lexer._input.data());
 			_end = _input.data() + _input.size();
 			_ignore_comments = lexer._ignore_comments;
 			_ignore_whitespace = lexer._ignore_whitespace;
@@ -62,8 +93,8 @@ namespace reshadefx
 		/// <summary>
 		/// Gets the input string this lexical analyzer works on.
 		/// </summary>
-		/// <returns>Constant reference to the input string.</returns>
-		const std::string &input_string() const { return _input; }
+		/// <returns>View of the input string, which stays valid for as long as this lexer or a copy of it exists.</returns>
+		std::string_view input_string() const { return _input; }
 
 		/// <summary>
 		/// Performs lexical analysis on the input string and return the next token in sequence.
@@ -87,6 +118,20 @@ namespace reshadefx
 		void reset_to_offset(size_t offset);
 
 	private:
+		lexer(
+			std::shared_ptr<const std::string> input,
+			bool ignore_comments,
+			bool ignore_whitespace,
+			bool ignore_pp_directives,
+			bool ignore_line_directives,
+			bool ignore_keywords,
+			bool escape_string_literals,
+			const location &start_location) :
+			lexer(borrow_input, *input, ignore_comments, ignore_whitespace, ignore_pp_directives, ignore_line_directives, ignore_keywords, escape_string_literals, start_location)
+		{
+			_input_storage = std::move(input);
+		}
+
 		/// <summary>
 		/// Skips an arbitrary amount of characters in the input string.
 		/// </summary>
@@ -98,7 +143,8 @@ namespace reshadefx
 		void parse_string_literal(token &tok, bool escape);
 		void parse_numeric_literal(token &tok) const;
 
-		std::string _input;
+		std::string_view _input;
+		std::shared_ptr<const std::string> _input_storage;
 		location _cur_location;
 		const std::string::value_type *_cur, *_end;
 
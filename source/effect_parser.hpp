@@ -25,8 +25,9 @@ namespace reshadefx
 		/// </summary>
 		/// <param name="source">String to analyze.</param>
 		/// <param name="backend">Code generation implementation to use.</param>
+		/// <param name="optimize">Whether to fold constant intrinsic calls and logical operations and discard code in branches that can never be taken, so that it does not reach the backend.</param>
 		/// <returns><see langword="true"/> if parsing was successfull, <see langword="false"/> otherwise.</returns>
-		bool parse(std::string source, class codegen *backend);
+		bool parse(std::string source, class codegen *backend, bool optimize = true);
 
 		/// <summary>
 		/// Gets the list of error messages.
@@ -50,7 +51,7 @@ namespace reshadefx
 		bool expect(char tok) { return expect(static_cast<tokenid>(tok)); }
 		bool expect(tokenid tokid);
 
-		bool accept_symbol(std::string &identifier, scoped_symbol &symbol);
+		bool accept_symbol(string_atom &identifier, scoped_symbol &symbol);
 		bool accept_type_class(type &type);
 		bool accept_type_qualifiers(type &type);
 		bool accept_unary_op();
@@ -74,10 +75,21 @@ namespace reshadefx
 		bool parse_statement(bool scoped);
 		bool parse_statement_block(bool scoped);
 
+		struct function_references
+		{
+			std::vector<uint32_t> samplers;
+			std::vector<uint32_t> storages;
+			std::vector<uint32_t> functions;
+		};
+
+		function_references save_function_references(bool save) const;
+		void discard_statement(function_references &&references);
+
 		std::string _errors;
 
 		std::unique_ptr<class lexer> _lexer;
 		class codegen *_codegen = nullptr;
+		bool _optimize = true;
 
 		token _token;
 		token _token_next;
@@ -86,7 +86,7 @@ bool reshadefx::parser::expect(tokenid tokid)
 	return true;
 }
 
-bool reshadefx::parser::accept_symbol(std::string &identifier, scoped_symbol &symbol)
+bool reshadefx::parser::accept_symbol(string_atom &identifier, scoped_symbol &symbol)
 {
 	// Starting an identifier with '::' restricts the symbol search to the global namespace level
 	const bool exclusive = accept(tokenid::colon_colon);
@@ -99,18 +99,25 @@ bool reshadefx::parser::accept_symbol(std::string &identifier, scoped_symbol &sy
 		return false;
 	}
 
-	identifier = std::move(_token.literal_as_string);
+	identifier = _token.literal_as_string;
 
 	// Can concatenate multiple '::' to force symbol search for a specific namespace level
-	while (accept(tokenid::colon_colon))
+	if (peek(tokenid::colon_colon))
 	{
-		if (!expect(tokenid::identifier))
-			return false;
-		identifier += "::" + std::move(_token.literal_as_string);
+		std::string qualified_identifier = identifier.str();
+
+		while (accept(tokenid::colon_colon))
+		{
+			if (!expect(tokenid::identifier))
+				return false;
+			qualified_identifier += "::" + _token.literal_as_string.str();
+		}
+
+		identifier = string_atom(qualified_identifier);
 	}
 
 	// Figure out which scope to start searching in
-	scope scope = { "::", 0, 0 };
+	scope scope = { string_atom("::"), 0, 0 };
 	if (!exclusive)
 		scope = current_scope();
 
@@ -129,7 +136,7 @@ bool reshadefx::parser::accept_type_class(type &type)
 
 		backup(); // Need to restore if this identifier does not turn out to be a structure
 
-		std::string identifier;
+		string_atom identifier;
 		scoped_symbol symbol;
 		if (accept_symbol(identifier, symbol))
 		{
@@ -953,7 +960,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 	// At this point only identifiers are left to check and resolve
 	else
 	{
-		std::string identifier;
+		string_atom identifier;
 		scoped_symbol symbol;
 		if (!accept_symbol(identifier, symbol))
 			return false;
@@ -964,7 +971,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 			// Can only call symbols that are functions, but do not abort yet if no symbol was found since the identifier may reference an intrinsic
 			if (symbol.id && symbol.op != symbol_type::function)
 			{
-				error(location, 3005, "identifier '" + identifier + "' represents a variable, not a function");
+				error(location, 3005, "identifier '" + identifier.str() + "' represents a variable, not a function");
 				return false;
 			}
 
@@ -1004,11 +1011,11 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 			if (!resolve_function_call(identifier, arguments, symbol.scope, symbol, ambiguous))
 			{
 				if (undeclared)
-					error(location, 3004, "undeclared identifier or no matching intrinsic overload for '" + identifier + '\'');
+					error(location, 3004, "undeclared identifier or no matching intrinsic overload for '" + identifier.str() + '\'');
 				else if (ambiguous)
-					error(location, 3067, "ambiguous function call to '" + identifier + '\'');
+					error(location, 3067, "ambiguous function call to '" + identifier.str() + '\'');
 				else
-					error(location, 3013, "no matching function overload for '" + identifier + '\'');
+					error(location, 3013, "no matching function overload for '" + identifier.str() + '\'');
 				return false;
 			}
 
@@ -1036,7 +1043,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 					{
 						if (arguments[i].type != param_type)
 						{
-							error(location, 3004, "no matching intrinsic overload for '" + identifier + '\'');
+							error(location, 3004, "no matching intrinsic overload for '" + identifier.str() + '\'');
 							return false;
 						}
 
@@ -1101,12 +1108,20 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 			if (precise)
 				symbol.type.qualifiers |= type::q_precise;
 
-			// Check if the call resolving found an intrinsic or function and invoke the corresponding code
-			const codegen::id result = (symbol.op == symbol_type::function) ?
-				_codegen->emit_call(location, symbol.id, symbol.type, parameters) :
-				_codegen->emit_call_intrinsic(location, symbol.id, symbol.type, parameters);
+			// Intrinsic calls with only constant arguments can be evaluated at compile time
+			if (constant result = {}; _optimize && symbol.op == symbol_type::intrinsic && evaluate_constant_intrinsic_call(*symbol.function, arguments, result))
+			{
+				exp.reset_to_rvalue_constant(location, std::move(result), symbol.type);
+			}
+			else
+			{
+				// Check if the call resolving found an intrinsic or function and invoke the corresponding code
+				const codegen::id result_value = (symbol.op == symbol_type::function) ?
+					_codegen->emit_call(location, symbol.id, symbol.type, parameters) :
+					_codegen->emit_call_intrinsic(location, symbol.id, symbol.type, parameters);
 
-			exp.reset_to_rvalue(location, result, symbol.type);
+				exp.reset_to_rvalue(location, result_value, symbol.type);
+			}
 
 			// Copy out parameters from parameter variables back to the argument access chains
 			for (size_t i = 0; i < arguments.size(); ++i)
@@ -1153,7 +1168,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 		else if (symbol.op == symbol_type::invalid)
 		{
 			// Show error if no symbol matching the identifier was found
-			error(location, 3004, "undeclared identifier '" + identifier + '\'');
+			error(location, 3004, "undeclared identifier '" + identifier.str() + '\'');
 			return false;
 		}
 		else if (symbol.op == symbol_type::variable)
@@ -1190,7 +1205,7 @@ bool reshadefx::parser::parse_expression_unary(expression &exp)
 		else
 		{
 			// Can only reference variables and constants by name, functions need to be called
-			error(location, 3005, "identifier '" + identifier + "' represents a function, not a variable");
+			error(location, 3005, "identifier '" + identifier.str() + "' represents a function, not a variable");
 			return false;
 		}
 	}
@@ -1570,6 +1585,19 @@ bool reshadefx::parser::parse_expression_multary(expression &lhs_exp, unsigned i
 			if (rhs_exp.is_constant && lhs_exp.evaluate_constant_expression(op, rhs_exp.constant))
 				continue;
 
+			// Logical operations with a constant left-hand side evaluate to one of the two sides
+			if (_optimize && lhs_exp.is_constant && type.is_scalar() && (op == tokenid::ampersand_ampersand || op == tokenid::pipe_pipe))
+			{
+				// "true || x" and "false && x" evaluate to the left-hand side
+				if ((lhs_exp.constant.as_uint[0] != 0) == (op == tokenid::pipe_pipe))
+					continue;
+#if !RESHADEFX_SHORT_CIRCUIT
+				// "false || x" and "true && x" evaluate to the right-hand side (with short-circuiting its code was added to a different block, so cannot simply continue with it here)
+				lhs_exp = std::move(rhs_exp);
+				continue;
+#endif
+			}
+
 			const codegen::id lhs_value = _codegen->emit_load(lhs_exp);
 
 #if RESHADEFX_SHORT_CIRCUIT
@@ -1685,6 +1713,15 @@ bool reshadefx::parser::parse_expression_multary(expression &lhs_exp, unsigned i
 			true_exp.add_cast_operation(type);
 			false_exp.add_cast_operation(type);
 
+#if !RESHADEFX_SHORT_CIRCUIT
+			// A conditional expression with a constant condition evaluates to one of the two values
+			if (_optimize && lhs_exp.is_constant && type.is_scalar())
+			{
+				lhs_exp = (lhs_exp.constant.as_uint[0] != 0) ? std::move(true_exp) : std::move(false_exp);
+				continue;
+			}
+#endif
+
 			// Load condition value from expression
 			const codegen::id condition_value = _codegen->emit_load(lhs_exp);
 
@@ -24,7 +24,7 @@ private:
 	LEAVE_TYPE leave_lambda;
 };
 
-bool reshadefx::parser::parse(std::string input, codegen *backend)
+bool reshadefx::parser::parse(std::string input, codegen *backend, bool optimize)
 {
 	_lexer = std::make_unique<lexer>(std::move(input));
 
@@ -32,6 +32,8 @@ bool reshadefx::parser::parse(std::string input, codegen *backend)
 	_codegen = backend;
 	assert(backend != nullptr);
 
+	_optimize = optimize;
+
 	consume();
 
 	bool parse_success = true;
@@ -175,7 +177,7 @@ bool reshadefx::parser::parse_top(bool &parse_success)
 				if (!parse_function(type, name, stype, num_threads))
 				{
 					// Insert dummy function into symbol table, so later references can be resolved despite the error
-					insert_symbol(name, { symbol_type::function, UINT32_MAX, { type::t_function } }, true);
+					insert_symbol(string_atom(name), { symbol_type::function, UINT32_MAX, { type::t_function } }, true);
 					parse_success = false;
 					return true;
 				}
@@ -203,7 +205,7 @@ bool reshadefx::parser::parse_top(bool &parse_success)
 					if (!parse_variable(type, name, true))
 					{
 						// Insert dummy variable into symbol table, so later references can be resolved despite the error
-						insert_symbol(name, { symbol_type::variable, UINT32_MAX, type }, true);
+						insert_symbol(string_atom(name), { symbol_type::variable, UINT32_MAX, type }, true);
 						// Skip the rest of the statement
 						consume_until(';');
 						parse_success = false;
@@ -324,23 +326,37 @@ bool reshadefx::parser::parse_statement(bool scoped)
 			// Load condition and convert to boolean value as required by 'OpBranchConditional' in SPIR-V
 			condition_exp.add_cast_operation({ type::t_bool, 1, 1 });
 
+			// A branch that can never be taken is still parsed to report errors in it, but its code is discarded afterwards
+			const bool discard_true_statement = _optimize && condition_exp.is_constant && condition_exp.constant.as_uint[0] == 0;
+			const bool discard_false_statement = _optimize && condition_exp.is_constant && condition_exp.constant.as_uint[0] != 0;
+
 			const codegen::id condition_value = _codegen->emit_load(condition_exp);
 			const codegen::id condition_block = _codegen->leave_block_and_branch_conditional(condition_value, true_block, false_block);
 
 			{ // Then block of the if statement
 				_codegen->enter_block(true_block);
 
+				function_references references = save_function_references(discard_true_statement);
+
 				if (!parse_statement(true))
 					return false;
 
+				if (discard_true_statement)
+					discard_statement(std::move(references));
+
 				true_block = _codegen->leave_block_and_branch(merge_block);
 			}
 			{ // Else block of the if statement
 				_codegen->enter_block(false_block);
 
+				function_references references = save_function_references(discard_false_statement);
+
 				if (accept(tokenid::else_) && !parse_statement(true))
 					return false;
 
+				if (discard_false_statement)
+					discard_statement(std::move(references));
+
 				false_block = _codegen->leave_block_and_branch(merge_block);
 			}
 
@@ -890,6 +906,31 @@ bool reshadefx::parser::parse_statement(bool scoped)
 
 	return false;
 }
+reshadefx::parser::function_references reshadefx::parser::save_function_references(bool save) const
+{
+	function_references references;
+	if (save)
+	{
+		references.samplers = _codegen->_current_function->referenced_samplers;
+		references.storages = _codegen->_current_function->referenced_storages;
+		references.functions = _codegen->_current_function->referenced_functions;
+	}
+	return references;
+}
+void reshadefx::parser::discard_statement(function_references &&references)
+{
+	// Keep statements that end in a return, discard, break or continue, since removing those could make it look like control flow reaches places it does not
+	if (!_codegen->is_in_block())
+		return;
+
+	_codegen->discard_block();
+
+	// Forget about any objects and functions only referenced by the discarded code, so that they are not included in the entry points anymore
+	_codegen->_current_function->referenced_samplers = std::move(references.samplers);
+	_codegen->_current_function->referenced_storages = std::move(references.storages);
+	_codegen->_current_function->referenced_functions = std::move(references.functions);
+}
+
 bool reshadefx::parser::parse_statement_block(bool scoped)
 {
 	if (!expect('{'))
@@ -1052,7 +1093,7 @@ bool reshadefx::parser::parse_struct()
 	else
 		info.name = "_anonymous_struct_" + std::to_string(struct_location.line) + '_' + std::to_string(struct_location.column);
 
-	info.unique_name = 'S' + current_scope().name + info.name;
+	info.unique_name = 'S' + current_scope().name.str() + info.name;
 	std::replace(info.unique_name.begin(), info.unique_name.end(), ':', '_');
 
 	if (!expect('{'))
@@ -1201,7 +1242,7 @@ bool reshadefx::parser::parse_struct()
 	// Insert the symbol into the symbol table
 	symbol symbol = { symbol_type::structure, id };
 
-	if (!insert_symbol(info.name, symbol, true))
+	if (!insert_symbol(string_atom(info.name), symbol, true))
 	{
 		error(struct_location, 3003, "redefinition of '" + info.name + '\'');
 		return false;
@@ -1225,7 +1266,7 @@ bool reshadefx::parser::parse_function(type type, std::string name, shader_type
 
 	function info;
 	info.name = name;
-	info.unique_name = 'F' + current_scope().name + name;
+	info.unique_name = 'F' + current_scope().name.str() + name;
 	std::replace(info.unique_name.begin(), info.unique_name.end(), ':', '_');
 
 	info.return_type = type;
@@ -1444,7 +1485,7 @@ bool reshadefx::parser::parse_function(type type, std::string name, shader_type
 	symbol symbol = { symbol_type::function, id, { type::t_function } };
 	symbol.function = &_codegen->get_function(id);
 
-	if (!insert_symbol(name, symbol, true))
+	if (!insert_symbol(string_atom(name), symbol, true))
 	{
 		_codegen->leave_function();
 
@@ -1454,7 +1495,7 @@ bool reshadefx::parser::parse_function(type type, std::string name, shader_type
 
 	for (const member_type &param : info.parameter_list)
 	{
-		if (!insert_symbol(param.name, { symbol_type::variable, param.id, param.type }))
+		if (!insert_symbol(string_atom(param.name), { symbol_type::variable, param.id, param.type }))
 		{
 			_codegen->leave_function();
 
@@ -1691,7 +1732,8 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 				if (accept(tokenid::identifier)) // Handle special enumeration names for property values
 				{
 					// Transform identifier to uppercase to do case-insensitive comparison
-					std::transform(_token.literal_as_string.begin(), _token.literal_as_string.end(), _token.literal_as_string.begin(),
+					std::string identifier = _token.literal_as_string;
+					std::transform(identifier.begin(), identifier.end(), identifier.begin(),
 						[](std::string::value_type c) {
 							return static_cast<std::string::value_type>(std::toupper(c));
 						});
@@ -1725,7 +1767,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 					};
 
 					// Look up identifier in list of possible enumeration names
-					if (const auto it = s_enum_values.find(_token.literal_as_string);
+					if (const auto it = s_enum_values.find(identifier);
 						it != s_enum_values.end())
 						property_exp.reset_to_rvalue_constant(_token.location, it->second);
 					else // No match found, so rewind to parser state before the identifier was consumed and try parsing it as a normal expression
@@ -1870,7 +1912,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 		texture_info.type = static_cast<texture_type>(type.texture_dimension());
 
 		// Add namespace scope to avoid name clashes
-		texture_info.unique_name = 'V' + current_scope().name + name;
+		texture_info.unique_name = 'V' + current_scope().name.str() + name;
 		std::replace(texture_info.unique_name.begin(), texture_info.unique_name.end(), ':', '_');
 
 		texture_info.annotations = std::move(sampler_info.annotations);
@@ -1940,7 +1982,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 		sampler_info.type = type;
 
 		// Add namespace scope to avoid name clashes
-		sampler_info.unique_name = 'V' + current_scope().name + name;
+		sampler_info.unique_name = 'V' + current_scope().name.str() + name;
 		std::replace(sampler_info.unique_name.begin(), sampler_info.unique_name.end(), ':', '_');
 
 		const codegen::id id = _codegen->define_sampler(variable_location, texture_info, sampler_info);
@@ -2001,7 +2043,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 		storage_info.type = type;
 
 		// Add namespace scope to avoid name clashes
-		storage_info.unique_name = 'V' + current_scope().name + name;
+		storage_info.unique_name = 'V' + current_scope().name.str() + name;
 		std::replace(storage_info.unique_name.begin(), storage_info.unique_name.end(), ':', '_');
 
 		if (storage_info.level > texture_info.levels - 1)
@@ -2020,7 +2062,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 		uniform_info.type = type;
 
 		// Add namespace scope to avoid name clashes
-		uniform_info.unique_name = 'V' + current_scope().name + name;
+		uniform_info.unique_name = 'V' + current_scope().name.str() + name;
 		std::replace(uniform_info.unique_name.begin(), uniform_info.unique_name.end(), ':', '_');
 
 		uniform_info.annotations = std::move(sampler_info.annotations);
@@ -2035,7 +2077,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 	else
 	{
 		// Update global variable names to contain the namespace scope to avoid name clashes
-		std::string unique_name = global ? 'V' + current_scope().name + name : name;
+		std::string unique_name = global ? 'V' + current_scope().name.str() + name : name;
 		std::replace(unique_name.begin(), unique_name.end(), ':', '_');
 
 		symbol = { symbol_type::variable, 0, type };
@@ -2045,7 +2087,7 @@ bool reshadefx::parser::parse_variable(type type, std::string name, bool global)
 	}
 
 	// Insert the symbol into the symbol table
-	if (!insert_symbol(name, symbol, global))
+	if (!insert_symbol(string_atom(name), symbol, global))
 	{
 		error(variable_location, 3003, "redefinition of '" + name + '\'');
 		return false;
@@ -2131,7 +2173,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 		// Shader and render target assignment looks up values in the symbol table, so handle those separately from the other states
 		if (is_shader_state || is_texture_state)
 		{
-			std::string identifier;
+			string_atom identifier;
 			scoped_symbol symbol;
 			if (!accept_symbol(identifier, symbol))
 			{
@@ -2199,7 +2241,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 					if (!symbol.id)
 					{
 						parse_success = false;
-						error(state_location, 3501, "undeclared identifier '" + identifier + "', expected function name");
+						error(state_location, 3501, "undeclared identifier '" + identifier.str() + "', expected function name");
 					}
 					else if (!symbol.type.is_function())
 					{
@@ -2210,7 +2252,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 						[&unique_name = symbol.function->unique_name](const std::unique_ptr<function> &info) { return info->unique_name == unique_name; }) > 1)
 					{
 						parse_success = false;
-						error(state_location, 3067, "ambiguous function '" + identifier + '\'');
+						error(state_location, 3067, "ambiguous function '" + identifier.str() + '\'');
 					}
 					else
 					{
@@ -2276,7 +2318,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 					if (!symbol.id)
 					{
 						parse_success = false;
-						error(state_location, 3004, "undeclared identifier '" + identifier + "', expected texture name");
+						error(state_location, 3004, "undeclared identifier '" + identifier.str() + "', expected texture name");
 					}
 					else if (!symbol.type.is_texture())
 					{
@@ -2337,7 +2379,8 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 			if (accept(tokenid::identifier)) // Handle special enumeration names for pass states
 			{
 				// Transform identifier to uppercase to do case-insensitive comparison
-				std::transform(_token.literal_as_string.begin(), _token.literal_as_string.end(), _token.literal_as_string.begin(),
+				std::string identifier = _token.literal_as_string;
+				std::transform(identifier.begin(), identifier.end(), identifier.begin(),
 					[](std::string::value_type c) {
 						return static_cast<std::string::value_type>(std::toupper(c));
 					});
@@ -2383,7 +2426,7 @@ bool reshadefx::parser::parse_technique_pass(pass &info)
 				};
 
 				// Look up identifier in list of possible enumeration names
-				if (const auto it = s_enum_values.find(_token.literal_as_string);
+				if (const auto it = s_enum_values.find(identifier);
 					it != s_enum_values.end())
 					state_exp.reset_to_rvalue_constant(_token.location, it->second);
 				else // No match found, so rewind to parser state before the identifier was consumed and try parsing it as a normal expression
@@ -6,9 +6,10 @@
 #include "effect_lexer.hpp"
 #include "effect_preprocessor.hpp"
 #include <limits>
+#include <mutex>
 #include <cstdio> // fclose, fopen, fread, fseek
 #include <cassert>
-#include <algorithm> // std::find_if
+#include <algorithm> // std::find_if, std::min
 
 #ifndef _WIN32
 	// On Linux systems the native path encoding is UTF-8 already, so no conversion necessary
@@ -99,6 +100,155 @@ static bool read_file(const std::filesystem::path &path, std::string &file_data)
 	return true;
 }
 
+static std::shared_ptr<const reshadefx::include_cache::file> tokenize_file(std::string data, uint64_t hash, const std::string &name)
+{
+	const std::shared_ptr<reshadefx::include_cache::file> file = std::make_shared<reshadefx::include_cache::file>();
+	file->data = std::move(data);
+	file->hash = hash;
+
+	// Use the same lexer settings as the preprocessor uses for its input, so that replaying these tokens is equivalent to lexing the file again
+	// The lexer only needs to reference the file data, since it does not outlive the file
+	reshadefx::lexer lexer(
+		reshadefx::lexer::borrow_input,
+		file->data,
+		true  /* ignore_comments */,
+		false /* ignore_whitespace */,
+		false /* ignore_pp_directives */,
+		false /* ignore_line_directives */,
+		true  /* ignore_keywords */,
+		false /* escape_string_literals */,
+		reshadefx::location(name, 1));
+
+	do
+		file->tokens.push_back(lexer.lex());
+	while (file->tokens.back() != reshadefx::tokenid::end_of_file);
+
+	return file;
+}
+
+static std::string make_include_cache_key(const std::filesystem::path &path)
+{
+	// The canonicalization step fails if the path does not exist, in which case loading the file fails anyway
+	std::error_code ec;
+	const std::filesystem::path canonical_path = std::filesystem::canonical(path, ec);
+	return ec ? path.u8string() : canonical_path.u8string();
+}
+
+std::shared_ptr<const reshadefx::include_cache::file> reshadefx::include_cache::load(const std::filesystem::path &path)
+{
+	const std::string key = make_include_cache_key(path);
+
+	entry cached_entry;
+	{
+		const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+		if (const auto it = _entries.find(key);
+			it != _entries.end())
+		{
+			// Files are only checked for changes once per generation
+			if (it->second.generation == _generation)
+				return it->second.contents;
+
+			cached_entry = it->second;
+		}
+	}
+
+	std::error_code ec;
+	const uintmax_t size = std::filesystem::file_size(path, ec);
+	if (ec)
+		return nullptr;
+	const std::filesystem::file_time_type last_write_time = std::filesystem::last_write_time(path, ec);
+	if (ec)
+		return nullptr;
+
+	std::shared_ptr<const file> file = cached_entry.contents;
+
+	// Only read the file again if it was touched, and only tokenize it again if its contents actually changed
+	if (file == nullptr || size != cached_entry.size || last_write_time != cached_entry.last_write_time)
+	{
+		std::string data;
+		if (!read_file(path, data))
+			return nullptr;
+
+		const uint64_t hash = hash_data(data);
+		if (file == nullptr || hash != file->hash)
+			file = tokenize_file(std::move(data), hash, key);
+	}
+
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	entry &entry = _entries[key];
+	entry.contents = file;
+	entry.size = size;
+	entry.last_write_time = last_write_time;
+	entry.generation = _generation;
+
+	return file;
+}
+
+bool reshadefx::include_cache::lookup(const std::filesystem::path &path, uint64_t &hash, uintmax_t &size, std::filesystem::file_time_type &last_write_time)
+{
+	const std::string key = make_include_cache_key(path);
+
+	const std::shared_lock<std::shared_mutex> lock(_mutex);
+
+	const auto it = _entries.find(key);
+	if (it == _entries.end() || it->second.contents == nullptr)
+		return false;
+
+	hash = it->second.contents->hash;
+	size = it->second.size;
+	last_write_time = it->second.last_write_time;
+	return true;
+}
+
+void reshadefx::include_cache::invalidate()
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	_generation++;
+}
+void reshadefx::include_cache::evict_unused()
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	for (auto it = _entries.begin(); it != _entries.end();)
+		if (it->second.generation != _generation)
+			it = _entries.erase(it);
+		else
+			++it;
+}
+void reshadefx::include_cache::clear()
+{
+	const std::unique_lock<std::shared_mutex> lock(_mutex);
+
+	_entries.clear();
+}
+
+std::shared_ptr<const reshadefx::include_cache::file> reshadefx::include_cache::read(const std::filesystem::path &path)
+{
+	std::string data;
+	if (!read_file(path, data))
+		return nullptr;
+
+	const uint64_t hash = hash_data(data);
+	return tokenize_file(std::move(data), hash, path.u8string());
+}
+bool reshadefx::include_cache::hash(const std::filesystem::path &path, uint64_t &hash)
+{
+	std::string data;
+	if (!read_file(path, data))
+		return false;
+
+	hash = hash_data(data);
+	return true;
+}
+
+std::string_view reshadefx::preprocessor::input_level::input_string() const
+{
+	return file != nullptr ? std::string_view(file->data) : lexer->input_string();
+}
+
 template <char ESCAPE_CHAR = '\\'>
 static std::string escape_string(std::string s)
 {
@@ -110,6 +260,10 @@ static std::string escape_string(std::string s)
 reshadefx::preprocessor::preprocessor()
 {
 }
+reshadefx::preprocessor::preprocessor(include_cache &cache) :
+	_include_cache(&cache)
+{
+}
 reshadefx::preprocessor::~preprocessor()
 {
 }
@@ -137,11 +291,17 @@ bool reshadefx::preprocessor::add_macro_definition(const std::string &name, cons
 
 bool reshadefx::preprocessor::append_file(const std::filesystem::path &path)
 {
-	std::string source_code;
-	if (!read_file(path, source_code))
+	std::shared_ptr<const include_cache::file> file = load_file(path);
+	if (file == nullptr)
 		return false;
 
-	return append_string(std::move(source_code), path);
+	// Only consider new errors added below for the success of this call
+	const size_t errors_offset = _errors.length();
+
+	push(std::move(file), path.u8string());
+	parse();
+
+	return _errors.find(": preprocessor error: ", errors_offset) == std::string::npos;
 }
 bool reshadefx::preprocessor::append_string(std::string source_code, const std::filesystem::path &path)
 {
@@ -165,10 +325,18 @@ std::vector<std::filesystem::path> reshadefx::preprocessor::included_files() con
 {
 	std::vector<std::filesystem::path> files;
 	files.reserve(_file_cache.size());
-	for (const std::pair<std::string, std::string> &cache_entry : _file_cache)
+	for (const std::pair<const std::string, std::shared_ptr<const include_cache::file>> &cache_entry : _file_cache)
 		files.push_back(std::filesystem::u8path(cache_entry.first));
 	return files;
 }
+std::vector<std::filesystem::path> reshadefx::preprocessor::missing_files() const
+{
+	std::vector<std::filesystem::path> files;
+	files.reserve(_missing_files.size());
+	for (const std::string &file : _missing_files)
+		files.push_back(std::filesystem::u8path(file));
+	return files;
+}
 std::vector<std::pair<std::string, std::string>> reshadefx::preprocessor::used_macro_definitions() const
 {
 	std::vector<std::pair<std::string, std::string>> definitions;
@@ -201,6 +369,13 @@ void reshadefx::preprocessor::warning(const location &location, const std::strin
 }
 
 void reshadefx::preprocessor::push(std::string input, const std::string &name)
+{
+	std::unique_ptr<std::string> buffer = acquire_buffer();
+	*buffer = std::move(input);
+
+	push(std::move(buffer), name);
+}
+void reshadefx::preprocessor::push(std::unique_ptr<std::string> input, const std::string &name)
 {
 	location start_location = !name.empty() ?
 		// Start at the beginning of the file when pushing a new file
@@ -208,16 +383,30 @@ void reshadefx::preprocessor::push(std::string input, const std::string &name)
 		// Start with last known token location when pushing an unnamed string
 		_token.location;
 
-	input_level level = { name };
-	level.lexer.reset(new lexer(
-		std::move(input),
+	// The lexer only references the input, which is kept alive by this input level
+	const lexer new_lexer(
+		lexer::borrow_input,
+		*input,
 		true  /* ignore_comments */,
 		false /* ignore_whitespace */,
 		false /* ignore_pp_directives */,
 		false /* ignore_line_directives */,
 		true  /* ignore_keywords */,
 		false /* escape_string_literals */,
-		start_location));
+		start_location);
+
+	input_level level = { string_atom(name) };
+	if (_unused_lexers.empty())
+	{
+		level.lexer.reset(new lexer(new_lexer));
+	}
+	else
+	{
+		level.lexer = std::move(_unused_lexers.back());
+		_unused_lexers.pop_back();
+		*level.lexer = new_lexer;
+	}
+	level.buffer = std::move(input);
 	level.next_token.id = tokenid::unknown;
 	level.next_token.location = start_location; // This is used in 'consume' to initialize the output location
 
@@ -231,6 +420,78 @@ void reshadefx::preprocessor::push(std::string input, const std::string &name)
 	// Advance into the input stack to update next token
 	consume();
 }
+void reshadefx::preprocessor::push(std::shared_ptr<const include_cache::file> file, const std::string &name)
+{
+	input_level level = { string_atom(name) };
+	level.file = std::move(file);
+	level.next_token.id = tokenid::unknown;
+	level.next_token.location = location(name, 1); // This is used in 'consume' to initialize the output location
+
+	// Inherit hidden macros from parent
+	if (!_input_stack.empty())
+		level.hidden_macros = _input_stack.back().hidden_macros;
+
+	_input_stack.push_back(std::move(level));
+	_next_input_index = _input_stack.size() - 1;
+
+	// Advance into the input stack to update next token
+	consume();
+}
+void reshadefx::preprocessor::pop(size_t input_index)
+{
+	while (_input_stack.size() > input_index)
+	{
+		input_level &level = _input_stack.back();
+		if (level.buffer != nullptr)
+			_unused_buffers.push_back(std::move(level.buffer));
+		if (level.lexer != nullptr)
+			_unused_lexers.push_back(std::move(level.lexer));
+
+		_input_stack.pop_back();
+	}
+
+	// Macros can only be hidden in the topmost input level, so any macros hidden after the one the remaining topmost level links to belonged to removed levels
+	_hidden_macros.resize(_input_stack.empty() || _input_stack.back().hidden_macros == std::numeric_limits<size_t>::max() ? 0 : _input_stack.back().hidden_macros + 1);
+}
+
+std::unique_ptr<std::string> reshadefx::preprocessor::acquire_buffer()
+{
+	if (_unused_buffers.empty())
+		return std::make_unique<std::string>();
+
+	// Reuse buffer of a removed input level, which keeps its capacity
+	std::unique_ptr<std::string> buffer = std::move(_unused_buffers.back());
+	_unused_buffers.pop_back();
+	buffer->clear();
+	return buffer;
+}
+
+std::shared_ptr<const reshadefx::include_cache::file> reshadefx::preprocessor::load_file(const std::filesystem::path &path)
+{
+	return _include_cache != nullptr ? _include_cache->load(path) : include_cache::read(path);
+}
+std::filesystem::path reshadefx::preprocessor::resolve_include_path(const std::filesystem::path &file_name)
+{
+	std::filesystem::path file_path = std::filesystem::u8path(_output_location.source.str());
+	file_path.replace_filename(file_name);
+
+	std::error_code ec;
+	if (std::filesystem::exists(file_path, ec))
+		return file_path;
+
+	// Remember every probe that failed, since creating a file there later would change what this resolves to
+	_missing_files.insert(file_path.lexically_normal().u8string());
+
+	for (const std::filesystem::path &include_path : _include_paths)
+	{
+		if (std::filesystem::exists(file_path = include_path / file_name, ec))
+			break;
+
+		_missing_files.insert(file_path.lexically_normal().u8string());
+	}
+
+	return file_path;
+}
 
 bool reshadefx::preprocessor::peek(tokenid tokid) const
 {
@@ -251,14 +512,13 @@ void reshadefx::preprocessor::consume()
 	}
 
 	// Clear out input stack, now that the current token is overwritten
-	while (_input_stack.size() > (_current_input_index + 1))
-		_input_stack.pop_back();
+	pop(_current_input_index + 1);
 
 	// Update location information after switching input levels
 	input_level &input = _input_stack[_current_input_index];
 	if (!input.name.empty() && input.name != _output_location.source)
 	{
-		_output += "#line " + std::to_string(input.next_token.location.line) + " \"" + input.name + "\"\n";
+		_output += "#line " + std::to_string(input.next_token.location.line) + " \"" + input.name.str() + "\"\n";
 		// Line number is increased before checking against next token in 'tokenid::end_of_line' handling in 'parse' function below, so compensate for that here
 		_output_location.line = input.next_token.location.line - 1;
 		_output_location.source = input.name;
@@ -266,10 +526,14 @@ void reshadefx::preprocessor::consume()
 
 	// Set current token
 	_token = std::move(input.next_token);
-	_current_token_raw_data = input.lexer->input_string().substr(_token.offset, _token.length);
+	_current_token_raw_data = input.input_string().substr(_token.offset, _token.length);
 
 	// Get the next token
-	input.next_token = input.lexer->lex();
+	if (input.file != nullptr)
+		// The token stream always ends with an end of file token, which is repeated when reading past it
+		input.next_token = input.file->tokens[std::min(input.next_token_index++, input.file->tokens.size() - 1)];
+	else
+		input.next_token = input.lexer->lex();
 
 	// Verify string literals (since the lexer cannot throw errors itself)
 	if (_token == tokenid::string_literal && _current_token_raw_data.back() != '\"')
@@ -286,7 +550,7 @@ void reshadefx::preprocessor::consume()
 		if (_next_input_index == 0)
 		{
 			// End of input has been reached, so cannot pop further and this is the last token
-			_input_stack.pop_back();
+			pop(_input_stack.size() - 1);
 			return;
 		}
 		else
@@ -337,8 +601,8 @@ bool reshadefx::preprocessor::expect(tokenid tokid)
 		}
 		else
 		{
-			const std::string token_string = _input_stack[_next_input_index].lexer->input_string().substr(actual_token.offset, actual_token.length);
-			error(actual_token.location, "syntax error: unexpected token '" + token_string + '\'');
+			const std::string_view token_string = _input_stack[_next_input_index].input_string().substr(actual_token.offset, actual_token.length);
+			error(actual_token.location, "syntax error: unexpected token '" + std::string(token_string) + '\'');
 		}
 
 		return false;
@@ -434,7 +698,7 @@ void reshadefx::preprocessor::parse()
 		case tokenid::hash_unknown:
 			// Standalone "#" is valid and should be ignored
 			if (_token.length != 0)
-				error(_token.location, "unrecognized preprocessing directive '" + _token.literal_as_string + '\'');
+				error(_token.location, "unrecognized preprocessing directive '" + _token.literal_as_string.str() + '\'');
 			if (!expect(tokenid::end_of_line))
 				consume_until(tokenid::end_of_line);
 			continue;
@@ -704,7 +968,7 @@ void reshadefx::preprocessor::parse_pragma()
 		if (const auto file_it = _file_cache.find(_output_location.source);
 			file_it != _file_cache.end())
 		{
-			file_it->second.clear();
+			file_it->second.reset();
 		}
 		return;
 	}
@@ -738,15 +1002,8 @@ void reshadefx::preprocessor::parse_include()
 		return;
 	}
 
-	std::filesystem::path file_name = std::filesystem::u8path(_token.literal_as_string);
-	std::filesystem::path file_path = std::filesystem::u8path(_output_location.source);
-	file_path.replace_filename(file_name);
-
-	std::error_code ec;
-	if (!std::filesystem::exists(file_path, ec))
-		for (const std::filesystem::path &include_path : _include_paths)
-			if (std::filesystem::exists(file_path = include_path / file_name, ec))
-				break;
+	const std::filesystem::path file_name = std::filesystem::u8path(_token.literal_as_string.str());
+	const std::filesystem::path file_path = resolve_include_path(file_name);
 
 	const std::string file_path_string = file_path.u8string();
 
@@ -757,19 +1014,19 @@ void reshadefx::preprocessor::parse_include()
 			}) != _input_stack.end())
 		return error(_token.location, "recursive #include");
 
-	std::string input;
+	std::shared_ptr<const include_cache::file> file;
 
 	if (const auto file_it = _file_cache.find(file_path_string);
 		file_it != _file_cache.end())
 	{
-		input = file_it->second;
+		file = file_it->second;
 	}
 	else
 	{
-		if (!read_file(file_path, input))
+		if ((file = load_file(file_path)) == nullptr)
 			return error(keyword_location, "could not open included file '" + file_name.u8string() + '\'');
 
-		_file_cache.emplace(file_path_string, input);
+		_file_cache.emplace(file_path_string, file);
 	}
 
 	// Skip end of line character following the include statement before pushing, so that the line number is already pointing to the next line when popping out of it again
@@ -777,10 +1034,12 @@ void reshadefx::preprocessor::parse_include()
 		consume_until(tokenid::end_of_line);
 
 	// Clear out input stack before pushing include, so that hidden macros do not bleed into the include
-	while (_input_stack.size() > (_next_input_index + 1))
-		_input_stack.pop_back();
+	pop(_next_input_index + 1);
 
-	push(std::move(input), file_path_string);
+	if (file != nullptr)
+		push(std::move(file), file_path_string);
+	else
+		push(std::string(), file_path_string); // File was already included and marked with '#pragma once'
 }
 
 bool reshadefx::preprocessor::evaluate_expression()
@@ -935,19 +1194,13 @@ bool reshadefx::preprocessor::evaluate_expression()
 				if (!expect(tokenid::string_literal))
 					return false;
 
-				std::filesystem::path file_name = std::filesystem::u8path(_token.literal_as_string);
-				std::filesystem::path file_path = std::filesystem::u8path(_output_location.source);
-				file_path.replace_filename(file_name);
+				const std::filesystem::path file_name = std::filesystem::u8path(_token.literal_as_string.str());
+				const std::filesystem::path file_path = resolve_include_path(file_name);
 
 				if (has_parentheses && !expect(tokenid::parenthesis_close))
 					return false;
 
 				std::error_code ec;
-				if (!std::filesystem::exists(file_path, ec))
-					for (const std::filesystem::path &include_path : _include_paths)
-						if (std::filesystem::exists(file_path = include_path / file_name, ec))
-							break;
-
 				rpn[rpn_index++] = { std::filesystem::exists(file_path, ec) ? 1 : 0, false };
 				continue;
 			}
@@ -1129,25 +1382,25 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 	}
 	if (_token.literal_as_string == "__FILE_STEM__")
 	{
-		const std::filesystem::path file_stem = std::filesystem::u8path(_token.location.source).stem();
+		const std::filesystem::path file_stem = std::filesystem::u8path(_token.location.source.str()).stem();
 		push(escape_string(file_stem.u8string()));
 		return true;
 	}
 	if (_token.literal_as_string == "__FILE_STEM_HASH__")
 	{
-		const std::filesystem::path file_stem = std::filesystem::u8path(_token.location.source).stem();
+		const std::filesystem::path file_stem = std::filesystem::u8path(_token.location.source.str()).stem();
 		push(std::to_string(std::hash<std::string>()(file_stem.u8string()) & 0xFFFFFFFF));
 		return true;
 	}
 	if (_token.literal_as_string == "__FILE_NAME__")
 	{
-		const std::filesystem::path file_name = std::filesystem::u8path(_token.location.source).filename();
+		const std::filesystem::path file_name = std::filesystem::u8path(_token.location.source.str()).filename();
 		push(escape_string(file_name.u8string()));
 		return true;
 	}
 	if (_token.literal_as_string == "__FILE_NAME_HASH__")
 	{
-		const std::filesystem::path file_name = std::filesystem::u8path(_token.location.source).filename();
+		const std::filesystem::path file_name = std::filesystem::u8path(_token.location.source.str()).filename();
 		push(std::to_string(std::hash<std::string>()(file_name.u8string()) & 0xFFFFFFFF));
 		return true;
 	}
@@ -1156,18 +1409,23 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 	if (macro_it == _macros.end())
 		return false;
 
+	const string_atom macro_name = _token.literal_as_string;
+
 	if (!_input_stack.empty())
 	{
-		const std::unordered_set<std::string> &hidden_macros = _input_stack[_current_input_index].hidden_macros;
-		if (hidden_macros.find(_token.literal_as_string) != hidden_macros.end())
-			return false;
+		// Walk through the macros hidden in the current input level and all its parents
+		for (size_t hidden_index = _input_stack[_current_input_index].hidden_macros; hidden_index != std::numeric_limits<size_t>::max(); hidden_index = _hidden_macros[hidden_index].second)
+			if (_hidden_macros[hidden_index].first == macro_name)
+				return false;
 	}
 
 	const location macro_location = _token.location;
 	if (_recursion_count++ >= 256)
 		return error(macro_location, "macro recursion too high"), false;
 
-	std::vector<std::string> arguments;
+	// Arguments are added to the end of the shared list, after those of any macro invocation this one is nested in
+	const size_t first_argument = _num_macro_arguments;
+
 	if (macro_it->second.is_function_like)
 	{
 		if (!accept(tokenid::parenthesis_open))
@@ -1176,7 +1434,11 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 		while (true)
 		{
 			int parentheses_level = 0;
-			std::string argument;
+
+			if (_num_macro_arguments == _macro_arguments.size())
+				_macro_arguments.emplace_back();
+			std::string &argument = _macro_arguments[_num_macro_arguments];
+			argument.clear();
 
 			// Ignore whitespace preceding the argument
 			accept(tokenid::space);
@@ -1187,12 +1449,15 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 			while (true)
 			{
 				if (peek(tokenid::end_of_file))
+				{
+					_num_macro_arguments = first_argument;
 					return error(macro_location, "unexpected end of file in macro expansion"), false;
+				}
 
 				// Consume all tokens of the argument
 				consume();
 
-				if (_token == tokenid::comma && parentheses_level == 0 && !(macro_it->second.is_variadic && arguments.size() == macro_it->second.parameters.size()))
+				if (_token == tokenid::comma && parentheses_level == 0 && !(macro_it->second.is_variadic && _num_macro_arguments - first_argument == macro_it->second.parameters.size()))
 					break; // Comma marks end of an argument (unless this is the last argument in a variadic macro invocation)
 				if (_token == tokenid::parenthesis_open)
 					parentheses_level++;
@@ -1210,14 +1475,16 @@ bool reshadefx::preprocessor::evaluate_identifier_as_macro()
 			if (argument.size() && argument.back() == ' ')
 				argument.pop_back();
 
-			arguments.push_back(std::move(argument));
+			_num_macro_arguments++;
 
 			if (parentheses_level < 0)
 				break;
 		}
 	}
 
-	expand_macro(macro_it->first, macro_it->second, arguments);
+	expand_macro(macro_name, macro_it->second, first_argument, _num_macro_arguments - first_argument);
+
+	_num_macro_arguments = first_argument;
 
 	return true;
 }
@@ -1234,18 +1501,19 @@ bool reshadefx::preprocessor::is_defined(const std::string &name) const
 		name == "__FILE_NAME_HASH__";
 }
 
-void reshadefx::preprocessor::expand_macro(const std::string &name, const macro &definition, const std::vector<std::string> &arguments)
+void reshadefx::preprocessor::expand_macro(string_atom name, const macro &definition, size_t first_argument, size_t num_arguments)
 {
 	if (definition.replacement_list.empty())
 		return;
 
 	// Verify argument count for function-like macros
-	if (arguments.size() < definition.parameters.size())
-		return warning(_token.location, "not enough arguments for function-like macro invocation '" + name + "'");
-	if (arguments.size() > definition.parameters.size() && !definition.is_variadic)
-		return warning(_token.location, "too many arguments for function-like macro invocation '" + name + "'");
+	if (num_arguments < definition.parameters.size())
+		return warning(_token.location, "not enough arguments for function-like macro invocation '" + name.str() + "'");
+	if (num_arguments > definition.parameters.size() && !definition.is_variadic)
+		return warning(_token.location, "too many arguments for function-like macro invocation '" + name.str() + "'");
 
-	std::string input;
+	std::unique_ptr<std::string> buffer = acquire_buffer();
+	std::string &input = *buffer;
 	input.reserve(definition.replacement_list.size());
 
 	for (size_t offset = 0; offset < definition.replacement_list.size(); ++offset)
@@ -1259,7 +1527,7 @@ void reshadefx::preprocessor::expand_macro(const std::string &name, const macro
 		// This is a special replacement sequence
 		const char type = definition.replacement_list[++offset];
 		const char index = definition.replacement_list[++offset];
-		if (static_cast<size_t>(index) >= arguments.size())
+		if (static_cast<size_t>(index) >= num_arguments)
 		{
 			if (definition.is_variadic)
 			{
@@ -1276,7 +1544,12 @@ void reshadefx::preprocessor::expand_macro(const std::string &name, const macro
 		{
 		case macro_replacement_argument:
 			// Argument prescan
-			push(arguments[index] + static_cast<char>(macro_replacement_argument));
+			{
+				std::unique_ptr<std::string> argument = acquire_buffer();
+				*argument += _macro_arguments[first_argument + index];
+				*argument += static_cast<char>(macro_replacement_argument);
+				push(std::move(argument));
+			}
 			while (true)
 			{
 				// Consume all tokens of the argument (until the end marker is reached)
@@ -1292,19 +1565,21 @@ void reshadefx::preprocessor::expand_macro(const std::string &name, const macro
 			assert(_current_token_raw_data[0] == macro_replacement_argument);
 			break;
 		case macro_replacement_concat:
-			input += arguments[index];
+			input += _macro_arguments[first_argument + index];
 			break;
 		case macro_replacement_stringize:
 			// Adds backslashes to escape quotes
-			input += escape_string<'\"'>(arguments[index]);
+			input += escape_string<'\"'>(_macro_arguments[first_argument + index]);
 			break;
 		}
 	}
 
-	push(std::move(input));
+	push(std::move(buffer));
 
 	// Avoid expanding macros again that are referencing themselves
-	_input_stack[_current_input_index].hidden_macros.insert(name);
+	input_level &level = _input_stack[_current_input_index];
+	_hidden_macros.emplace_back(name, level.hidden_macros);
+	level.hidden_macros = _hidden_macros.size() - 1;
 }
 
 void reshadefx::preprocessor::create_macro_replacement_list(macro &definition)
@@ -6,13 +6,91 @@
 #pragma once
 
 #include "effect_token.hpp"
-#include <memory> // std::unique_ptr
+#include <set>
+#include <limits>
+#include <memory> // std::shared_ptr, std::unique_ptr
 #include <filesystem>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 
 namespace reshadefx
 {
+	/// <summary>
+	/// Computes the 64-bit FNV-1a hash of the specified <paramref name="data"/>.
+	/// Unlike 'std::hash' this gives the same result in 32-bit and 64-bit builds, which share the effect cache, so it is used for everything that ends up in cache keys.
+	/// </summary>
+	inline uint64_t hash_data(std::string_view data, uint64_t hash = 14695981039346656037ull)
+	{
+		for (const char c : data)
+			hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+		return hash;
+	}
+
+	/// <summary>
+	/// A thread-safe cache of source files and their token streams, which can be shared between multiple preprocessor instances.
+	/// Files are validated against the file system once per generation (see <see cref="invalidate"/>) and only read and tokenized again if their contents changed.
+	/// Entries are keyed by the canonical path, so that a file reached through different paths is only cached once.
+	/// </summary>
+	class include_cache
+	{
+	public:
+		struct file
+		{
+			std::string data;
+			uint64_t hash = 0;
+			std::vector<token> tokens;
+		};
+
+		/// <summary>
+		/// Gets the contents and tokens of the file at the specified <paramref name="path"/>, reading and tokenizing it if it is not in the cache yet or changed.
+		/// </summary>
+		/// <param name="path">Path to the file to load.</param>
+		/// <returns>Pointer to the file, which stays valid even if the cache entry is replaced, or <see langword="nullptr"/> if the file could not be read.</returns>
+		std::shared_ptr<const file> load(const std::filesystem::path &path);
+
+		/// <summary>
+		/// Looks up the content hash, size and last write time the file at the specified <paramref name="path"/> had when it was last loaded, without reading it again.
+		/// </summary>
+		/// <returns><see langword="true"/> if the file is in the cache, <see langword="false"/> otherwise.</returns>
+		bool lookup(const std::filesystem::path &path, uint64_t &hash, uintmax_t &size, std::filesystem::file_time_type &last_write_time);
+
+		/// <summary>
+		/// Starts a new generation, so that all files are checked for changes again the next time they are loaded.
+		/// </summary>
+		void invalidate();
+		/// <summary>
+		/// Removes all files that were not loaded since the last call to <see cref="invalidate"/>.
+		/// </summary>
+		void evict_unused();
+		/// <summary>
+		/// Removes all files from the cache.
+		/// </summary>
+		void clear();
+
+		/// <summary>
+		/// Reads and tokenizes the file at the specified <paramref name="path"/>, without adding it to any cache.
+		/// </summary>
+		static std::shared_ptr<const file> read(const std::filesystem::path &path);
+		/// <summary>
+		/// Reads the file at the specified <paramref name="path"/> and computes the hash of its contents (see <see cref="hash_data"/>), the same way as for files loaded into the cache.
+		/// </summary>
+		static bool hash(const std::filesystem::path &path, uint64_t &hash);
+
+	private:
+		struct entry
+		{
+			std::shared_ptr<const file> contents;
+			uintmax_t size = 0;
+			std::filesystem::file_time_type last_write_time;
+			unsigned int generation = 0;
+		};
+
+		std::shared_mutex _mutex;
+		std::unordered_map<std::string, entry> _entries;
+		unsigned int _generation = 0;
+	};
+
 	/// <summary>
 	/// A C-style preprocessor implementation.
 	/// </summary>
@@ -30,6 +108,10 @@ namespace reshadefx
 
 		// Define constructor explicitly because lexer class is not included here
 		preprocessor();
+		/// <summary>
+		/// Creates a preprocessor that loads files through the specified include <paramref name="cache"/>, so that files shared between multiple preprocessor instances are only read and tokenized once.
+		/// </summary>
+		explicit preprocessor(include_cache &cache);
 		~preprocessor();
 
 		/// <summary>
@@ -83,6 +165,11 @@ namespace reshadefx
 		/// Gets a list of paths to all the included files.
 		/// </summary>
 		std::vector<std::filesystem::path> included_files() const;
+		/// <summary>
+		/// Gets a list of absolute paths that were probed while resolving #include directives and 'exists' expressions, but did not exist.
+		/// A file created at one of these paths later on could change what a directive resolves to.
+		/// </summary>
+		std::vector<std::filesystem::path> missing_files() const;
 
 		/// <summary>
 		/// Gets a list of all defines that were used in #ifdef and #ifndef lines.
@@ -104,16 +191,32 @@ namespace reshadefx
 		};
 		struct input_level
 		{
-			std::string name;
+			string_atom name;
 			std::unique_ptr<class lexer> lexer;
+			// Text the lexer operates on, which is handed back to the preprocessor for reuse when this level is removed
+			std::unique_ptr<std::string> buffer;
+			// Files are not lexed again, but replay the token stream that was generated when they were loaded into the include cache
+			std::shared_ptr<const include_cache::file> file;
+			size_t next_token_index = 0;
 			token next_token;
-			std::unordered_set<std::string> hidden_macros;
+			// Index of the last macro hidden in this level in the list of hidden macros, which links back to the ones hidden in parent levels
+			size_t hidden_macros = std::numeric_limits<size_t>::max();
+
+			std::string_view input_string() const;
 		};
 
 		void error(const location &location, const std::string &message);
 		void warning(const location &location, const std::string &message);
 
 		void push(std::string input, const std::string &name = std::string());
+		void push(std::unique_ptr<std::string> input, const std::string &name = std::string());
+		void push(std::shared_ptr<const include_cache::file> file, const std::string &name);
+		void pop(size_t input_index);
+
+		std::unique_ptr<std::string> acquire_buffer();
+
+		std::shared_ptr<const include_cache::file> load_file(const std::filesystem::path &path);
+		std::filesystem::path resolve_include_path(const std::filesystem::path &file_name);
 
 		bool peek(tokenid tokid) const;
 		void consume();
@@ -139,7 +242,7 @@ namespace reshadefx
 		bool evaluate_identifier_as_macro();
 
 		bool is_defined(const std::string &name) const;
-		void expand_macro(const std::string &name, const macro &definition, const std::vector<std::string> &arguments);
+		void expand_macro(string_atom name, const macro &definition, size_t first_argument, size_t num_arguments);
 		void create_macro_replacement_list(macro &definition);
 
 		std::string _output, _errors;
@@ -147,6 +250,9 @@ namespace reshadefx
 		std::vector<input_level> _input_stack;
 		size_t _next_input_index = 0;
 		size_t _current_input_index = 0;
+		// Buffers and lexers of removed input levels are kept around, so that macro expansions do not have to allocate new ones
+		std::vector<std::unique_ptr<std::string>> _unused_buffers;
+		std::vector<std::unique_ptr<class lexer>> _unused_lexers;
 		reshadefx::token _token;
 		std::string _current_token_raw_data;
 		reshadefx::location _output_location;
@@ -154,12 +260,19 @@ namespace reshadefx
 		unsigned short _recursion_count = 0;
 		std::unordered_set<std::string> _used_macros;
 		std::unordered_map<std::string, macro> _macros;
+		// Macros that are not expanded again in an input level, each entry linking to the previous one that is hidden as well, so that input levels can share them with their parents instead of copying them
+		std::vector<std::pair<string_atom, size_t>> _hidden_macros;
+		// Arguments of the macro invocations that are currently being expanded, strings beyond the count are kept around for reuse
+		std::vector<std::string> _macro_arguments;
+		size_t _num_macro_arguments = 0;
 
 		std::vector<if_level> _if_stack;
 
 		std::vector<std::pair<std::string, std::string>> _used_pragmas;
 
 		std::vector<std::filesystem::path> _include_paths;
-		std::unordered_map<std::string, std::string> _file_cache;
+		std::set<std::string> _missing_files;
+		include_cache *const _include_cache = nullptr;
+		std::unordered_map<std::string, std::shared_ptr<const include_cache::file>> _file_cache;
 	};
 }
@@ -4,6 +4,7 @@
  */
 
 #include "effect_symbol_table.hpp"
+#include <cmath> // std::abs, std::floor, std::sqrt, ...
 #include <cassert>
 #include <malloc.h> // alloca
 #include <algorithm> // std::upper_bound, std::sort
@@ -183,9 +184,14 @@ unsigned int reshadefx::type::rank(const type &src, const type &dst)
 
 reshadefx::symbol_table::symbol_table()
 {
-	_current_scope.name = "::";
+	_current_scope.name = string_atom("::");
 	_current_scope.level = 0;
 	_current_scope.namespace_level = 0;
+
+	// Intern intrinsic names per symbol table, rather than once for the whole process, since the string table may be cleared between compilations
+	_intrinsic_names.reserve(std::size(s_intrinsics));
+	for (const intrinsic &intrinsic : s_intrinsics)
+		_intrinsic_names.emplace_back(intrinsic.name);
 }
 
 void reshadefx::symbol_table::enter_scope()
@@ -194,7 +200,7 @@ void reshadefx::symbol_table::enter_scope()
 }
 void reshadefx::symbol_table::enter_namespace(const std::string &name)
 {
-	_current_scope.name += name + "::";
+	_current_scope.name = string_atom(_current_scope.name.str() + name + "::");
 	_current_scope.level++;
 	_current_scope.namespace_level++;
 }
@@ -227,12 +233,13 @@ void reshadefx::symbol_table::leave_namespace()
 	assert(_current_scope.level > 0);
 	assert(_current_scope.namespace_level > 0);
 
-	_current_scope.name.erase(_current_scope.name.substr(0, _current_scope.name.size() - 2).rfind("::") + 2);
+	const std::string &name = _current_scope.name.str();
+	_current_scope.name = string_atom(std::string_view(name).substr(0, name.substr(0, name.size() - 2).rfind("::") + 2));
 	_current_scope.level--;
 	_current_scope.namespace_level--;
 }
 
-bool reshadefx::symbol_table::insert_symbol(const std::string &name, const symbol &symbol, bool global)
+bool reshadefx::symbol_table::insert_symbol(string_atom name, const symbol &symbol, bool global)
 {
 	assert(symbol.id != 0 || symbol.op == symbol_type::constant);
 
@@ -252,17 +259,19 @@ bool reshadefx::symbol_table::insert_symbol(const std::string &name, const symbo
 	// Global symbols are accessible from every scope
 	if (global)
 	{
-		scope scope = { "", 0, 0 };
+		scope scope = { string_atom(), 0, 0 };
+
+		const std::string &current_scope_name = _current_scope.name.str();
 
 		// Walk scope chain from global scope back to current one
-		for (size_t pos = 0; pos != std::string::npos; pos = _current_scope.name.find("::", pos))
+		for (size_t pos = 0; pos != std::string::npos; pos = current_scope_name.find("::", pos))
 		{
 			// Extract scope name
-			scope.name = _current_scope.name.substr(0, pos += 2);
-			const std::string previous_scope_name = _current_scope.name.substr(pos);
+			scope.name = string_atom(std::string_view(current_scope_name).substr(0, pos += 2));
+			const std::string previous_scope_name = current_scope_name.substr(pos);
 
 			// Insert symbol into this scope
-			insert_sorted(_symbol_stack[previous_scope_name + name], scoped_symbol { symbol, scope });
+			insert_sorted(_symbol_stack[previous_scope_name.empty() ? name : string_atom(previous_scope_name + name.str())], scoped_symbol { symbol, scope });
 
 			// Continue walking up the scope chain
 			scope.level = ++scope.namespace_level;
@@ -277,12 +286,12 @@ bool reshadefx::symbol_table::insert_symbol(const std::string &name, const symbo
 	return true;
 }
 
-reshadefx::scoped_symbol reshadefx::symbol_table::find_symbol(const std::string &name) const
+reshadefx::scoped_symbol reshadefx::symbol_table::find_symbol(string_atom name) const
 {
 	// Default to start search with current scope and walk back the scope chain
 	return find_symbol(name, _current_scope, false);
 }
-reshadefx::scoped_symbol reshadefx::symbol_table::find_symbol(const std::string &name, const scope &scope, bool exclusive) const
+reshadefx::scoped_symbol reshadefx::symbol_table::find_symbol(string_atom name, const scope &scope, bool exclusive) const
 {
 	const auto stack_it = _symbol_stack.find(name);
 
@@ -359,7 +368,7 @@ static int compare_functions(const std::vector<reshadefx::expression> &arguments
 	return 0; // Both functions are equally viable
 }
 
-bool reshadefx::symbol_table::resolve_function_call(const std::string &name, const std::vector<expression> &arguments, const scope &scope, symbol &out_data, bool &is_ambiguous) const
+bool reshadefx::symbol_table::resolve_function_call(string_atom name, const std::vector<expression> &arguments, const scope &scope, symbol &out_data, bool &is_ambiguous) const
 {
 	out_data.op = symbol_type::function;
 
@@ -426,9 +435,11 @@ bool reshadefx::symbol_table::resolve_function_call(const std::string &name, con
 	// Try matching against intrinsic functions if no matching user-defined function was found up to this point
 	if (num_overloads == 0)
 	{
-		for (const intrinsic &intrinsic : s_intrinsics)
+		for (size_t intrinsic_index = 0; intrinsic_index < std::size(s_intrinsics); ++intrinsic_index)
 		{
-			if (intrinsic.name != name || intrinsic.parameter_list.size() != arguments.size())
+			const intrinsic &intrinsic = s_intrinsics[intrinsic_index];
+
+			if (_intrinsic_names[intrinsic_index] != name || intrinsic.parameter_list.size() != arguments.size())
 				continue;
 
 			// A new possibly-matching intrinsic function was found, compare it against the current result
@@ -454,3 +465,127 @@ bool reshadefx::symbol_table::resolve_function_call(const std::string &name, con
 
 	return num_overloads == 1;
 }
+
+bool reshadefx::symbol_table::evaluate_constant_intrinsic_call(const function &intrinsic, const std::vector<expression> &arguments, constant &result)
+{
+	constant args[3];
+	if (arguments.size() != intrinsic.parameter_list.size() || arguments.size() > std::size(args))
+		return false;
+
+	for (size_t i = 0; i < arguments.size(); ++i)
+	{
+		const reshadefx::type &param_type = intrinsic.parameter_list[i].type;
+
+		if (!arguments[i].is_constant || param_type.has(type::q_out) || !param_type.is_numeric() || param_type.is_array())
+			return false;
+
+		expression argument_exp = arguments[i];
+		argument_exp.add_cast_operation(param_type);
+		args[i] = std::move(argument_exp.constant);
+	}
+
+	result = {};
+
+	// Only component-wise intrinsics are handled here, so every result component only depends on the same component of the arguments
+	for (unsigned int i = 0; i < intrinsic.return_type.components(); ++i)
+	{
+		switch (static_cast<intrinsic_id>(intrinsic.id))
+		{
+		case intrinsic_id::abs0:
+			result.as_int[i] = std::abs(args[0].as_int[i]);
+			break;
+		case intrinsic_id::abs1:
+			result.as_float[i] = std::abs(args[0].as_float[i]);
+			break;
+		case intrinsic_id::min0:
+			result.as_int[i] = std::min(args[0].as_int[i], args[1].as_int[i]);
+			break;
+		case intrinsic_id::min1:
+			result.as_float[i] = std::min(args[0].as_float[i], args[1].as_float[i]);
+			break;
+		case intrinsic_id::max0:
+			result.as_int[i] = std::max(args[0].as_int[i], args[1].as_int[i]);
+			break;
+		case intrinsic_id::max1:
+			result.as_float[i] = std::max(args[0].as_float[i], args[1].as_float[i]);
+			break;
+		case intrinsic_id::clamp0:
+			result.as_int[i] = std::min(std::max(args[0].as_int[i], args[1].as_int[i]), args[2].as_int[i]);
+			break;
+		case intrinsic_id::clamp1:
+			result.as_uint[i] = std::min(std::max(args[0].as_uint[i], args[1].as_uint[i]), args[2].as_uint[i]);
+			break;
+		case intrinsic_id::clamp2:
+			result.as_float[i] = std::min(std::max(args[0].as_float[i], args[1].as_float[i]), args[2].as_float[i]);
+			break;
+		case intrinsic_id::saturate0:
+			result.as_float[i] = std::min(std::max(args[0].as_float[i], 0.0f), 1.0f);
+			break;
+		case intrinsic_id::sign0:
+			result.as_int[i] = (args[0].as_int[i] > 0) - (args[0].as_int[i] < 0);
+			break;
+		case intrinsic_id::sign1:
+			result.as_float[i] = static_cast<float>((args[0].as_float[i] > 0.0f) - (args[0].as_float[i] < 0.0f));
+			break;
+		case intrinsic_id::floor0:
+			result.as_float[i] = std::floor(args[0].as_float[i]);
+			break;
+		case intrinsic_id::ceil0:
+			result.as_float[i] = std::ceil(args[0].as_float[i]);
+			break;
+		case intrinsic_id::trunc0:
+			result.as_float[i] = std::trunc(args[0].as_float[i]);
+			break;
+		case intrinsic_id::frac0:
+			result.as_float[i] = args[0].as_float[i] - std::floor(args[0].as_float[i]);
+			break;
+		case intrinsic_id::lerp0:
+			result.as_float[i] = args[0].as_float[i] + (args[1].as_float[i] - args[0].as_float[i]) * args[2].as_float[i];
+			break;
+		case intrinsic_id::rcp0:
+			result.as_float[i] = 1.0f / args[0].as_float[i];
+			break;
+		case intrinsic_id::sqrt0:
+			result.as_float[i] = std::sqrt(args[0].as_float[i]);
+			break;
+		case intrinsic_id::rsqrt0:
+			result.as_float[i] = 1.0f / std::sqrt(args[0].as_float[i]);
+			break;
+		case intrinsic_id::exp0:
+			result.as_float[i] = std::exp(args[0].as_float[i]);
+			break;
+		case intrinsic_id::exp20:
+			result.as_float[i] = std::exp2(args[0].as_float[i]);
+			break;
+		case intrinsic_id::log0:
+			result.as_float[i] = std::log(args[0].as_float[i]);
+			break;
+		case intrinsic_id::log20:
+			result.as_float[i] = std::log2(args[0].as_float[i]);
+			break;
+		case intrinsic_id::pow0:
+			result.as_float[i] = std::pow(args[0].as_float[i], args[1].as_float[i]);
+			break;
+		case intrinsic_id::sin0:
+			result.as_float[i] = std::sin(args[0].as_float[i]);
+			break;
+		case intrinsic_id::cos0:
+			result.as_float[i] = std::cos(args[0].as_float[i]);
+			break;
+		case intrinsic_id::radians0:
+			result.as_float[i] = args[0].as_float[i] * 0.0174532924f;
+			break;
+		case intrinsic_id::degrees0:
+			result.as_float[i] = args[0].as_float[i] * 57.2957802f;
+			break;
+		default:
+			return false;
+		}
+
+		// Leave values that cannot be represented as a literal in the generated code to the backend compiler
+		if (intrinsic.return_type.is_floating_point() && !std::isfinite(result.as_float[i]))
+			return false;
+	}
+
+	return true;
+}
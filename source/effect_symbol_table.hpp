@@ -15,7 +15,7 @@ namespace reshadefx
 	/// </summary>
 	struct scope
 	{
-		std::string name;
+		string_atom name;
 		uint32_t level, namespace_level;
 	};
 
@@ -82,22 +82,30 @@ namespace reshadefx
 		/// Inserts an new symbol in the symbol table.
 		/// Returns <see langword="false"/> if a symbol by that name and type already exists.
 		/// </summary>
-		bool insert_symbol(const std::string &name, const symbol &symbol, bool global = false);
+		bool insert_symbol(string_atom name, const symbol &symbol, bool global = false);
 
 		/// <summary>
 		/// Looks for an existing symbol with the specified <paramref name="name"/>.
 		/// </summary>
-		scoped_symbol find_symbol(const std::string &name) const;
-		scoped_symbol find_symbol(const std::string &name, const scope &scope, bool exclusive) const;
+		scoped_symbol find_symbol(string_atom name) const;
+		scoped_symbol find_symbol(string_atom name, const scope &scope, bool exclusive) const;
 
 		/// <summary>
 		/// Searches for the best function or intrinsic overload matching the argument list.
 		/// </summary>
-		bool resolve_function_call(const std::string &name, const std::vector<expression> &args, const scope &scope, symbol &data, bool &ambiguous) const;
+		bool resolve_function_call(string_atom name, const std::vector<expression> &args, const scope &scope, symbol &data, bool &ambiguous) const;
+
+		/// <summary>
+		/// Evaluates a call to an intrinsic with only constant arguments at compile time.
+		/// Returns <see langword="false"/> if this is not possible for the intrinsic or arguments.
+		/// </summary>
+		static bool evaluate_constant_intrinsic_call(const function &intrinsic, const std::vector<expression> &args, constant &result);
 
 	private:
 		scope _current_scope;
-		// Lookup table from name to matching symbols
-		std::unordered_map<std::string, std::vector<scoped_symbol>> _symbol_stack;
+		// Lookup table from name to matching symbols (names are interned, so this only needs to hash and compare pointers)
+		std::unordered_map<string_atom, std::vector<scoped_symbol>, string_atom::hash> _symbol_stack;
+		// Interned names of all intrinsic functions, in the same order as the intrinsic list
+		std::vector<string_atom> _intrinsic_names;
 	};
 }
@@ -8,9 +8,57 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <functional> // std::hash
+#include <string_view>
 
 namespace reshadefx
 {
+	/// <summary>
+	/// A string that was interned in a process-wide string table, so that it is just a pointer to the single copy of that string.
+	/// This makes atoms trivially copyable and comparing two of them does not have to look at the string contents.
+	/// The string table keeps growing until it is cleared with <see cref="clear_table"/>, which the owner of the compiled effects has to do once none of them are in use anymore.
+	/// </summary>
+	class string_atom
+	{
+	public:
+		struct hash
+		{
+			size_t operator()(string_atom atom) const { return std::hash<const void *>()(atom._string); }
+		};
+
+		string_atom() = default;
+		explicit string_atom(std::string_view value) : _string(value.empty() ? nullptr : intern(value)) {}
+
+		const std::string &str() const
+		{
+			static const std::string empty_string;
+			return _string != nullptr ? *_string : empty_string;
+		}
+		operator const std::string &() const { return str(); }
+
+		const char *c_str() const { return str().c_str(); }
+		size_t size() const { return _string != nullptr ? _string->size() : 0; }
+		bool empty() const { return _string == nullptr; }
+
+		bool operator==(string_atom other) const { return _string == other._string; }
+		bool operator!=(string_atom other) const { return _string != other._string; }
+		friend bool operator==(string_atom lhs, std::string_view rhs) { return std::string_view(lhs.str()) == rhs; }
+		friend bool operator!=(string_atom lhs, std::string_view rhs) { return std::string_view(lhs.str()) != rhs; }
+		friend bool operator==(std::string_view lhs, string_atom rhs) { return lhs == std::string_view(rhs.str()); }
+		friend bool operator!=(std::string_view lhs, string_atom rhs) { return lhs != std::string_view(rhs.str()); }
+
+		/// <summary>
+		/// Releases all interned strings.
+		/// Any atoms that still exist are left dangling, so this may only be called when none are in use anymore (e.g. after all effects were unloaded and no effect is currently being compiled).
+		/// </summary>
+		static void clear_table();
+
+	private:
+		static const std::string *intern(std::string_view value);
+
+		const std::string *_string = nullptr;
+	};
+
 	/// <summary>
 	/// Structure which keeps track of a code location.
 	/// </summary>
@@ -18,9 +66,9 @@ namespace reshadefx
 	{
 		location() : line(1), column(1) {}
 		explicit location(uint32_t line, uint32_t column = 1) : line(line), column(column) {}
-		explicit location(std::string source, uint32_t line, uint32_t column = 1) : source(std::move(source)), line(line), column(column) {}
+		explicit location(std::string_view source, uint32_t line, uint32_t column = 1) : source(source), line(line), column(column) {}
 
-		std::string source;
+		string_atom source;
 		uint32_t line, column;
 	};
 
@@ -244,7 +292,7 @@ namespace reshadefx
 			float literal_as_float;
 			double literal_as_double;
 		};
-		std::string literal_as_string;
+		string_atom literal_as_string;
 
 		operator tokenid() const { return id; }
 
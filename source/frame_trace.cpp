@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include "frame_trace.hpp"
+#include <cstdio> // std::snprintf
+#include <Windows.h>
+
+static void append_json_string(std::string &data, const std::string &value)
+{
+	data += '\"';
+	for (const char c : value)
+	{
+		switch (c)
+		{
+		case '\"':
+			data += "\\\"";
+			break;
+		case '\\':
+			data += "\\\\";
+			break;
+		default:
+			if (static_cast<unsigned char>(c) < 0x20)
+			{
+				char escaped[7];
+				std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned int>(c));
+				data += escaped;
+			}
+			else
+			{
+				data += c;
+			}
+			break;
+		}
+	}
+	data += '\"';
+}
+
+void reshade::frame_trace::begin(uint32_t frame_count)
+{
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	_events.clear();
+	_remaining_frames = frame_count;
+	_capture_start_time = clock::now();
+	_gpu_time_offset_valid = false;
+
+	_capturing.store(frame_count != 0, std::memory_order_relaxed);
+}
+
+bool reshade::frame_trace::end(const std::filesystem::path &path)
+{
+	std::vector<event> events;
+	uint32_t present_thread_id;
+	{
+		const std::unique_lock<std::mutex> lock(_mutex);
+
+		_capturing.store(false, std::memory_order_relaxed);
+		_remaining_frames = 0;
+
+		events = std::move(_events);
+		_events.clear();
+		present_thread_id = _present_thread_id;
+	}
+
+	const unsigned long process_id = GetCurrentProcessId();
+
+	std::string data;
+	data.reserve(events.size() * 128);
+
+	// Name the tracks, GPU events are put on a track with thread identifier zero, which is not used by any real thread on Windows
+	data += "{\"traceEvents\":[\n";
+	data += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" + std::to_string(process_id) + ",\"tid\":0,\"args\":{\"name\":\"ReShade\"}},\n";
+	data += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(process_id) + ",\"tid\":0,\"args\":{\"name\":\"GPU\"}},\n";
+	data += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(process_id) + ",\"tid\":" + std::to_string(present_thread_id) + ",\"args\":{\"name\":\"Present\"}}";
+
+	char number[32];
+
+	for (const event &event : events)
+	{
+		data += ",\n{\"name\":";
+		append_json_string(data, event.name);
+		data += ",\"cat\":\"";
+		data += event.category;
+		data += "\",\"ph\":\"";
+		data += event.phase;
+		data += "\",\"pid\":" + std::to_string(process_id) + ",\"tid\":" + std::to_string(event.thread_id);
+
+		// Timestamps are in microseconds
+		std::snprintf(number, sizeof(number), "%.3f", event.timestamp * 1e-3);
+		data += ",\"ts\":";
+		data += number;
+		if (event.phase == 'X')
+		{
+			std::snprintf(number, sizeof(number), "%.3f", event.duration * 1e-3);
+			data += ",\"dur\":";
+			data += number;
+		}
+		else
+		{
+			data += ",\"s\":\"t\"";
+		}
+
+		if (!event.detail.empty())
+		{
+			data += ",\"args\":{\"detail\":";
+			append_json_string(data, event.detail);
+			data += '}';
+		}
+
+		data += '}';
+	}
+
+	data += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	FILE *const file = _wfsopen(path.c_str(), L"w", SH_DENYWR);
+	if (file == nullptr)
+		return false;
+	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
+	return fclose(file) == 0 && file_size_written == data.size();
+}
+
+bool reshade::frame_trace::end_frame()
+{
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	_present_thread_id = GetCurrentThreadId();
+
+	if (_remaining_frames != 0)
+		_remaining_frames--;
+	return _remaining_frames == 0;
+}
+
+void reshade::frame_trace::add_span(const char *category, std::string name, clock::time_point begin, clock::time_point end, std::string detail)
+{
+	if (!is_capturing())
+		return;
+
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	_events.push_back({ 'X', category, std::move(name), std::move(detail), GetCurrentThreadId(),
+		std::chrono::duration_cast<std::chrono::nanoseconds>(begin - _capture_start_time).count(),
+		std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count() });
+}
+void reshade::frame_trace::add_gpu_span(const char *category, std::string name, uint64_t begin_ns, uint64_t end_ns, clock::time_point reference_time, std::string detail)
+{
+	if (!is_capturing())
+		return;
+
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	// Skip results of commands that were recorded before the capture started (which are only read back a few frames later)
+	if (reference_time < _capture_start_time)
+		return;
+
+	if (!_gpu_time_offset_valid)
+	{
+		_gpu_time_offset = std::chrono::duration_cast<std::chrono::nanoseconds>(reference_time - _capture_start_time).count() - static_cast<int64_t>(begin_ns);
+		_gpu_time_offset_valid = true;
+	}
+
+	_events.push_back({ 'X', category, std::move(name), std::move(detail), 0,
+		static_cast<int64_t>(begin_ns) + _gpu_time_offset,
+		static_cast<int64_t>(end_ns - begin_ns) });
+}
+void reshade::frame_trace::add_instant(const char *category, std::string name, std::string detail)
+{
+	if (!is_capturing())
+		return;
+
+	const clock::time_point time = clock::now();
+
+	const std::unique_lock<std::mutex> lock(_mutex);
+
+	_events.push_back({ 'i', category, std::move(name), std::move(detail), GetCurrentThreadId(),
+		std::chrono::duration_cast<std::chrono::nanoseconds>(time - _capture_start_time).count(),
+		0 });
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace reshade
+{
+	/// <summary>
+	/// Records begin and end events of a number of frames on a timeline, which can then be written to a file in the Chrome trace event format (as read by Perfetto or "chrome://tracing").
+	/// Events may be added from any thread, but are only recorded while a capture is in progress.
+	/// </summary>
+	class frame_trace
+	{
+	public:
+		using clock = std::chrono::high_resolution_clock;
+
+		/// <summary>
+		/// Measures the time from construction to destruction and adds it as a span on the calling thread, if a capture is in progress.
+		/// </summary>
+		class scope
+		{
+		public:
+			scope(frame_trace &trace, const char *category, const char *name, const std::string &detail = std::string()) :
+				_trace(trace.is_capturing() ? &trace : nullptr), _category(category), _name(name), _detail(_trace != nullptr ? detail : std::string()), _begin(_trace != nullptr ? clock::now() : clock::time_point())
+			{
+			}
+			~scope()
+			{
+				if (_trace != nullptr)
+					_trace->add_span(_category, _name, _begin, clock::now(), _detail);
+			}
+
+			scope(const scope &) = delete;
+			scope &operator=(const scope &) = delete;
+
+		private:
+			frame_trace *const _trace;
+			const char *const _category;
+			const char *const _name;
+			const std::string _detail;
+			const clock::time_point _begin;
+		};
+
+		/// <summary>
+		/// Starts capturing events of the next <paramref name="frame_count"/> frames, discarding any events recorded before.
+		/// </summary>
+		void begin(uint32_t frame_count);
+		/// <summary>
+		/// Stops capturing and writes the recorded events to a JSON file at the specified <paramref name="path"/>.
+		/// </summary>
+		bool end(const std::filesystem::path &path);
+
+		/// <summary>
+		/// Checks whether events are currently being recorded.
+		/// </summary>
+		bool is_capturing() const { return _capturing.load(std::memory_order_relaxed); }
+		/// <summary>
+		/// Gets the number of frames that are still to be captured.
+		/// </summary>
+		uint32_t remaining_frames() const { return _remaining_frames; }
+
+		/// <summary>
+		/// Counts a presented frame on the calling thread.
+		/// </summary>
+		/// <returns><see langword="true"/> once the requested number of frames was captured, <see langword="false"/> otherwise.</returns>
+		bool end_frame();
+
+		/// <summary>
+		/// Adds a span between the specified CPU times on the calling thread.
+		/// </summary>
+		void add_span(const char *category, std::string name, clock::time_point begin, clock::time_point end, std::string detail = std::string());
+		/// <summary>
+		/// Adds a span on the GPU timeline, with timestamps in nanoseconds of the GPU clock.
+		/// GPU timestamps are aligned to the CPU timeline once per capture, using the CPU time at which the first GPU span was recorded, so only their relative timing is accurate.
+		/// </summary>
+		/// <param name="reference_time">CPU time at which the command that wrote <paramref name="begin_ns"/> was recorded.</param>
+		void add_gpu_span(const char *category, std::string name, uint64_t begin_ns, uint64_t end_ns, clock::time_point reference_time, std::string detail = std::string());
+		/// <summary>
+		/// Adds an event without duration at the current time on the calling thread.
+		/// </summary>
+		void add_instant(const char *category, std::string name, std::string detail = std::string());
+
+	private:
+		struct event
+		{
+			char phase;
+			const char *category;
+			std::string name;
+			std::string detail;
+			uint32_t thread_id;
+			int64_t timestamp; // In nanoseconds since the capture started
+			int64_t duration;
+		};
+
+		std::atomic<bool> _capturing = false;
+		std::mutex _mutex;
+		std::vector<event> _events;
+		uint32_t _remaining_frames = 0;
+		uint32_t _present_thread_id = 0;
+		clock::time_point _capture_start_time;
+		bool _gpu_time_offset_valid = false;
+		int64_t _gpu_time_offset = 0;
+	};
+}
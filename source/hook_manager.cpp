@@ -5,6 +5,10 @@
 
 #include "dll_log.hpp"
 #include "hook_manager.hpp"
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <shared_mutex>
 #include <cstring> // std::strcmp
@@ -31,13 +35,33 @@ struct module_export
 	unsigned short ordinal;
 };
 
+/// <summary>
+/// Open addressing hash table of installed hooks, indexed by either their target or their replacement address.
+/// Slots are only ever filled in, never changed afterwards, so that it can be read without taking a lock. Once it gets too full, it is replaced with a larger copy instead of being resized in place.
+/// </summary>
+struct hook_index
+{
+	explicit hook_index(size_t capacity) : mask(capacity - 1), slots(new std::atomic<const named_hook *>[capacity])
+	{
+		for (size_t i = 0; i < capacity; ++i)
+			slots[i].store(nullptr, std::memory_order_relaxed);
+	}
+
+	const size_t mask;
+	size_t size = 0;
+	const std::unique_ptr<std::atomic<const named_hook *>[]> slots;
+};
+
 extern HMODULE g_module_handle;
 HMODULE g_export_module_handle = nullptr;
 static bool s_is_loading_export_module = false;
 extern std::filesystem::path g_reshade_dll_path;
 static std::filesystem::path s_export_hook_path;
-static std::shared_mutex s_hooks_mutex;
-static std::vector<named_hook> s_hooks;
+static std::mutex s_hooks_mutex; // Only needs to be held while adding hooks, looking up hooks goes through the lock-free indices below
+static std::deque<named_hook> s_hooks; // Use a deque, so that hooks do not move in memory when more are added
+static std::atomic<hook_index *> s_hooks_by_target = nullptr;
+static std::atomic<hook_index *> s_hooks_by_replacement = nullptr;
+static std::vector<std::unique_ptr<hook_index>> s_retired_hook_indices; // Indices that were replaced by a larger copy, but may still be in use by readers until all hooks are uninstalled
 static std::shared_mutex s_delayed_hook_paths_mutex;
 static std::vector<std::filesystem::path> s_delayed_hook_paths;
 static PVOID s_dll_notification_cookie = nullptr;
@@ -76,6 +100,47 @@ static std::vector<module_export> enumerate_module_exports(HMODULE handle)
 	return exports;
 }
 
+static size_t hash_address(reshade::hook::address address)
+{
+	// Fibonacci hashing, since function and virtual function table entry addresses are aligned, so the lower bits are mostly the same
+	return static_cast<size_t>((static_cast<uint64_t>(reinterpret_cast<uintptr_t>(address)) * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+static void insert_into_index(std::atomic<hook_index *> &index_ptr, reshade::hook::address reshade::hook::*key, const named_hook *hook)
+{
+	hook_index *index = index_ptr.load(std::memory_order_relaxed);
+
+	// Keep the load factor at or below 50%, so that probe sequences stay short and there is always an empty slot to terminate them
+	if (index == nullptr || (index->size + 1) * 2 > index->mask + 1)
+	{
+		auto new_index = std::make_unique<hook_index>(index != nullptr ? (index->mask + 1) * 2 : 256);
+
+		// Insert all hooks in installation order, so that the first installed hook with a specific key is found first during a lookup
+		for (const named_hook &existing_hook : s_hooks)
+		{
+			size_t slot = hash_address(existing_hook.*key) & new_index->mask;
+			while (new_index->slots[slot].load(std::memory_order_relaxed) != nullptr)
+				slot = (slot + 1) & new_index->mask;
+			new_index->slots[slot].store(&existing_hook, std::memory_order_relaxed);
+			new_index->size++;
+		}
+
+		// The hook that is being inserted was already added to the list above, so publishing the new index makes it visible too
+		index_ptr.store(new_index.get(), std::memory_order_release);
+
+		if (index != nullptr)
+			s_retired_hook_indices.push_back(std::unique_ptr<hook_index>(index));
+		new_index.release();
+		return;
+	}
+
+	size_t slot = hash_address(hook->*key) & index->mask;
+	while (index->slots[slot].load(std::memory_order_relaxed) != nullptr)
+		slot = (slot + 1) & index->mask;
+	index->slots[slot].store(hook, std::memory_order_release);
+	index->size++;
+}
+
 static bool install_internal(const char *name, reshade::hook &hook, hook_method method)
 {
 	// It does not make sense to install a hook which points to itself, so avoid that
@@ -122,8 +187,12 @@ static bool install_internal(const char *name, reshade::hook &hook, hook_method
 	}
 
 	// Protect access to hook list with a mutex
-	{ const std::unique_lock<std::shared_mutex> lock(s_hooks_mutex);
+	{ const std::unique_lock<std::mutex> lock(s_hooks_mutex);
 		s_hooks.push_back({ hook, name, method });
+		const named_hook &installed_hook = s_hooks.back();
+
+		insert_into_index(s_hooks_by_target, &reshade::hook::target, &installed_hook);
+		insert_into_index(s_hooks_by_replacement, &reshade::hook::replacement, &installed_hook);
 	}
 
 #if RESHADE_VERBOSE_LOG
@@ -279,22 +348,27 @@ static named_hook find_internal(reshade::hook::address target, reshade::hook::ad
 {
 	assert(target != nullptr || replacement != nullptr);
 
-	// Protect access to hook list with a mutex
-	const std::shared_lock<std::shared_mutex> lock(s_hooks_mutex);
-
-	// Enumerate list of installed hooks and find matching one
-	const auto it = std::find_if(s_hooks.cbegin(), s_hooks.cend(),
-		[target, replacement](const named_hook &hook) {
-			// If only a target address is provided, find the matching hook
-			if (replacement == nullptr)
-				return hook.target == target;
-			// Otherwise search with the replacement function address (since the target address may not be known inside a replacement function)
-			return hook.replacement == replacement &&
+	// If only a target address is provided, find the matching hook, otherwise search with the replacement function address (since the target address may not be known inside a replacement function)
+	const hook_index *const index = (replacement == nullptr ? s_hooks_by_target : s_hooks_by_replacement).load(std::memory_order_acquire);
+	if (index == nullptr)
+		return {};
+
+	// Walk the probe sequence until an empty slot is found, hooks with the same key are stored along it in installation order
+	for (size_t slot = hash_address(replacement == nullptr ? target : replacement) & index->mask;; slot = (slot + 1) & index->mask)
+	{
+		const named_hook *const hook = index->slots[slot].load(std::memory_order_acquire);
+		if (hook == nullptr)
+			break;
+
+		if (replacement == nullptr ?
+				hook->target == target :
+				hook->replacement == replacement &&
 				// Optionally compare the target address too, in case the replacement function is used to hook multiple targets
-				(target == nullptr || hook.target == target);
-		});
+				(target == nullptr || hook->target == target))
+			return *hook;
+	}
 
-	return it != s_hooks.cend() ? *it : named_hook {};
+	return {};
 }
 
 #ifndef RESHADE_TEST_APPLICATION
@@ -485,6 +559,10 @@ void reshade::hooks::uninstall()
 	for (named_hook &hook : s_hooks)
 		uninstall_internal(hook.name, hook, hook.method);
 
+	delete s_hooks_by_target.exchange(nullptr);
+	delete s_hooks_by_replacement.exchange(nullptr);
+	s_retired_hook_indices.clear();
+
 	s_hooks.clear();
 
 #ifndef RESHADE_TEST_APPLICATION
@@ -618,6 +696,12 @@ bool reshade::hooks::is_hooked(hook::address target)
 	return find_internal(target, nullptr).valid();
 }
 
+reshade::hook::address reshade::hooks::find_trampoline(hook::address target)
+{
+	const hook hook = find_internal(target, nullptr);
+	return hook.valid() ? hook.call() : nullptr;
+}
+
 reshade::hook::address reshade::hooks::call(hook::address replacement, hook::address target)
 {
 	for (int attempt = 0; attempt < 2; ++attempt)
@@ -53,6 +53,14 @@ namespace reshade::hooks
 	/// <param name="target">Original target address of a function.</param>
 	bool is_hooked(hook::address target);
 
+	/// <summary>
+	/// Gets the original/trampoline function for the specified hooked function.
+	/// This is equivalent to calling <see cref="is_hooked"/> followed by <see cref="call"/>, but only has to look up the hook once.
+	/// </summary>
+	/// <param name="target">Original target address of a function.</param>
+	/// <returns>Address of original/trampoline function, or <see langword="nullptr"/> if the function is not hooked.</returns>
+	hook::address find_trampoline(hook::address target);
+
 	/// <summary>
 	/// Gets the original/trampoline function for the specified hook.
 	/// </summary>
@@ -94,9 +102,8 @@ namespace reshade::hooks
 	inline R call_vtable(T *instance, Args... args)
 	{
 		const auto vtable_entry = vtable_from_instance(instance) + vtable_index;
-		const auto func = is_hooked(vtable_entry) ?
-			call<R(STDMETHODCALLTYPE *)(T *, Args...)>(nullptr, vtable_entry) :
-			reinterpret_cast<R(STDMETHODCALLTYPE *)(T *, Args...)>(*vtable_entry);
+		const hook::address trampoline = find_trampoline(vtable_entry);
+		const auto func = reinterpret_cast<R(STDMETHODCALLTYPE *)(T *, Args...)>(trampoline != nullptr ? trampoline : *vtable_entry);
 		return func(instance, std::forward<Args>(args)...);
 	}
 }
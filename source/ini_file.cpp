@@ -4,15 +4,152 @@
  */
 
 #include "ini_file.hpp"
+#include "dll_log.hpp"
+#include <deque>
 #include <shared_mutex>
+#include <condition_variable>
 #include <cctype> // std::toupper
 #include <cassert>
-#include <algorithm> // std::min, std::sort, std::transform
+#include <algorithm> // std::find_if, std::min, std::sort, std::transform
 #include <utf8/core.h>
+#include <Windows.h>
 
 static std::shared_mutex s_ini_cache_mutex;
 static std::unordered_map<std::wstring, std::unique_ptr<reshade::ini_file>> s_ini_cache;
 
+struct pending_save
+{
+	std::filesystem::path path;
+	std::string data;
+	std::filesystem::file_time_type modified_at;
+	uint64_t sequence;
+};
+
+// Saves are written on a background thread, which only runs while there are saves pending
+// It holds a reference to the module while running, so that the module cannot be unloaded before it finished
+static std::mutex s_save_mutex;
+static std::condition_variable s_save_condition;
+static std::deque<pending_save> s_pending_saves;
+static uint64_t s_last_queued_save = 0;
+static uint64_t s_last_completed_save = 0;
+static HANDLE s_save_thread = nullptr;
+static bool s_save_thread_running = false;
+static bool s_save_failed = false;
+
+static std::string to_upper(std::string str)
+{
+	std::transform(str.begin(), str.end(), str.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
+	return str;
+}
+
+static bool write_file(std::filesystem::path path, const std::string &data, std::filesystem::file_time_type modified_at)
+{
+	std::error_code ec;
+
+	// Replace the file a symbolic link points to instead of the link itself, so that the link is preserved
+	if (std::filesystem::is_symlink(path, ec))
+		if (std::filesystem::path target_path = std::filesystem::canonical(path, ec); !ec)
+			path = std::move(target_path);
+
+	// Create the temporary file next to the file it replaces, so that both are on the same volume and the rename is atomic
+	std::filesystem::path temp_path = path;
+	temp_path += L".tmp";
+
+	FILE *const file = _wfsopen(temp_path.c_str(), L"w", SH_DENYWR);
+	if (file == nullptr)
+		return false;
+	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
+	const bool success = fclose(file) == 0 && file_size_written == data.size();
+
+	if (success)
+	{
+		// Give the file the time stamp the INI was saved with, so that it is known to match what is in memory without having to query the time after the write
+		std::filesystem::last_write_time(temp_path, modified_at, ec);
+
+		// Only replace the original file once the new data was written completely, so that it is never left partially written
+		std::filesystem::rename(temp_path, path, ec);
+		if (!ec)
+			return true;
+	}
+
+	std::filesystem::remove(temp_path, ec);
+	return false;
+}
+
+static void wait_for_pending_saves()
+{
+	std::unique_lock<std::mutex> lock(s_save_mutex);
+	const uint64_t sequence = s_last_queued_save;
+	s_save_condition.wait(lock, [sequence]() { return s_last_completed_save >= sequence; });
+}
+static void process_pending_saves(std::unique_lock<std::mutex> &lock)
+{
+	while (!s_pending_saves.empty())
+	{
+		const pending_save save = std::move(s_pending_saves.front());
+		s_pending_saves.pop_front();
+
+		lock.unlock();
+		const bool success = write_file(save.path, save.data, save.modified_at);
+		if (!success)
+			reshade::log::message(reshade::log::level::error, "Failed to save INI file '%s'!", save.path.u8string().c_str());
+		lock.lock();
+
+		s_save_failed |= !success;
+		s_last_completed_save = save.sequence;
+		s_save_condition.notify_all();
+	}
+}
+static void queue_save(const std::filesystem::path &path, std::string &&data, std::filesystem::file_time_type modified_at)
+{
+	std::unique_lock<std::mutex> lock(s_save_mutex);
+
+	// Replace any save of the same file that was not written yet, since its data is outdated now
+	if (const auto it = std::find_if(s_pending_saves.begin(), s_pending_saves.end(), [&path](const pending_save &save) { return save.path == path; });
+		it != s_pending_saves.end())
+		s_pending_saves.erase(it);
+
+	s_pending_saves.push_back({ path, std::move(data), modified_at, ++s_last_queued_save });
+
+	if (s_save_thread_running)
+		return;
+
+	// The previous thread already finished processing saves at this point, so its handle is no longer needed
+	if (s_save_thread != nullptr)
+		CloseHandle(s_save_thread);
+
+	// Keep the module loaded until the thread exits, since it may otherwise be unloaded while the thread is still running its code
+	HMODULE module_handle = nullptr;
+	if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS, reinterpret_cast<LPCWSTR>(&queue_save), &module_handle))
+		module_handle = nullptr;
+
+	s_save_thread = CreateThread(nullptr, 0, [](LPVOID module_handle) -> DWORD {
+		std::unique_lock<std::mutex> lock(s_save_mutex);
+
+		process_pending_saves(lock);
+
+		s_save_thread_running = false;
+		lock.unlock();
+
+		if (module_handle != nullptr)
+			FreeLibraryAndExitThread(static_cast<HMODULE>(module_handle), 0);
+		return 0;
+	}, module_handle, 0, nullptr);
+
+	if (s_save_thread != nullptr)
+	{
+		s_save_thread_running = true;
+	}
+	else
+	{
+		// Fall back to saving on the calling thread if no thread could be created
+		if (module_handle != nullptr)
+			FreeLibrary(module_handle);
+
+		process_pending_saves(lock);
+	}
+}
+
 reshade::ini_file &reshade::global_config()
 {
 	return ini_file::load_cache(g_reshade_base_path / L"ReShade.ini");
@@ -45,6 +182,7 @@ bool reshade::ini_file::load()
 		fseek(file, 0, SEEK_SET);
 
 	std::string line_data, section;
+	section_type *section_data = nullptr;
 	line_data.resize(BUFSIZ);
 	while (fgets(line_data.data(), static_cast<int>(line_data.size() + 1), file))
 	{
@@ -65,9 +203,14 @@ bool reshade::ini_file::load()
 		if (line[0] == '[')
 		{
 			section = trim(line.substr(0, line.find(']')), " \t[]");
+			section_data = nullptr;
 			continue;
 		}
 
+		// Only look up the section once for all its keys
+		if (section_data == nullptr)
+			section_data = &modify(section);
+
 		// Read section content
 		const size_t assign_index = line.find('=');
 		if (assign_index != std::string::npos)
@@ -77,12 +220,12 @@ bool reshade::ini_file::load()
 
 			if (value.empty())
 			{
-				_sections[section].insert({ std::string(key), {} });
+				section_data->keys.insert({ std::string(key), {} });
 				continue;
 			}
 
 			// Append to key if it already exists
-			ini_file::value_type &elements = _sections[section][std::string(key)];
+			ini_file::value_type &elements = section_data->keys[std::string(key)];
 			for (size_t offset = 0, base = 0, len = value.size(); offset <= len;)
 			{
 				// Treat ",," as an escaped comma and only split on single ","
@@ -111,7 +254,7 @@ bool reshade::ini_file::load()
 		}
 		else
 		{
-			_sections[section].insert({ std::string(line), {} });
+			section_data->keys.insert({ std::string(line), {} });
 		}
 	}
 
@@ -121,9 +264,34 @@ bool reshade::ini_file::load()
 }
 bool reshade::ini_file::save()
 {
+	// Wait for any saves still being written in the background, so that those cannot overwrite this one afterwards and the file is up to date once this returns
+	wait_for_pending_saves();
+
 	if (!_modified)
 		return true;
 
+	std::string data;
+	if (!serialize(data))
+		return false;
+
+	return write_file(_path, data, _modified_at);
+}
+
+reshade::ini_file::section_type &reshade::ini_file::modify(const std::string &section)
+{
+	const auto insert = _sections.try_emplace(section);
+	if (insert.second)
+		insert.first->second.sort_key = to_upper(section);
+
+	insert.first->second.modified = true;
+
+	return insert.first->second;
+}
+
+bool reshade::ini_file::serialize(std::string &data)
+{
+	assert(_modified);
+
 	// Reset state even on failure to avoid 'flush_cache' repeatedly trying and failing to save
 	_modified = false;
 
@@ -132,89 +300,78 @@ bool reshade::ini_file::save()
 	if (!ec && (modified_at - _modified_at) > std::chrono::seconds(2))
 		return false; // File exists and was modified on disk and therefore may have different data, so cannot save
 
-	std::string data;
-	std::vector<std::string> section_names, key_names;
-
-	section_names.reserve(_sections.size());
-	for (const std::pair<const std::string, section_type> &section : _sections)
-		section_names.push_back(section.first);
+	// The file is given this time stamp when it is written, so that it is not loaded again afterwards
+	_modified_at = std::filesystem::file_time_type::clock::now();
 
-	// Sort sections to generate consistent files
-	std::sort(section_names.begin(), section_names.end(),
-		[](std::string a, std::string b) {
-			std::transform(a.begin(), a.end(), a.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-			std::transform(b.begin(), b.end(), b.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-			return a < b;
-		});
-
-	for (const std::string &section_name : section_names)
+	std::vector<section_type *> sorted_sections;
+	sorted_sections.reserve(_sections.size());
+	for (std::pair<const std::string, section_type> &section : _sections)
 	{
-		if (const section_type &keys = _sections.at(section_name); !keys.empty())
+		if (section.second.keys.empty())
+			continue;
+
+		// Only rebuild the text of sections that changed since the last save
+		if (section.second.modified)
 		{
-			key_names.clear();
-			key_names.reserve(keys.size());
-			for (const std::pair<const std::string, value_type> &key : keys)
-				key_names.push_back(key.first);
-
-			std::sort(key_names.begin(), key_names.end(),
-				[](std::string a, std::string b) {
-					std::transform(a.begin(), a.end(), a.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-					std::transform(b.begin(), b.end(), b.begin(), [](std::string::value_type c) { return static_cast<std::string::value_type>(std::toupper(c)); });
-					return a < b;
-				});
-
-			// Empty section should have been sorted to the top, so do not need to append it before keys
-			if (!section_name.empty())
-				data += '[' + section_name + ']' + '\n';
-
-			for (const std::string &key_name : key_names)
+			section.second.modified = false;
+
+			std::vector<std::pair<std::string, const std::pair<const std::string, value_type> *>> sorted_keys;
+			sorted_keys.reserve(section.second.keys.size());
+			for (const std::pair<const std::string, value_type> &key : section.second.keys)
+				sorted_keys.emplace_back(to_upper(key.first), &key);
+
+			// Sort keys to generate consistent files
+			std::sort(sorted_keys.begin(), sorted_keys.end(),
+				[](const auto &lhs, const auto &rhs) { return lhs.first < rhs.first; });
+
+			std::string &section_data = section.second.serialized_data;
+			section_data.clear();
+
+			// Empty section should be sorted to the top, so do not need to append it before keys
+			if (!section.first.empty())
+				section_data += '[' + section.first + ']' + '\n';
+
+			for (const auto &sorted_key : sorted_keys)
 			{
-				data += key_name + '=';
+				section_data += sorted_key.second->first;
+				section_data += '=';
 
-				if (const ini_file::value_type &elements = keys.at(key_name); !elements.empty())
+				bool first_element = true;
+				for (const std::string &element : sorted_key.second->second)
 				{
-					std::string value;
-					for (const std::string &element : elements)
-					{
-						// Empty elements mess with escaped commas, so simply skip them
-						if (element.empty())
-							continue;
-
-						value.reserve(value.size() + element.size() + 1);
-						for (const char c : element)
-							value.append(c == ',' ? 2 : 1, c);
-						value += ','; // Separate multiple values with a comma
-					}
+					// Empty elements mess with escaped commas, so simply skip them
+					if (element.empty())
+						continue;
 
-					// Remove the last comma
-					if (!value.empty())
-					{
-						assert(value.back() == ',');
-						value.pop_back();
-					}
+					// Separate multiple values with a comma
+					if (!first_element)
+						section_data += ',';
+					first_element = false;
 
-					data += value;
+					for (const char c : element)
+						section_data.append(c == ',' ? 2 : 1, c);
 				}
 
-				data += '\n';
+				section_data += '\n';
 			}
 
-			data += '\n';
+			section_data += '\n';
 		}
+
+		sorted_sections.push_back(&section.second);
 	}
 
-	FILE *const file = _wfsopen(_path.c_str(), L"w", SH_DENYWR);
-	if (file == nullptr)
-		return false;
-	const size_t file_size_written = fwrite(data.data(), 1, data.size(), file);
-	fclose(file);
-	if (file_size_written != data.size())
-		return false;
+	// Sort sections to generate consistent files
+	std::sort(sorted_sections.begin(), sorted_sections.end(),
+		[](const section_type *lhs, const section_type *rhs) { return lhs->sort_key < rhs->sort_key; });
 
-	// Flush stream to disk before updating last write time
-	_modified_at = std::filesystem::last_write_time(_path, ec);
+	size_t total_size = 0;
+	for (const section_type *section : sorted_sections)
+		total_size += section->serialized_data.size();
 
-	assert(!ec && std::filesystem::file_size(_path, ec) > 0);
+	data.reserve(total_size);
+	for (const section_type *section : sorted_sections)
+		data += section->serialized_data;
 
 	return true;
 }
@@ -227,9 +384,22 @@ bool reshade::ini_file::flush_cache()
 
 	// Save all files that were modified in one second intervals
 	for (auto &file : s_ini_cache)
+	{
 		// Check modified status before requesting file time, since the latter is costly and therefore should be avoided when not necessary
 		if (file.second->_modified && (std::filesystem::file_time_type::clock::now() - file.second->_modified_at) > std::chrono::seconds(1))
-			success &= file.second->save();
+		{
+			// Only build the data here and leave writing it to disk to the background thread, to avoid stalling the caller (which is usually the render thread)
+			if (std::string data; file.second->serialize(data))
+				queue_save(file.second->_path, std::move(data), file.second->_modified_at);
+			else
+				success = false;
+		}
+	}
+
+	// Report failures of background saves that completed in the meantime
+	const std::unique_lock<std::mutex> save_lock(s_save_mutex);
+	success &= !s_save_failed;
+	s_save_failed = false;
 
 	return success;
 }
@@ -243,6 +413,23 @@ bool reshade::ini_file::flush_cache(const std::filesystem::path &path)
 	return it != s_ini_cache.end() && it->second->save();
 }
 
+void reshade::ini_file::flush_pending_saves()
+{
+	// This is called during shutdown, when the save thread may have been terminated while holding the lock, so do not wait on it
+	std::unique_lock<std::mutex> lock(s_save_mutex, std::try_to_lock);
+	if (!lock.owns_lock())
+		return;
+
+	// Write saves the background thread did not get to on the calling thread, so that they are not lost
+	process_pending_saves(lock);
+
+	if (s_save_thread != nullptr)
+	{
+		CloseHandle(s_save_thread);
+		s_save_thread = nullptr;
+	}
+}
+
 void reshade::ini_file::clear_cache()
 {
 	const std::unique_lock<std::shared_mutex> lock(s_ini_cache_mutex);
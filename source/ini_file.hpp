@@ -41,13 +41,7 @@ namespace reshade
 		/// </summary>
 		bool has(const std::string &section, const std::string &key) const
 		{
-			const auto it1 = _sections.find(section);
-			if (it1 == _sections.end())
-				return false;
-			const auto it2 = it1->second.find(key);
-			if (it2 == it1->second.end())
-				return false;
-			return true;
+			return find(section, key) != nullptr;
 		}
 
 		/// <summary>
@@ -58,55 +52,43 @@ namespace reshade
 		template <typename T>
 		bool get(const std::string &section, const std::string &key, T &value) const
 		{
-			const auto it1 = _sections.find(section);
-			if (it1 == _sections.end())
+			const value_type *const elements = find(section, key);
+			if (elements == nullptr)
 				return false;
-			const auto it2 = it1->second.find(key);
-			if (it2 == it1->second.end())
-				return false;
-			value = convert<T>(it2->second, 0);
+			value = convert<T>(*elements, 0);
 			return true;
 		}
 		template <typename T, size_t SIZE>
 		bool get(const std::string &section, const std::string &key, T(&values)[SIZE]) const
 		{
-			const auto it1 = _sections.find(section);
-			if (it1 == _sections.end())
-				return false;
-			const auto it2 = it1->second.find(key);
-			if (it2 == it1->second.end())
+			const value_type *const elements = find(section, key);
+			if (elements == nullptr)
 				return false;
 			for (size_t i = 0; i < SIZE; ++i)
-				values[i] = convert<T>(it2->second, i);
+				values[i] = convert<T>(*elements, i);
 			return true;
 		}
 		template <typename T>
 		bool get(const std::string &section, const std::string &key, std::vector<T> &values) const
 		{
-			const auto it1 = _sections.find(section);
-			if (it1 == _sections.end())
+			const value_type *const elements = find(section, key);
+			if (elements == nullptr)
 				return false;
-			const auto it2 = it1->second.find(key);
-			if (it2 == it1->second.end())
-				return false;
-			values.resize(it2->second.size());
-			for (size_t i = 0; i < it2->second.size(); ++i)
-				values[i] = convert<T>(it2->second, i);
+			values.resize(elements->size());
+			for (size_t i = 0; i < elements->size(); ++i)
+				values[i] = convert<T>(*elements, i);
 			return true;
 		}
 		template <>
 		bool get(const std::string &section, const std::string &key, std::vector<std::pair<std::string, std::string>> &values) const
 		{
-			const auto it1 = _sections.find(section);
-			if (it1 == _sections.end())
+			const value_type *const elements = find(section, key);
+			if (elements == nullptr)
 				return false;
-			const auto it2 = it1->second.find(key);
-			if (it2 == it1->second.end())
-				return false;
-			values.resize(it2->second.size());
-			for (size_t i = 0; i < it2->second.size(); ++i)
+			values.resize(elements->size());
+			for (size_t i = 0; i < elements->size(); ++i)
 			{
-				std::string value = convert<std::string>(it2->second, i);
+				std::string value = convert<std::string>(*elements, i);
 				if (const size_t equals_sign = value.find('=');
 					equals_sign != std::string::npos)
 					values[i] = { value.substr(0, equals_sign), value.substr(equals_sign + 1) };
@@ -143,18 +125,14 @@ namespace reshade
 		template <>
 		void set(const std::string &section, const std::string &key, const std::string &value)
 		{
-			auto &v = _sections[section][key];
+			value_type &v = modify(section, key);
 			v.assign(1, value);
-			_modified = true;
-			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
 		void set(const std::string &section, const std::string &key, std::string &&value)
 		{
-			auto &v = _sections[section][key];
+			value_type &v = modify(section, key);
 			v.resize(1);
 			v[0] = std::forward<std::string>(value);
-			_modified = true;
-			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
 		template <>
 		void set(const std::string &section, const std::string &key, const std::filesystem::path &value)
@@ -164,42 +142,34 @@ namespace reshade
 		template <typename T, size_t SIZE>
 		void set(const std::string &section, const std::string &key, const T(&values)[SIZE], const size_t size = SIZE)
 		{
-			auto &v = _sections[section][key];
+			value_type &v = modify(section, key);
 			v.resize(size);
 			for (size_t i = 0; i < size; ++i)
 				v[i] = std::to_string(values[i]);
-			_modified = true;
-			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
 		template <typename T>
 		void set(const std::string &section, const std::string &key, const std::vector<T> &values)
 		{
-			auto &v = _sections[section][key];
+			value_type &v = modify(section, key);
 			v.resize(values.size());
 			for (size_t i = 0; i < values.size(); ++i)
 				v[i] = std::to_string(values[i]);
-			_modified = true;
-			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
 		template <>
 		void set(const std::string &section, const std::string &key, const std::vector<std::string> &values)
 		{
-			auto &v = _sections[section][key];
+			value_type &v = modify(section, key);
 			v = values;
-			_modified = true;
-			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
 		void set(const std::string &section, const std::string &key, std::vector<std::string> &&values)
 		{
-			auto &v = _sections[section][key];
+			value_type &v = modify(section, key);
 			v = std::forward<std::vector<std::string>>(values);
-			_modified = true;
-			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
 		template <>
 		void set(const std::string &section, const std::string &key, const std::vector<std::pair<std::string, std::string>> &values)
 		{
-			auto &v = _sections[section][key];
+			value_type &v = modify(section, key);
 			v.resize(values.size());
 			for (size_t i = 0; i < values.size(); ++i)
 			{
@@ -208,18 +178,14 @@ namespace reshade
 				if (!value.second.empty())
 					v[i] += '=' + value.second;
 			}
-			_modified = true;
-			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
 		template <>
 		void set(const std::string &section, const std::string &key, const std::vector<std::filesystem::path> &values)
 		{
-			auto &v = _sections[section][key];
+			value_type &v = modify(section, key);
 			v.resize(values.size());
 			for (size_t i = 0; i < values.size(); ++i)
 				v[i] = values[i].u8string();
-			_modified = true;
-			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
 
 		/// <summary>
@@ -237,13 +203,10 @@ namespace reshade
 		/// </summary>
 		void remove_key(const std::string &section, const std::string &key)
 		{
-			const auto it1 = _sections.find(section);
-			if (it1 == _sections.end())
+			const auto it = _sections.find(section);
+			if (it == _sections.end() || it->second.keys.erase(key) == 0)
 				return;
-			const auto it2 = it1->second.find(key);
-			if (it2 == it1->second.end())
-				return;
-			it1->second.erase(it2);
+			it->second.modified = true;
 			_modified = true;
 			_modified_at = std::filesystem::file_time_type::clock::now();
 		}
@@ -254,14 +217,21 @@ namespace reshade
 		bool load();
 		/// <summary>
 		/// Saves all changes to this INI file to disk.
+		/// The file is written to a temporary file first, which then replaces the original, so that it is never left partially written.
 		/// </summary>
 		bool save();
 
 		/// <summary>
 		/// Saves all changes to INI files that were loaded through <see cref="load_cache"/> to disk.
+		/// The files are written on a background thread, so this only returns <see langword="false"/> for failures of saves that completed since the last call.
 		/// </summary>
 		static bool flush_cache();
 		static bool flush_cache(const std::filesystem::path &path);
+		/// <summary>
+		/// Writes all saves that are still waiting for the background thread on the calling thread.
+		/// Call this on shutdown, since the background thread is terminated on process exit.
+		/// </summary>
+		static void flush_pending_saves();
 
 		/// <summary>
 		/// Removes all INI files from cache, without saving changes.
@@ -349,7 +319,37 @@ namespace reshade
 		/// <summary>
 		/// Describes a section of multiple key/value pairs in an INI file.
 		/// </summary>
-		using section_type = std::unordered_map<std::string, value_type>;
+		struct section_type
+		{
+			std::unordered_map<std::string, value_type> keys;
+			// Upper-case name of the section, so that sections can be sorted without converting their names on every comparison
+			std::string sort_key;
+			// Text of this section as it was last written to disk, which only needs to be rebuilt when the section was modified since
+			std::string serialized_data;
+			bool modified = true;
+		};
+
+		const value_type *find(const std::string &section, const std::string &key) const
+		{
+			const auto it1 = _sections.find(section);
+			if (it1 == _sections.end())
+				return nullptr;
+			const auto it2 = it1->second.keys.find(key);
+			if (it2 == it1->second.keys.end())
+				return nullptr;
+			return &it2->second;
+		}
+
+		value_type &modify(const std::string &section, const std::string &key)
+		{
+			section_type &section_data = modify(section);
+			_modified = true;
+			_modified_at = std::filesystem::file_time_type::clock::now();
+			return section_data.keys[key];
+		}
+		section_type &modify(const std::string &section);
+
+		bool serialize(std::string &data);
 
 		const std::filesystem::path _path;
 		std::unordered_map<std::string, section_type> _sections;
@@ -29,6 +29,13 @@ extern "C" BOOL WINAPI HookClipCursor(const RECT *lpRect);
 extern "C" auto WINAPI HookGetKeyState(int vKey) -> SHORT;
 extern "C" auto WINAPI HookGetAsyncKeyState(int vKey) -> SHORT;
 
+static auto find_input_window(HWND hwnd) -> decltype(s_windows)::iterator
+{
+	// Expired entries are only removed when a window is registered, so that looking up windows only ever requires a shared lock
+	const auto it = s_windows.find(hwnd);
+	return it != s_windows.end() && !it->second.expired() ? it : s_windows.end();
+}
+
 reshade::input::input(window_handle window)
 	: _window(window)
 {
@@ -63,6 +70,13 @@ std::shared_ptr<reshade::input> reshade::input::register_window(window_handle wi
 
 	const std::unique_lock<std::shared_mutex> lock(s_windows_mutex);
 
+	// Remove any expired entry from the list
+	for (auto it = s_windows.begin(); it != s_windows.end();)
+		if (it->second.expired())
+			it = s_windows.erase(it);
+		else
+			++it;
+
 	const auto insert = s_windows.emplace(static_cast<HWND>(window), std::weak_ptr<input>());
 
 	if (insert.second || insert.first->second.expired())
@@ -95,19 +109,13 @@ bool reshade::input::handle_window_message(const void *message_data)
 	if (details.message != WM_INPUT && !is_mouse_message && !is_keyboard_message)
 		return false;
 
-	// Guard access to windows list against race conditions
-	std::unique_lock<std::shared_mutex> lock(s_windows_mutex);
-
-	// Remove any expired entry from the list
-	for (auto it = s_windows.begin(); it != s_windows.end();)
-		if (it->second.expired())
-			it = s_windows.erase(it);
-		else
-			++it;
+	// Guard access to windows list against race conditions (it is only modified when a window is registered, so a shared lock is sufficient here)
+	std::shared_lock<std::shared_mutex> lock(s_windows_mutex);
 
 	// Look up the window in the list of known input windows
-	auto input_window = s_windows.find(details.hwnd);
+	auto input_window = find_input_window(details.hwnd);
 	const auto raw_input_window = s_raw_input_windows.find(details.hwnd);
+	const unsigned int raw_input_flags = raw_input_window != s_raw_input_windows.end() ? raw_input_window->second : 0;
 
 	if (input_window == s_windows.end())
 	{
@@ -115,28 +123,31 @@ bool reshade::input::handle_window_message(const void *message_data)
 		EnumChildWindows(details.hwnd, [](HWND hwnd, LPARAM lparam) -> BOOL {
 			auto &input_window = *reinterpret_cast<decltype(s_windows)::iterator *>(lparam);
 			// Return true to continue enumeration
-			return (input_window = s_windows.find(hwnd)) == s_windows.end();
+			return (input_window = find_input_window(hwnd)) == s_windows.end();
 		}, reinterpret_cast<LPARAM>(&input_window));
 	}
 	if (input_window == s_windows.end())
 	{
 		// Some applications handle input in a child window to the main render window
 		if (const HWND parent = GetParent(details.hwnd); parent != NULL)
-			input_window = s_windows.find(parent);
+			input_window = find_input_window(parent);
 	}
 
 	if (input_window == s_windows.end() && raw_input_window != s_raw_input_windows.end())
 	{
 		// Reroute this raw input message to the window with the most rendering
 		input_window = std::max_element(s_windows.begin(), s_windows.end(),
-			[](auto lhs, auto rhs) { return lhs.second.lock()->_frame_count < rhs.second.lock()->_frame_count; });
+			[](const auto &lhs, const auto &rhs) {
+				const std::shared_ptr<input> lhs_input = lhs.second.lock(), rhs_input = rhs.second.lock();
+				return (lhs_input != nullptr ? lhs_input->_frame_count.load() : 0) < (rhs_input != nullptr ? rhs_input->_frame_count.load() : 0);
+			});
 	}
 
 	if (input_window == s_windows.end())
 		return false;
 
 	const std::shared_ptr<input> input = input_window->second.lock();
-	// It may happen that the input was destroyed between the removal of expired entries above and here, so need to abort in this case
+	// It may happen that the input was destroyed since the lookup above, so need to abort in this case
 	if (input == nullptr)
 		return false;
 
@@ -146,11 +157,11 @@ bool reshade::input::handle_window_message(const void *message_data)
 	// Calculate window client mouse position
 	ScreenToClient(static_cast<HWND>(input->_window), &details.pt);
 
-	// Prevent input threads from modifying input while it is accessed elsewhere
-	const std::unique_lock<std::recursive_mutex> input_lock(input->_mutex);
+	// Only lock the received input state, which the snapshot of the current frame is copied from once per frame, so that readers of the snapshot are never blocked by this
+	const std::unique_lock<std::mutex> input_lock(input->_received_mutex);
 
-	input->_mouse_position[0] = details.pt.x;
-	input->_mouse_position[1] = details.pt.y;
+	input->_received_mouse_position[0] = details.pt.x;
+	input->_received_mouse_position[1] = details.pt.y;
 
 	switch (details.message)
 	{
@@ -165,34 +176,34 @@ bool reshade::input::handle_window_message(const void *message_data)
 		case RIM_TYPEMOUSE:
 			is_mouse_message = true;
 
-			if (raw_input_window == s_raw_input_windows.end() || (raw_input_window->second & 0x2) == 0)
+			if ((raw_input_flags & 0x2) == 0)
 				break; // Input is already handled (since legacy mouse messages are enabled), so nothing to do here
 
 			if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_DOWN)
-				input->_keys[VK_LBUTTON] = 0x88;
+				input->_received_keys[VK_LBUTTON] = 0x88;
 			else if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_UP)
-				input->_keys[VK_LBUTTON] = 0x08;
+				input->_received_keys[VK_LBUTTON] = 0x08;
 			if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_DOWN)
-				input->_keys[VK_RBUTTON] = 0x88;
+				input->_received_keys[VK_RBUTTON] = 0x88;
 			else if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_UP)
-				input->_keys[VK_RBUTTON] = 0x08;
+				input->_received_keys[VK_RBUTTON] = 0x08;
 			if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_MIDDLE_BUTTON_DOWN)
-				input->_keys[VK_MBUTTON] = 0x88;
+				input->_received_keys[VK_MBUTTON] = 0x88;
 			else if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_MIDDLE_BUTTON_UP)
-				input->_keys[VK_MBUTTON] = 0x08;
+				input->_received_keys[VK_MBUTTON] = 0x08;
 
 			if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_BUTTON_4_DOWN)
-				input->_keys[VK_XBUTTON1] = 0x88;
+				input->_received_keys[VK_XBUTTON1] = 0x88;
 			else if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_BUTTON_4_UP)
-				input->_keys[VK_XBUTTON1] = 0x08;
+				input->_received_keys[VK_XBUTTON1] = 0x08;
 
 			if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_BUTTON_5_DOWN)
-				input->_keys[VK_XBUTTON2] = 0x88;
+				input->_received_keys[VK_XBUTTON2] = 0x88;
 			else if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_BUTTON_5_UP)
-				input->_keys[VK_XBUTTON2] = 0x08;
+				input->_received_keys[VK_XBUTTON2] = 0x08;
 
 			if (raw_data.data.mouse.usButtonFlags & RI_MOUSE_WHEEL)
-				input->_mouse_wheel_delta += static_cast<short>(raw_data.data.mouse.usButtonData) / WHEEL_DELTA;
+				input->_received_mouse_wheel_delta += static_cast<short>(raw_data.data.mouse.usButtonData) / WHEEL_DELTA;
 			break;
 		case RIM_TYPEKEYBOARD:
 			if (raw_data.data.keyboard.VKey == 0)
@@ -200,76 +211,76 @@ bool reshade::input::handle_window_message(const void *message_data)
 
 			is_keyboard_message = true;
 			// Do not block key up messages if the key down one was not blocked previously
-			if (input->is_blocking_keyboard_input() && (raw_data.data.keyboard.Flags & RI_KEY_BREAK) != 0 && raw_data.data.keyboard.VKey < 0xFF && (input->_keys[raw_data.data.keyboard.VKey] & 0x04) == 0)
+			if (input->is_blocking_keyboard_input() && (raw_data.data.keyboard.Flags & RI_KEY_BREAK) != 0 && raw_data.data.keyboard.VKey < 0xFF && (input->_received_keys[raw_data.data.keyboard.VKey] & 0x04) == 0)
 				is_keyboard_message = false;
 
-			if (raw_input_window == s_raw_input_windows.end() || (raw_input_window->second & 0x1) == 0)
+			if ((raw_input_flags & 0x1) == 0)
 				break; // Input is already handled by 'WM_KEYDOWN' and friends (since legacy keyboard messages are enabled), so nothing to do here
 
 			// Filter out prefix messages without a key code
 			if (raw_data.data.keyboard.VKey < 0xFF)
-				input->_keys[raw_data.data.keyboard.VKey] = (raw_data.data.keyboard.Flags & RI_KEY_BREAK) == 0 ? 0x88 : 0x08,
-				input->_keys_time[raw_data.data.keyboard.VKey] = details.time;
+				input->_received_keys[raw_data.data.keyboard.VKey] = (raw_data.data.keyboard.Flags & RI_KEY_BREAK) == 0 ? 0x88 : 0x08,
+				input->_received_keys_time[raw_data.data.keyboard.VKey] = details.time;
 
 			// No 'WM_CHAR' messages are sent if legacy keyboard messages are disabled, so need to generate text input manually here
 			// Cannot use the ToUnicode function always as it seems to reset dead key state and thus calling it can break subsequent application input, should be fine here though since the application is already explicitly using raw input
 			// Since Windows 10 version 1607 this supports the 0x2 flag, which prevents the keyboard state from being changed, so it is not a problem there anymore either way
-			if (WCHAR ch[3] = {}; (raw_data.data.keyboard.Flags & RI_KEY_BREAK) == 0 && ToUnicode(raw_data.data.keyboard.VKey, raw_data.data.keyboard.MakeCode, input->_keys, ch, 2, 0x2))
-				input->_text_input += ch;
+			if (WCHAR ch[3] = {}; (raw_data.data.keyboard.Flags & RI_KEY_BREAK) == 0 && ToUnicode(raw_data.data.keyboard.VKey, raw_data.data.keyboard.MakeCode, input->_received_keys, ch, 2, 0x2))
+				input->_received_text_input += ch;
 			break;
 		}
 		break;
 	case WM_CHAR:
-		input->_text_input += static_cast<wchar_t>(details.wParam);
+		input->_received_text_input += static_cast<wchar_t>(details.wParam);
 		break;
 	case WM_KEYDOWN:
 	case WM_SYSKEYDOWN:
-		assert(details.wParam > 0 && details.wParam < ARRAYSIZE(input->_keys));
-		input->_keys[details.wParam] = 0x88;
-		input->_keys_time[details.wParam] = details.time;
+		assert(details.wParam > 0 && details.wParam < ARRAYSIZE(input->_received_keys));
+		input->_received_keys[details.wParam] = 0x88;
+		input->_received_keys_time[details.wParam] = details.time;
 		if (input->is_blocking_keyboard_input())
-			input->_keys[details.wParam] |= 0x04;
+			input->_received_keys[details.wParam] |= 0x04;
 		break;
 	case WM_KEYUP:
 	case WM_SYSKEYUP:
-		assert(details.wParam > 0 && details.wParam < ARRAYSIZE(input->_keys));
+		assert(details.wParam > 0 && details.wParam < ARRAYSIZE(input->_received_keys));
 		// Do not block key up messages if the key down one was not blocked previously (so key does not get stuck for the application)
-		if (input->is_blocking_keyboard_input() && (input->_keys[details.wParam] & 0x04) == 0)
+		if (input->is_blocking_keyboard_input() && (input->_received_keys[details.wParam] & 0x04) == 0)
 			is_keyboard_message = false;
-		input->_keys[details.wParam] = 0x08;
-		input->_keys_time[details.wParam] = details.time;
+		input->_received_keys[details.wParam] = 0x08;
+		input->_received_keys_time[details.wParam] = details.time;
 		break;
 	case WM_LBUTTONDOWN:
 	case WM_LBUTTONDBLCLK: // Double clicking generates this sequence: WM_LBUTTONDOWN -> WM_LBUTTONUP -> WM_LBUTTONDBLCLK -> WM_LBUTTONUP, so handle it like a normal down
-		input->_keys[VK_LBUTTON] = 0x88;
+		input->_received_keys[VK_LBUTTON] = 0x88;
 		break;
 	case WM_LBUTTONUP:
-		input->_keys[VK_LBUTTON] = 0x08;
+		input->_received_keys[VK_LBUTTON] = 0x08;
 		break;
 	case WM_RBUTTONDOWN:
 	case WM_RBUTTONDBLCLK:
-		input->_keys[VK_RBUTTON] = 0x88;
+		input->_received_keys[VK_RBUTTON] = 0x88;
 		break;
 	case WM_RBUTTONUP:
-		input->_keys[VK_RBUTTON] = 0x08;
+		input->_received_keys[VK_RBUTTON] = 0x08;
 		break;
 	case WM_MBUTTONDOWN:
 	case WM_MBUTTONDBLCLK:
-		input->_keys[VK_MBUTTON] = 0x88;
+		input->_received_keys[VK_MBUTTON] = 0x88;
 		break;
 	case WM_MBUTTONUP:
-		input->_keys[VK_MBUTTON] = 0x08;
+		input->_received_keys[VK_MBUTTON] = 0x08;
 		break;
 	case WM_MOUSEWHEEL:
-		input->_mouse_wheel_delta += GET_WHEEL_DELTA_WPARAM(details.wParam) / WHEEL_DELTA;
+		input->_received_mouse_wheel_delta += GET_WHEEL_DELTA_WPARAM(details.wParam) / WHEEL_DELTA;
 		break;
 	case WM_XBUTTONDOWN:
 		assert(HIWORD(details.wParam) == XBUTTON1 || HIWORD(details.wParam) == XBUTTON2);
-		input->_keys[VK_XBUTTON1 + (HIWORD(details.wParam) - XBUTTON1)] = 0x88;
+		input->_received_keys[VK_XBUTTON1 + (HIWORD(details.wParam) - XBUTTON1)] = 0x88;
 		break;
 	case WM_XBUTTONUP:
 		assert(HIWORD(details.wParam) == XBUTTON1 || HIWORD(details.wParam) == XBUTTON2);
-		input->_keys[VK_XBUTTON1 + (HIWORD(details.wParam) - XBUTTON1)] = 0x08;
+		input->_received_keys[VK_XBUTTON1 + (HIWORD(details.wParam) - XBUTTON1)] = 0x08;
 		break;
 	}
 
@@ -391,43 +402,60 @@ void reshade::input::next_frame()
 	static const auto GetKeyState_trampoline = reshade::hooks::is_hooked(GetKeyState) ? reshade::hooks::call(HookGetKeyState, GetKeyState) : GetKeyState;
 	static const auto GetAsyncKeyState_trampoline = reshade::hooks::is_hooked(GetAsyncKeyState) ? reshade::hooks::call(HookGetAsyncKeyState, GetAsyncKeyState) : GetAsyncKeyState;
 
+	const std::unique_lock<std::recursive_mutex> input_lock(_mutex);
+
 	_frame_count++;
 
 	// Backup key states from the last processed frame so that state transitions can be identified
 	std::copy_n(_keys, 256, _last_keys);
-
-	for (uint8_t &state : _keys)
-		state &= ~0x08;
-
-	// Reset any pressed down key states (apart from mouse buttons) that have not been updated for more than 5 seconds
-	// Do not check mouse buttons here, since 'GetAsyncKeyState' always returns the state of the physical mouse buttons, not the logical ones in case they were remapped
-	// See https://docs.microsoft.com/windows/win32/api/winuser/nf-winuser-getasynckeystate
-	// And time is not tracked for mouse buttons anyway
-	const DWORD time = GetTickCount();
-	for (unsigned int i = 8; i < 256; ++i)
-		if ((_keys[i] & 0x80) != 0 &&
-			(time - _keys_time[i]) > 5000 &&
-			(GetAsyncKeyState_trampoline(i) & 0x8000) == 0)
-			(_keys[i] = 0x08);
-
-	_text_input.clear();
-	_mouse_wheel_delta = 0;
 	_last_mouse_position[0] = _mouse_position[0];
 	_last_mouse_position[1] = _mouse_position[1];
 
-	// Update caps lock state
-	_keys[VK_CAPITAL] |= GetKeyState_trampoline(VK_CAPITAL) & 0x1;
-
-	// Update modifier key state
-	if ((_keys[VK_MENU] & 0x88) != 0 &&
-		(GetKeyState_trampoline(VK_MENU) & 0x8000) == 0)
-		(_keys[VK_MENU] = 0x08);
+	// Query system key state before locking, to keep the time the window message procedure may be blocked as short as possible
+	const DWORD time = GetTickCount();
+	const bool caps_lock_toggled = (GetKeyState_trampoline(VK_CAPITAL) & 0x1) != 0;
+	const bool menu_key_down = (GetKeyState_trampoline(VK_MENU) & 0x8000) != 0;
+	const bool print_screen_key_down = (GetAsyncKeyState_trampoline(VK_SNAPSHOT) & 0x8000) != 0;
 
-	// Update print screen state (there is no key down message, but the key up one is received via the message queue)
-	if ((_keys[VK_SNAPSHOT] & 0x80) == 0 &&
-		(GetAsyncKeyState_trampoline(VK_SNAPSHOT) & 0x8000) != 0)
-		(_keys[VK_SNAPSHOT] = 0x88),
-		(_keys_time[VK_SNAPSHOT] = time);
+	{
+		const std::unique_lock<std::mutex> received_lock(_received_mutex);
+
+		// Reset any pressed down key states (apart from mouse buttons) that have not been updated for more than 5 seconds
+		// Do not check mouse buttons here, since 'GetAsyncKeyState' always returns the state of the physical mouse buttons, not the logical ones in case they were remapped
+		// See https://docs.microsoft.com/windows/win32/api/winuser/nf-winuser-getasynckeystate
+		// And time is not tracked for mouse buttons anyway
+		for (unsigned int i = 8; i < 256; ++i)
+			if ((_received_keys[i] & 0x80) != 0 &&
+				(time - _received_keys_time[i]) > 5000 &&
+				(GetAsyncKeyState_trampoline(i) & 0x8000) == 0)
+				(_received_keys[i] = 0x08);
+
+		// Update caps lock state
+		if (caps_lock_toggled)
+			_received_keys[VK_CAPITAL] |= 0x1;
+
+		// Update modifier key state
+		if ((_received_keys[VK_MENU] & 0x88) != 0 && !menu_key_down)
+			(_received_keys[VK_MENU] = 0x08);
+
+		// Update print screen state (there is no key down message, but the key up one is received via the message queue)
+		if ((_received_keys[VK_SNAPSHOT] & 0x80) == 0 && print_screen_key_down)
+			(_received_keys[VK_SNAPSHOT] = 0x88),
+			(_received_keys_time[VK_SNAPSHOT] = time);
+
+		// Publish the received input as the snapshot for this frame
+		std::copy_n(_received_keys, 256, _keys);
+		_mouse_position[0] = _received_mouse_position[0];
+		_mouse_position[1] = _received_mouse_position[1];
+		_mouse_wheel_delta = _received_mouse_wheel_delta;
+		_text_input.swap(_received_text_input);
+
+		// Reset state that is only reported for a single frame
+		for (uint8_t &state : _received_keys)
+			state &= ~0x08;
+		_received_mouse_wheel_delta = 0;
+		_received_text_input.clear();
+	}
 
 	// Run through all forms of input blocking for all windows and establish whether any of them are blocking input
 	const std::shared_lock<std::shared_mutex> lock(s_windows_mutex);
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <mutex>
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -44,7 +45,8 @@ namespace reshade
 		/// <returns>Pointer to the input manager registered for this <paramref name="window"/>.</returns>
 		static std::shared_ptr<input> register_window(window_handle window);
 
-		// Before accessing input data with any of the member functions below, first call "lock()" and keep the returned object alive while accessing it.
+		// The member functions below access a snapshot of the input data that is only updated once per frame in "next_frame()", so that reading it never has to wait on the window message procedure.
+		// Before accessing input data with any of them, first call "lock()" and keep the returned object alive while accessing it.
 
 		bool is_key_down(unsigned int keycode) const;
 		bool is_key_pressed(unsigned int keycode) const;
@@ -95,14 +97,15 @@ namespace reshade
 		static bool is_blocking_any_mouse_cursor_warping();
 
 		/// <summary>
-		/// Locks access to the input data so it cannot be modified in another thread.
+		/// Locks access to the snapshot of the input data so it cannot be updated in another thread.
+		/// This does not block the window message procedure, which records input separately.
 		/// </summary>
 		/// <returns>RAII object holding the lock, which releases it after going out of scope.</returns>
 		auto lock() { return std::unique_lock<std::recursive_mutex>(_mutex); }
 
 		/// <summary>
 		/// Notifies the input manager to advance a frame.
-		/// This updates input state to e.g. track whether a key was pressed this frame or before.
+		/// This publishes the input received since the last call as the snapshot for the new frame and updates input state to e.g. track whether a key was pressed this frame or before.
 		/// </summary>
 		void next_frame();
 
@@ -125,18 +128,27 @@ namespace reshade
 		static bool handle_window_message(const void *message_data);
 
 	private:
-		std::recursive_mutex _mutex;
 		window_handle _window;
-		bool _block_mouse = false;
-		bool _block_keyboard = false;
-		bool _block_cursor_warping = false;
+		std::atomic<bool> _block_mouse = false;
+		std::atomic<bool> _block_keyboard = false;
+		std::atomic<bool> _block_cursor_warping = false;
+		std::atomic<uint64_t> _frame_count = 0; // Keep track of frame count to identify windows with a lot of rendering
+
+		// Input state as received by the window message procedure, which is only held locked for as long as it takes to update or copy it
+		std::mutex _received_mutex;
+		uint8_t _received_keys[256] = {};
+		unsigned int _received_keys_time[256] = {};
+		short _received_mouse_wheel_delta = 0;
+		unsigned int _received_mouse_position[2] = {};
+		std::wstring _received_text_input;
+
+		// Snapshot of the input state for the current frame
+		std::recursive_mutex _mutex;
 		uint8_t _keys[256] = {};
 		uint8_t _last_keys[256] = {};
-		unsigned int _keys_time[256] = {};
 		short _mouse_wheel_delta = 0;
 		unsigned int _mouse_position[2] = {};
 		unsigned int _last_mouse_position[2] = {};
-		uint64_t _frame_count = 0; // Keep track of frame count to identify windows with a lot of rendering
 		std::wstring _text_input;
 	};
 }
@@ -10,6 +10,7 @@
 #include "hook_manager.hpp"
 #include "addon_manager.hpp"
 #include <cstring> // std::memset, std::strlen
+#include <algorithm> // std::equal
 
 #define gl static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device())->_dispatch_table
 
@@ -344,8 +345,9 @@ static void update_framebuffer_object(GLenum target, GLuint framebuffer = 0)
 	const auto device = static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device());
 
 	// Get object from current binding in case it was not specified (though it may still be zero)
+	// Binding to 'GL_FRAMEBUFFER' binds to both 'GL_DRAW_FRAMEBUFFER' and 'GL_READ_FRAMEBUFFER', of which the draw binding is the one relevant here
 	if (framebuffer == 0)
-		gl.GetIntegerv(reshade::opengl::get_binding_for_target(target), reinterpret_cast<GLint *>(&framebuffer));
+		framebuffer = g_opengl_context->get_binding(target == GL_FRAMEBUFFER ? GL_DRAW_FRAMEBUFFER : target);
 
 	const reshade::api::resource_view default_attachment = device->get_framebuffer_attachment(framebuffer, GL_COLOR, 0);
 	g_opengl_context->update_current_window_height(default_attachment);
@@ -430,8 +432,7 @@ static bool copy_texture_region(GLenum src_target, GLuint src_object, GLint src_
 	// Check if this is actually referencing the default framebuffer, or really an attachment of a framebuffer object
 	if (src_target == GL_FRAMEBUFFER_DEFAULT && (src_object >= GL_COLOR_ATTACHMENT0 && src_object <= GL_COLOR_ATTACHMENT31))
 	{
-		GLint src_fbo = 0;
-		gl.GetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &src_fbo);
+		const GLuint src_fbo = g_opengl_context->get_binding(GL_READ_FRAMEBUFFER);
 
 		src = device->get_resource_from_view(device->get_framebuffer_attachment(src_fbo, GL_COLOR, src_object - GL_COLOR_ATTACHMENT0));
 	}
@@ -439,8 +440,7 @@ static bool copy_texture_region(GLenum src_target, GLuint src_object, GLint src_
 	reshade::api::resource dst = reshade::opengl::make_resource_handle(dst_target, dst_object);
 	if (dst_target == GL_FRAMEBUFFER_DEFAULT && (dst_object >= GL_COLOR_ATTACHMENT0 && dst_object <= GL_COLOR_ATTACHMENT31))
 	{
-		GLint dst_fbo = 0;
-		gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &dst_fbo);
+		const GLuint dst_fbo = g_opengl_context->get_binding(GL_DRAW_FRAMEBUFFER);
 
 		dst = device->get_resource_from_view(device->get_framebuffer_attachment(dst_fbo, GL_COLOR, dst_object - GL_COLOR_ATTACHMENT0));
 	}
@@ -520,8 +520,7 @@ static bool update_texture_region(GLenum target, GLuint object, GLint level, GLi
 		static_cast<uint32_t>(zoffset + depth)
 	};
 
-	GLint unpack = 0;
-	gl.GetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpack);
+	const GLuint unpack = g_opengl_context->get_binding(GL_PIXEL_UNPACK_BUFFER);
 	if (0 == unpack)
 	{
 		opengl_init_resource resource(desc);
@@ -544,6 +543,32 @@ static bool update_texture_region(GLenum target, GLuint object, GLint level, GLi
 	}
 }
 
+static void invalidate_input_layout(GLuint vertex_array = 0)
+{
+	if (g_opengl_context == nullptr)
+		return;
+
+	const GLuint vertex_array_binding = g_opengl_context->get_binding(GL_VERTEX_ARRAY);
+	// Functions without a vertex array object parameter modify the currently bound one
+	if (vertex_array == 0)
+		vertex_array = vertex_array_binding;
+
+	if (const auto it = g_opengl_context->_input_layout_cache.find(vertex_array);
+		it != g_opengl_context->_input_layout_cache.end())
+		it->second.dirty = true;
+
+	if (vertex_array == vertex_array_binding)
+		g_opengl_context->_current_vao_dirty = true;
+}
+
+static bool is_same_input_layout(const std::vector<reshade::api::input_element> &lhs, const std::vector<reshade::api::input_element> &rhs)
+{
+	return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+		[](const reshade::api::input_element &a, const reshade::api::input_element &b) {
+			return a.location == b.location && a.format == b.format && a.buffer_binding == b.buffer_binding && a.offset == b.offset && a.stride == b.stride && a.instance_step_rate == b.instance_step_rate;
+		});
+}
+
 static void update_current_input_layout(GLuint vertex_array_binding = 0)
 {
 	if (g_opengl_context->_current_vao_dirty &&
@@ -555,7 +580,7 @@ static void update_current_input_layout(GLuint vertex_array_binding = 0)
 		g_opengl_context->_current_vao_dirty = false;
 
 		if (vertex_array_binding == 0)
-			gl.GetIntegerv(GL_VERTEX_ARRAY_BINDING, reinterpret_cast<GLint *>(&vertex_array_binding));
+			vertex_array_binding = g_opengl_context->get_binding(GL_VERTEX_ARRAY);
 
 		if (vertex_array_binding == 0)
 		{
@@ -566,52 +591,74 @@ static void update_current_input_layout(GLuint vertex_array_binding = 0)
 			return;
 		}
 
-		GLint max_elements = 0;
-		gl.GetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_elements);
-
-		std::vector<reshade::api::input_element> elements;
-		elements.reserve(max_elements);
+		const reshade::api::pipeline pipeline = { (static_cast<uint64_t>(GL_VERTEX_ARRAY) << 40) | vertex_array_binding };
 
-		for (GLsizei i = 0; i < max_elements; ++i)
+		// Only need to query the input layout again and invoke the 'init_pipeline' event if it changed since the vertex array object was last bound
+		const auto [layout_it, inserted] = g_opengl_context->_input_layout_cache.try_emplace(vertex_array_binding);
+		reshade::opengl::device_context_impl::input_layout &layout = layout_it->second;
+		if (!inserted && !layout.dirty)
 		{
-			GLint enabled = GL_FALSE;
-			gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
-			if (GL_FALSE == enabled)
-				continue;
-
-			reshade::api::input_element &element = elements.emplace_back();
-			element.location = i;
-
-			GLint attrib_size = 0;
-			gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attrib_size);
-			GLint attrib_type = 0;
-			gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &attrib_type);
-			GLint attrib_normalized = 0;
-			gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &attrib_normalized);
-			element.format = reshade::opengl::convert_attrib_format(attrib_size, static_cast<GLenum>(attrib_type), static_cast<GLboolean>(attrib_normalized));
-
-			gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, reinterpret_cast<GLint *>(&element.stride));
-			gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_RELATIVE_OFFSET, reinterpret_cast<GLint *>(&element.offset));
-			gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_BINDING, reinterpret_cast<GLint *>(&element.buffer_binding));
-			gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, reinterpret_cast<GLint *>(&element.instance_step_rate));
+			g_opengl_context->_input_layout_cache_hits++;
 		}
+		else
+		{
+			g_opengl_context->_input_layout_cache_misses++;
 
-		reshade::api::pipeline_subobject subobject;
-		subobject.type = reshade::api::pipeline_subobject_type::input_layout;
-		subobject.count = static_cast<uint32_t>(elements.size());
-		subobject.data = elements.data();
+			const GLint max_elements = g_opengl_context->_max_vertex_attribs;
 
-		reshade::invoke_addon_event<reshade::addon_event::init_pipeline>(
-			g_opengl_context->get_device(),
-			get_opengl_pipeline_layout(),
-			1,
-			&subobject,
-			reshade::api::pipeline { (static_cast<uint64_t>(GL_VERTEX_ARRAY) << 40) | vertex_array_binding });
+			std::vector<reshade::api::input_element> elements;
+			elements.reserve(max_elements);
+
+			for (GLsizei i = 0; i < max_elements; ++i)
+			{
+				GLint enabled = GL_FALSE;
+				gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled);
+				if (GL_FALSE == enabled)
+					continue;
+
+				reshade::api::input_element &element = elements.emplace_back();
+				element.location = i;
+
+				GLint attrib_size = 0;
+				gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attrib_size);
+				GLint attrib_type = 0;
+				gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_TYPE, &attrib_type);
+				GLint attrib_normalized = 0;
+				gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &attrib_normalized);
+				element.format = reshade::opengl::convert_attrib_format(attrib_size, static_cast<GLenum>(attrib_type), static_cast<GLboolean>(attrib_normalized));
+
+				gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_STRIDE, reinterpret_cast<GLint *>(&element.stride));
+				gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_RELATIVE_OFFSET, reinterpret_cast<GLint *>(&element.offset));
+				gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_BINDING, reinterpret_cast<GLint *>(&element.buffer_binding));
+				gl.GetVertexAttribiv(i, GL_VERTEX_ATTRIB_ARRAY_DIVISOR, reinterpret_cast<GLint *>(&element.instance_step_rate));
+			}
+
+			// Applications commonly specify the same attribute pointers again every time, so only report the layout if it actually changed
+			const bool changed = inserted || !is_same_input_layout(layout.elements, elements);
+
+			layout.elements = std::move(elements);
+			layout.dirty = false;
+
+			if (changed)
+			{
+				reshade::api::pipeline_subobject subobject;
+				subobject.type = reshade::api::pipeline_subobject_type::input_layout;
+				subobject.count = static_cast<uint32_t>(layout.elements.size());
+				subobject.data = layout.elements.data();
+
+				reshade::invoke_addon_event<reshade::addon_event::init_pipeline>(
+					g_opengl_context->get_device(),
+					get_opengl_pipeline_layout(),
+					1,
+					&subobject,
+					pipeline);
+			}
+		}
 
 		reshade::invoke_addon_event<reshade::addon_event::bind_pipeline>(
 			g_opengl_context,
 			reshade::api::pipeline_stage::input_assembler,
-			reshade::api::pipeline { (static_cast<uint64_t>(GL_VERTEX_ARRAY) << 40) | vertex_array_binding });
+			pipeline);
 	}
 }
 #endif
@@ -626,8 +673,7 @@ static void update_current_primitive_topology(GLenum mode)
 	{
 		g_opengl_context->_current_vbo_dirty = false;
 
-		GLint count = 0;
-		gl.GetIntegerv(GL_MAX_VERTEX_ATTRIB_BINDINGS, &count);
+		const GLint count = g_opengl_context->_max_vertex_attrib_bindings;
 
 		temp_mem<reshade::api::resource> buffer_handles(count);
 		temp_mem<uint64_t> offsets_64(count);
@@ -696,8 +742,7 @@ static void update_current_primitive_topology(GLenum mode, GLenum index_type)
 	{
 		g_opengl_context->_current_ibo_dirty = false;
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 
 		reshade::invoke_addon_event<reshade::addon_event::bind_index_buffer>(
 			g_opengl_context,
@@ -794,13 +839,12 @@ extern "C" void APIENTRY glClear(GLbitfield mask)
 	{
 		const auto device = static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device());
 
-		GLint dst_fbo = 0;
-		gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &dst_fbo);
+		const GLuint dst_fbo = g_opengl_context->get_binding(GL_DRAW_FRAMEBUFFER);
 
 		if (const GLbitfield current_mask = mask & (GL_COLOR_BUFFER_BIT))
 		{
 			GLfloat color_value[4] = {};
-			gl.GetFloatv(GL_COLOR_CLEAR_VALUE, color_value);
+			g_opengl_context->get_clear_color(color_value);
 
 			const reshade::api::resource_view view = device->get_framebuffer_attachment(dst_fbo, current_mask, 0);
 			if (view != 0 &&
@@ -809,10 +853,8 @@ extern "C" void APIENTRY glClear(GLbitfield mask)
 		}
 		if (const GLbitfield current_mask = mask & (GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT))
 		{
-			GLfloat depth_value = 0.0f;
-			gl.GetFloatv(GL_DEPTH_CLEAR_VALUE, &depth_value);
-			GLint   stencil_value = 0;
-			gl.GetIntegerv(GL_STENCIL_CLEAR_VALUE, &stencil_value);
+			const GLfloat depth_value = g_opengl_context->get_clear_depth();
+			const GLint   stencil_value = g_opengl_context->get_clear_stencil();
 
 			const reshade::api::resource_view view = device->get_framebuffer_attachment(dst_fbo, current_mask, 0);
 			if (view != 0 &&
@@ -1361,8 +1403,7 @@ extern "C" void APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type,
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 		const uint32_t offset = (index_buffer_binding != 0) ? static_cast<uint32_t>(reinterpret_cast<uintptr_t>(indices) / reshade::opengl::get_index_type_size(type)) : 0;
 
 		if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(g_opengl_context, count, 1, offset, 0, 0))
@@ -1427,8 +1468,7 @@ void APIENTRY glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 		const uint32_t offset = (index_buffer_binding != 0) ? static_cast<uint32_t>(reinterpret_cast<uintptr_t>(indices) / reshade::opengl::get_index_type_size(type)) : 0;
 
 		if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(g_opengl_context, count, 1, offset, 0, 0))
@@ -1630,8 +1670,7 @@ void APIENTRY glMultiDrawElements(GLenum mode, const GLsizei *count, GLenum type
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 
 		for (GLsizei i = 0; i < drawcount; ++i)
 		{
@@ -1653,9 +1692,17 @@ void APIENTRY glDeleteBuffers(GLsizei n, const GLuint *buffers)
 {
 #if RESHADE_ADDON
 	if (g_opengl_context)
+	{
 		for (GLsizei i = 0; i < n; ++i)
 			if (gl.IsBuffer(buffers[i]))
 				destroy_resource_or_view(GL_BUFFER, buffers[i]);
+
+		// Deleting a buffer that is currently bound reverts the binding to zero
+		g_opengl_context->invalidate_binding(GL_ELEMENT_ARRAY_BUFFER);
+		g_opengl_context->invalidate_binding(GL_DRAW_INDIRECT_BUFFER);
+		g_opengl_context->invalidate_binding(GL_DISPATCH_INDIRECT_BUFFER);
+		g_opengl_context->invalidate_binding(GL_PIXEL_UNPACK_BUFFER);
+	}
 #endif
 
 	static const auto trampoline = reshade::hooks::call(glDeleteBuffers);
@@ -1744,6 +1791,10 @@ void APIENTRY glBindBuffer(GLenum target, GLuint buffer)
 	static const auto trampoline = reshade::hooks::call(glBindBuffer);
 	trampoline(target, buffer);
 
+#if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->set_binding(target, buffer);
+#endif
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
 	{
@@ -2357,14 +2408,32 @@ void APIENTRY glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transp
 #endif
 }
 
+void APIENTRY glEnableVertexAttribArray(GLuint index)
+{
+	static const auto trampoline = reshade::hooks::call(glEnableVertexAttribArray);
+	trampoline(index);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout();
+#endif
+}
+void APIENTRY glDisableVertexAttribArray(GLuint index)
+{
+	static const auto trampoline = reshade::hooks::call(glDisableVertexAttribArray);
+	trampoline(index);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout();
+#endif
+}
+
 void APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
 {
 	static const auto trampoline = reshade::hooks::call(glVertexAttribPointer);
 	trampoline(index, size, type, normalized, stride, pointer);
 
 #if RESHADE_ADDON >= 2
-	if (g_opengl_context != nullptr)
-		g_opengl_context->_current_vao_dirty = true;
+	invalidate_input_layout();
 #endif
 }
 #endif
@@ -2469,6 +2538,17 @@ void APIENTRY glUniformMatrix4x3fv(GLint location, GLsizei count, GLboolean tran
 #endif
 
 #ifdef GL_VERSION_3_0
+void APIENTRY glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers)
+{
+#if RESHADE_ADDON
+	// Deleting a framebuffer object that is currently bound reverts the binding to zero
+	if (g_opengl_context)
+		g_opengl_context->invalidate_binding(GL_FRAMEBUFFER);
+#endif
+
+	static const auto trampoline = reshade::hooks::call(glDeleteFramebuffers);
+	trampoline(n, framebuffers);
+}
 void APIENTRY glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers)
 {
 #if RESHADE_ADDON
@@ -2490,8 +2570,15 @@ void APIENTRY glDeleteVertexArrays(GLsizei n, const GLuint *arrays)
 		const auto device = static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device());
 
 		for (GLsizei i = 0; i < n; ++i)
+		{
 			if (gl.IsVertexArray(arrays[i]))
 				reshade::invoke_addon_event<reshade::addon_event::destroy_pipeline>(device, reshade::api::pipeline { (static_cast<uint64_t>(GL_VERTEX_ARRAY) << 40) | arrays[i] });
+
+			g_opengl_context->_input_layout_cache.erase(arrays[i]);
+		}
+
+		// Deleting the vertex array object that is currently bound reverts the binding to zero
+		g_opengl_context->invalidate_binding(GL_VERTEX_ARRAY);
 	}
 #endif
 
@@ -2620,8 +2707,7 @@ void APIENTRY glClearBufferiv(GLenum buffer, GLint drawbuffer, const GLint *valu
 
 		const auto device = static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device());
 
-		GLint fbo = 0;
-		gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fbo);
+		const GLuint fbo = g_opengl_context->get_binding(GL_DRAW_FRAMEBUFFER);
 
 		const reshade::api::resource_view view = device->get_framebuffer_attachment(fbo, buffer, drawbuffer);
 		if (view != 0)
@@ -2648,8 +2734,7 @@ void APIENTRY glClearBufferuiv(GLenum buffer, GLint drawbuffer, const GLuint *va
 
 		const auto device = static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device());
 
-		GLint fbo = 0;
-		gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fbo);
+		const GLuint fbo = g_opengl_context->get_binding(GL_DRAW_FRAMEBUFFER);
 
 		const reshade::api::resource_view view = device->get_framebuffer_attachment(fbo, buffer, drawbuffer);
 		if (view != 0)
@@ -2676,8 +2761,7 @@ void APIENTRY glClearBufferfv(GLenum buffer, GLint drawbuffer, const GLfloat *va
 
 		const auto device = static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device());
 
-		GLint fbo = 0;
-		gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fbo);
+		const GLuint fbo = g_opengl_context->get_binding(GL_DRAW_FRAMEBUFFER);
 
 		const reshade::api::resource_view view = device->get_framebuffer_attachment(fbo, buffer, drawbuffer);
 		if (view != 0)
@@ -2703,8 +2787,7 @@ void APIENTRY glClearBufferfi(GLenum buffer, GLint drawbuffer, GLfloat depth, GL
 
 		const auto device = static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device());
 
-		GLint fbo = 0;
-		gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &fbo);
+		const GLuint fbo = g_opengl_context->get_binding(GL_DRAW_FRAMEBUFFER);
 
 		const reshade::api::resource_view dsv = device->get_framebuffer_attachment(fbo, buffer, drawbuffer);
 		if (dsv != 0 &&
@@ -2726,10 +2809,8 @@ void APIENTRY glBlitFramebuffer(GLint srcX0, GLint srcY0, GLint srcX1, GLint src
 	{
 		const auto device = static_cast<reshade::opengl::device_impl *>(g_opengl_context->get_device());
 
-		GLint src_fbo = 0;
-		gl.GetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &src_fbo);
-		GLint dst_fbo = 0;
-		gl.GetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &dst_fbo);
+		const GLuint src_fbo = g_opengl_context->get_binding(GL_READ_FRAMEBUFFER);
+		const GLuint dst_fbo = g_opengl_context->get_binding(GL_DRAW_FRAMEBUFFER);
 
 		assert(srcX0 >= 0 && srcY0 >= 0 && srcX1 >= 0 && srcY1 >= 0 && dstX0 >= 0 && dstY0 >= 0 && dstX1 >= 0 && dstY1 >= 0);
 
@@ -2880,6 +2961,9 @@ void APIENTRY glBindFramebuffer(GLenum target, GLuint framebuffer)
 	trampoline(target, framebuffer);
 
 #if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->set_binding(target, framebuffer);
+
 	update_framebuffer_object(target, framebuffer);
 #endif
 }
@@ -2889,6 +2973,10 @@ void APIENTRY glBindVertexArray(GLuint array)
 	static const auto trampoline = reshade::hooks::call(glBindVertexArray);
 	trampoline(array);
 
+#if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->set_binding(GL_VERTEX_ARRAY, array);
+#endif
 #if RESHADE_ADDON >= 2
 	if (g_opengl_context)
 	{
@@ -3040,8 +3128,7 @@ void APIENTRY glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsi
 	trampoline(index, size, type, stride, pointer);
 
 #if RESHADE_ADDON >= 2
-	if (g_opengl_context != nullptr)
-		g_opengl_context->_current_vao_dirty = true;
+	invalidate_input_layout();
 #endif
 }
 #endif
@@ -3106,8 +3193,7 @@ void APIENTRY glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, c
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 		const uint32_t offset = (index_buffer_binding != 0) ? static_cast<uint32_t>(reinterpret_cast<uintptr_t>(indices) / reshade::opengl::get_index_type_size(type)) : 0;
 
 		if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(g_opengl_context, primcount, count, offset, 0, 0))
@@ -3182,8 +3268,7 @@ void APIENTRY glDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type,
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 		const uint32_t offset = (index_buffer_binding != 0) ? static_cast<uint32_t>(reinterpret_cast<uintptr_t>(indices) / reshade::opengl::get_index_type_size(type)) : 0;
 
 		if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(g_opengl_context, count, 1, offset, basevertex, 0))
@@ -3201,8 +3286,7 @@ void APIENTRY glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint en
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 		const uint32_t offset = (index_buffer_binding != 0) ? static_cast<uint32_t>(reinterpret_cast<uintptr_t>(indices) / reshade::opengl::get_index_type_size(type)) : 0;
 
 		if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(g_opengl_context, count, 1, offset, basevertex, 0))
@@ -3220,8 +3304,7 @@ void APIENTRY glDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLen
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 		const uint32_t offset = (index_buffer_binding != 0) ? static_cast<uint32_t>(reinterpret_cast<uintptr_t>(indices) / reshade::opengl::get_index_type_size(type)) : 0;
 
 		if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(g_opengl_context, primcount, count, offset, basevertex, 0))
@@ -3239,8 +3322,7 @@ void APIENTRY glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *count, G
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 
 		for (GLsizei i = 0; i < drawcount; ++i)
 		{
@@ -3257,6 +3339,18 @@ void APIENTRY glMultiDrawElementsBaseVertex(GLenum mode, const GLsizei *count, G
 }
 #endif
 
+#ifdef GL_VERSION_3_3
+void APIENTRY glVertexAttribDivisor(GLuint index, GLuint divisor)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexAttribDivisor);
+	trampoline(index, divisor);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout();
+#endif
+}
+#endif
+
 #ifdef GL_VERSION_4_0
 struct DrawArraysIndirectCommand
 {
@@ -3279,8 +3373,7 @@ void APIENTRY glDrawArraysIndirect(GLenum mode, const GLvoid *indirect)
 #if RESHADE_ADDON
 	if (g_opengl_context)
 	{
-		GLint indirect_buffer_binding = 0;
-		gl.GetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &indirect_buffer_binding);
+		const GLuint indirect_buffer_binding = g_opengl_context->get_binding(GL_DRAW_INDIRECT_BUFFER);
 		if (0 != indirect_buffer_binding)
 		{
 			update_current_primitive_topology(mode);
@@ -3312,8 +3405,7 @@ void APIENTRY glDrawElementsIndirect(GLenum mode, GLenum type, const GLvoid *ind
 #if RESHADE_ADDON
 	if (g_opengl_context)
 	{
-		GLint indirect_buffer_binding = 0;
-		gl.GetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &indirect_buffer_binding);
+		const GLuint indirect_buffer_binding = g_opengl_context->get_binding(GL_DRAW_INDIRECT_BUFFER);
 		if (0 != indirect_buffer_binding)
 		{
 			update_current_primitive_topology(mode, type);
@@ -3350,6 +3442,17 @@ void APIENTRY glDrawElementsIndirect(GLenum mode, GLenum type, const GLvoid *ind
 #endif
 
 #ifdef GL_VERSION_4_1
+void APIENTRY glClearDepthf(GLfloat d)
+{
+	static const auto trampoline = reshade::hooks::call(glClearDepthf);
+	trampoline(d);
+
+#if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->set_clear_depth(d);
+#endif
+}
+
 void APIENTRY glScissorArrayv(GLuint first, GLsizei count, const GLint *v)
 {
 	static const auto trampoline = reshade::hooks::call(glScissorArrayv);
@@ -3513,8 +3616,7 @@ void APIENTRY glVertexAttribLPointer(GLuint index, GLint size, GLenum type, GLsi
 	trampoline(index, size, type, stride, pointer);
 
 #if RESHADE_ADDON >= 2
-	if (g_opengl_context != nullptr)
-		g_opengl_context->_current_vao_dirty = true;
+	invalidate_input_layout();
 #endif
 }
 #endif
@@ -3616,8 +3718,7 @@ void APIENTRY glDrawElementsInstancedBaseInstance(GLenum mode, GLsizei count, GL
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 		const uint32_t offset = (index_buffer_binding != 0) ? static_cast<uint32_t>(reinterpret_cast<uintptr_t>(indices) / reshade::opengl::get_index_type_size(type)) : 0;
 
 		if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(g_opengl_context, primcount, count, offset, 0, baseinstance))
@@ -3635,8 +3736,7 @@ void APIENTRY glDrawElementsInstancedBaseVertexBaseInstance(GLenum mode, GLsizei
 	{
 		update_current_primitive_topology(mode, type);
 
-		GLint index_buffer_binding = 0;
-		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &index_buffer_binding);
+		const GLuint index_buffer_binding = g_opengl_context->get_binding(GL_ELEMENT_ARRAY_BUFFER);
 		const uint32_t offset = (index_buffer_binding != 0) ? static_cast<uint32_t>(reinterpret_cast<uintptr_t>(indices) / reshade::opengl::get_index_type_size(type)) : 0;
 
 		if (reshade::invoke_addon_event<reshade::addon_event::draw_indexed>(g_opengl_context, primcount, count, offset, basevertex, baseinstance))
@@ -3748,6 +3848,52 @@ void APIENTRY glBindVertexBuffer(GLuint bindingindex, GLuint buffer, GLintptr of
 #endif
 }
 
+void APIENTRY glVertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexAttribFormat);
+	trampoline(attribindex, size, type, normalized, relativeoffset);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout();
+#endif
+}
+void APIENTRY glVertexAttribIFormat(GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexAttribIFormat);
+	trampoline(attribindex, size, type, relativeoffset);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout();
+#endif
+}
+void APIENTRY glVertexAttribLFormat(GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexAttribLFormat);
+	trampoline(attribindex, size, type, relativeoffset);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout();
+#endif
+}
+void APIENTRY glVertexAttribBinding(GLuint attribindex, GLuint bindingindex)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexAttribBinding);
+	trampoline(attribindex, bindingindex);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout();
+#endif
+}
+void APIENTRY glVertexBindingDivisor(GLuint bindingindex, GLuint divisor)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexBindingDivisor);
+	trampoline(bindingindex, divisor);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout();
+#endif
+}
+
 void APIENTRY glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
 {
 #if RESHADE_ADDON
@@ -3766,8 +3912,7 @@ void APIENTRY glDispatchComputeIndirect(GLintptr indirect)
 #if RESHADE_ADDON
 	if (g_opengl_context)
 	{
-		GLint indirect_buffer_binding = 0;
-		gl.GetIntegerv(GL_DISPATCH_INDIRECT_BUFFER_BINDING, &indirect_buffer_binding);
+		const GLuint indirect_buffer_binding = g_opengl_context->get_binding(GL_DISPATCH_INDIRECT_BUFFER);
 		if (0 != indirect_buffer_binding)
 		{
 			if (reshade::invoke_addon_event<reshade::addon_event::draw_or_dispatch_indirect>(
@@ -3795,8 +3940,7 @@ void APIENTRY glMultiDrawArraysIndirect(GLenum mode, const void *indirect, GLsiz
 #if RESHADE_ADDON
 	if (g_opengl_context)
 	{
-		GLint indirect_buffer_binding = 0;
-		gl.GetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &indirect_buffer_binding);
+		const GLuint indirect_buffer_binding = g_opengl_context->get_binding(GL_DRAW_INDIRECT_BUFFER);
 		if (0 != indirect_buffer_binding)
 		{
 			update_current_primitive_topology(mode);
@@ -3831,8 +3975,7 @@ void APIENTRY glMultiDrawElementsIndirect(GLenum mode, GLenum type, const void *
 #if RESHADE_ADDON
 	if (g_opengl_context)
 	{
-		GLint indirect_buffer_binding = 0;
-		gl.GetIntegerv(GL_DRAW_INDIRECT_BUFFER_BINDING, &indirect_buffer_binding);
+		const GLuint indirect_buffer_binding = g_opengl_context->get_binding(GL_DRAW_INDIRECT_BUFFER);
 		if (0 != indirect_buffer_binding)
 		{
 			update_current_primitive_topology(mode, type);
@@ -4667,6 +4810,86 @@ void APIENTRY glGenerateTextureMipmap(GLuint texture)
 	trampoline(texture);
 }
 
+void APIENTRY glEnableVertexArrayAttrib(GLuint vaobj, GLuint index)
+{
+	static const auto trampoline = reshade::hooks::call(glEnableVertexArrayAttrib);
+	trampoline(vaobj, index);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout(vaobj);
+#endif
+}
+void APIENTRY glDisableVertexArrayAttrib(GLuint vaobj, GLuint index)
+{
+	static const auto trampoline = reshade::hooks::call(glDisableVertexArrayAttrib);
+	trampoline(vaobj, index);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout(vaobj);
+#endif
+}
+void APIENTRY glVertexArrayAttribFormat(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexArrayAttribFormat);
+	trampoline(vaobj, attribindex, size, type, normalized, relativeoffset);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout(vaobj);
+#endif
+}
+void APIENTRY glVertexArrayAttribIFormat(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexArrayAttribIFormat);
+	trampoline(vaobj, attribindex, size, type, relativeoffset);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout(vaobj);
+#endif
+}
+void APIENTRY glVertexArrayAttribLFormat(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexArrayAttribLFormat);
+	trampoline(vaobj, attribindex, size, type, relativeoffset);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout(vaobj);
+#endif
+}
+void APIENTRY glVertexArrayAttribBinding(GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexArrayAttribBinding);
+	trampoline(vaobj, attribindex, bindingindex);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout(vaobj);
+#endif
+}
+void APIENTRY glVertexArrayBindingDivisor(GLuint vaobj, GLuint bindingindex, GLuint divisor)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexArrayBindingDivisor);
+	trampoline(vaobj, bindingindex, divisor);
+
+#if RESHADE_ADDON >= 2
+	invalidate_input_layout(vaobj);
+#endif
+}
+void APIENTRY glVertexArrayElementBuffer(GLuint vaobj, GLuint buffer)
+{
+	static const auto trampoline = reshade::hooks::call(glVertexArrayElementBuffer);
+	trampoline(vaobj, buffer);
+
+#if RESHADE_ADDON
+	// The element array buffer binding is part of the vertex array object state, so this changes the current binding if that vertex array object is bound
+	if (g_opengl_context && vaobj == g_opengl_context->get_binding(GL_VERTEX_ARRAY))
+	{
+		g_opengl_context->set_binding(GL_ELEMENT_ARRAY_BUFFER, buffer);
+#if RESHADE_ADDON >= 2
+		g_opengl_context->_current_ibo_dirty = true;
+#endif
+	}
+#endif
+}
+
 void APIENTRY glBindTextureUnit(GLuint unit, GLuint texture)
 {
 	static const auto trampoline = reshade::hooks::call(glBindTextureUnit);
@@ -4806,6 +5029,9 @@ void APIENTRY glBindFramebufferEXT(GLenum target, GLuint framebuffer)
 	trampoline(target, framebuffer);
 
 #if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->set_binding(target, framebuffer);
+
 	update_framebuffer_object(target, framebuffer);
 #endif
 }
@@ -54,6 +54,7 @@ extern "C" void APIENTRY glClearNamedFramebufferfv(GLuint framebuffer, GLenum bu
 extern "C" void APIENTRY glClearNamedFramebufferfi(GLuint framebuffer, GLenum buffer, GLint drawbuffer, GLfloat depth, GLint stencil);
 extern "C" void APIENTRY glClearColor(GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha);
 extern "C" void APIENTRY glClearDepth(GLclampd depth);
+extern "C" void APIENTRY glClearDepthf(GLfloat d);
 extern "C" void APIENTRY glClearStencil(GLint s);
 extern "C" void APIENTRY glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha);
 extern "C" void APIENTRY glCompressedTexImage1D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLint border, GLsizei imageSize, const void *data);
@@ -78,6 +79,7 @@ extern "C" void APIENTRY glCopyTextureSubImage2D(GLuint texture, GLint level, GL
 extern "C" void APIENTRY glCopyTextureSubImage3D(GLuint texture, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLint x, GLint y, GLsizei width, GLsizei height);
 extern "C" void APIENTRY glCullFace(GLenum mode);
 extern "C" void APIENTRY glDeleteBuffers(GLsizei n, const GLuint *buffers);
+extern "C" void APIENTRY glDeleteFramebuffers(GLsizei n, const GLuint *framebuffers);
 extern "C" void APIENTRY glDeleteProgram(GLuint program);
 extern "C" void APIENTRY glDeleteProgramsARB(GLsizei n, const GLuint *programs);
 extern "C" void APIENTRY glDeleteRenderbuffers(GLsizei n, const GLuint *renderbuffers);
@@ -87,6 +89,8 @@ extern "C" void APIENTRY glDepthFunc(GLenum func);
 extern "C" void APIENTRY glDepthMask(GLboolean flag);
 extern "C" void APIENTRY glDepthRange(GLclampd zNear, GLclampd zFar);
 extern "C" void APIENTRY glDisable(GLenum cap);
+extern "C" void APIENTRY glDisableVertexArrayAttrib(GLuint vaobj, GLuint index);
+extern "C" void APIENTRY glDisableVertexAttribArray(GLuint index);
 extern "C" void APIENTRY glDispatchCompute(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
 extern "C" void APIENTRY glDispatchComputeIndirect(GLintptr indirect);
 extern "C" void APIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count);
@@ -104,6 +108,8 @@ extern "C" void APIENTRY glDrawElementsInstancedBaseVertexBaseInstance(GLenum mo
 extern "C" void APIENTRY glDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const GLvoid *indices);
 extern "C" void APIENTRY glDrawRangeElementsBaseVertex(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const GLvoid *indices, GLint basevertex);
 extern "C" void APIENTRY glEnable(GLenum cap);
+extern "C" void APIENTRY glEnableVertexArrayAttrib(GLuint vaobj, GLuint index);
+extern "C" void APIENTRY glEnableVertexAttribArray(GLuint index);
 extern "C" void APIENTRY glFinish();
 extern "C" void APIENTRY glFlush();
 extern "C" void APIENTRY glFramebufferTexture(GLenum target, GLenum attachment, GLuint texture, GLint level);
@@ -235,9 +241,21 @@ extern "C" void APIENTRY glUniformMatrix4x3fv(GLint location, GLsizei count, GLb
 extern "C" void APIENTRY glUnmapBuffer(GLenum target);
 extern "C" void APIENTRY glUnmapNamedBuffer(GLuint buffer);
 extern "C" void APIENTRY glUseProgram(GLuint program);
+extern "C" void APIENTRY glVertexArrayAttribBinding(GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+extern "C" void APIENTRY glVertexArrayAttribFormat(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+extern "C" void APIENTRY glVertexArrayAttribIFormat(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+extern "C" void APIENTRY glVertexArrayAttribLFormat(GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+extern "C" void APIENTRY glVertexArrayBindingDivisor(GLuint vaobj, GLuint bindingindex, GLuint divisor);
+extern "C" void APIENTRY glVertexArrayElementBuffer(GLuint vaobj, GLuint buffer);
+extern "C" void APIENTRY glVertexAttribBinding(GLuint attribindex, GLuint bindingindex);
+extern "C" void APIENTRY glVertexAttribDivisor(GLuint index, GLuint divisor);
+extern "C" void APIENTRY glVertexAttribFormat(GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+extern "C" void APIENTRY glVertexAttribIFormat(GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
+extern "C" void APIENTRY glVertexAttribLFormat(GLuint attribindex, GLint size, GLenum type, GLuint relativeoffset);
 extern "C" void APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer);
 extern "C" void APIENTRY glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer);
 extern "C" void APIENTRY glVertexAttribLPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void *pointer);
+extern "C" void APIENTRY glVertexBindingDivisor(GLuint bindingindex, GLuint divisor);
 extern "C" void APIENTRY glViewport(GLint x, GLint y, GLsizei width, GLsizei height);
 extern "C" void APIENTRY glViewportArrayv(GLuint first, GLsizei count, const GLfloat *v);
 extern "C" void APIENTRY glViewportIndexedf(GLuint index, GLfloat x, GLfloat y, GLfloat w, GLfloat h);
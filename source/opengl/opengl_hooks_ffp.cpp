@@ -77,11 +77,21 @@ extern "C" void APIENTRY glClearColor(GLclampf red, GLclampf green, GLclampf blu
 {
 	static const auto trampoline = reshade::hooks::call(glClearColor);
 	trampoline(red, green, blue, alpha);
+
+#if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->set_clear_color(red, green, blue, alpha);
+#endif
 }
 extern "C" void APIENTRY glClearDepth(GLclampd depth)
 {
 	static const auto trampoline = reshade::hooks::call(glClearDepth);
 	trampoline(depth);
+
+#if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->set_clear_depth(static_cast<GLfloat>(depth));
+#endif
 }
 extern "C" void APIENTRY glClearIndex(GLfloat c)
 {
@@ -92,6 +102,11 @@ extern "C" void APIENTRY glClearStencil(GLint s)
 {
 	static const auto trampoline = reshade::hooks::call(glClearStencil);
 	trampoline(s);
+
+#if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->set_clear_stencil(s);
+#endif
 }
 
 extern "C" void APIENTRY glClipPlane(GLenum plane, const GLdouble *equation)
@@ -1000,11 +1015,22 @@ extern "C" void APIENTRY glPopAttrib()
 {
 	static const auto trampoline = reshade::hooks::call(glPopAttrib);
 	trampoline();
+
+#if RESHADE_ADDON
+	// Restores state without going through the hooks, so have to query it from the driver again
+	if (g_opengl_context)
+		g_opengl_context->invalidate_shadow_state();
+#endif
 }
 extern "C" void APIENTRY glPopClientAttrib()
 {
 	static const auto trampoline = reshade::hooks::call(glPopClientAttrib);
 	trampoline();
+
+#if RESHADE_ADDON
+	if (g_opengl_context)
+		g_opengl_context->invalidate_shadow_state();
+#endif
 }
 
 extern "C" void APIENTRY glPopMatrix()
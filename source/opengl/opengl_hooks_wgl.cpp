@@ -863,6 +863,11 @@ extern "C" BOOL  WINAPI wglDeleteContext(HGLRC hglrc)
 		{
 			wgl_device *const device = static_cast<wgl_device *>(it->second->get_device());
 
+#if RESHADE_ADDON >= 2
+			if (it->second->_input_layout_cache_hits != 0 || it->second->_input_layout_cache_misses != 0)
+				reshade::log::message(reshade::log::level::debug, "Input layout cache of render context %p had %llu hits and %llu misses.", hglrc, it->second->_input_layout_cache_hits, it->second->_input_layout_cache_misses);
+#endif
+
 			if (it->second != device)
 			{
 				// Separate contexts are only created for shared render contexts
@@ -1411,6 +1416,10 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 	else if (0 == std::strcmp(lpszProc, "glDrawElementsInstancedARB"))
 		lpszProc = "glDrawElementsInstanced";
 	#pragma endregion
+	#pragma region GL_ARB_instanced_arrays
+	else if (0 == std::strcmp(lpszProc, "glVertexAttribDivisorARB"))
+		lpszProc = "glVertexAttribDivisor";
+	#pragma endregion
 	#pragma region GL_ARB_vertex_buffer_object
 	else if (0 == std::strcmp(lpszProc, "glIsBufferARB"))
 		lpszProc = "glIsBuffer";
@@ -1435,6 +1444,15 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 	else if (0 == std::strcmp(lpszProc, "glGetBufferPointervARB"))
 		lpszProc = "glGetBufferPointerv";
 	#pragma endregion
+	#pragma region GL_ARB_vertex_program
+	// Generic vertex attributes share their state with the core variants, so these can be redirected so that the input layout cache sees changes made through them
+	else if (0 == std::strcmp(lpszProc, "glVertexAttribPointerARB"))
+		lpszProc = "glVertexAttribPointer";
+	else if (0 == std::strcmp(lpszProc, "glEnableVertexAttribArrayARB"))
+		lpszProc = "glEnableVertexAttribArray";
+	else if (0 == std::strcmp(lpszProc, "glDisableVertexAttribArrayARB"))
+		lpszProc = "glDisableVertexAttribArray";
+	#pragma endregion
 	#pragma region GL_EXT_draw_instanced
 	else if (0 == std::strcmp(lpszProc, "glDrawArraysInstancedEXT"))
 		lpszProc = "glDrawArraysInstanced";
@@ -1475,6 +1493,10 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 	else if (0 == std::strcmp(lpszProc, "glGenerateMipmapEXT"))
 		lpszProc = "glGenerateMipmap";
 	#pragma endregion
+	#pragma region GL_EXT_gpu_shader4
+	else if (0 == std::strcmp(lpszProc, "glVertexAttribIPointerEXT"))
+		lpszProc = "glVertexAttribIPointer";
+	#pragma endregion
 #endif
 
 	static const auto trampoline = reshade::hooks::call(wglGetProcAddress);
@@ -1677,6 +1699,8 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		RESHADE_OPENGL_HOOK_PROC(glUniformMatrix3fv);
 		RESHADE_OPENGL_HOOK_PROC(glUniformMatrix4fv);
 		RESHADE_OPENGL_HOOK_PROC(glVertexAttribPointer);
+		RESHADE_OPENGL_HOOK_PROC(glEnableVertexAttribArray);
+		RESHADE_OPENGL_HOOK_PROC(glDisableVertexAttribArray);
 #endif
 #ifdef GL_VERSION_2_1
 		RESHADE_OPENGL_HOOK_PROC(glUniformMatrix2x3fv);
@@ -1688,6 +1712,7 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 #endif
 #ifdef GL_VERSION_3_0
 		RESHADE_OPENGL_HOOK_PROC(glMapBufferRange);
+		RESHADE_OPENGL_HOOK_PROC(glDeleteFramebuffers);
 		RESHADE_OPENGL_HOOK_PROC(glDeleteRenderbuffers);
 		RESHADE_OPENGL_HOOK_PROC(glFramebufferTexture1D);
 		RESHADE_OPENGL_HOOK_PROC(glFramebufferTexture2D);
@@ -1732,11 +1757,15 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		RESHADE_OPENGL_HOOK_PROC(glDrawElementsInstancedBaseVertex);
 		RESHADE_OPENGL_HOOK_PROC(glMultiDrawElementsBaseVertex);
 #endif
+#ifdef GL_VERSION_3_3
+		RESHADE_OPENGL_HOOK_PROC(glVertexAttribDivisor);
+#endif
 #ifdef GL_VERSION_4_0
 		RESHADE_OPENGL_HOOK_PROC(glDrawArraysIndirect);
 		RESHADE_OPENGL_HOOK_PROC(glDrawElementsIndirect);
 #endif
 #ifdef GL_VERSION_4_1
+		RESHADE_OPENGL_HOOK_PROC(glClearDepthf);
 		RESHADE_OPENGL_HOOK_PROC(glScissorArrayv);
 		RESHADE_OPENGL_HOOK_PROC(glScissorIndexed);
 		RESHADE_OPENGL_HOOK_PROC(glScissorIndexedv);
@@ -1761,6 +1790,11 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		RESHADE_OPENGL_HOOK_PROC(glTexStorage3DMultisample);
 		RESHADE_OPENGL_HOOK_PROC(glCopyImageSubData);
 		RESHADE_OPENGL_HOOK_PROC(glBindVertexBuffer);
+		RESHADE_OPENGL_HOOK_PROC(glVertexAttribFormat);
+		RESHADE_OPENGL_HOOK_PROC(glVertexAttribIFormat);
+		RESHADE_OPENGL_HOOK_PROC(glVertexAttribLFormat);
+		RESHADE_OPENGL_HOOK_PROC(glVertexAttribBinding);
+		RESHADE_OPENGL_HOOK_PROC(glVertexBindingDivisor);
 		RESHADE_OPENGL_HOOK_PROC(glDispatchCompute);
 		RESHADE_OPENGL_HOOK_PROC(glDispatchComputeIndirect);
 		RESHADE_OPENGL_HOOK_PROC(glMultiDrawArraysIndirect);
@@ -1807,6 +1841,14 @@ extern "C" PROC  WINAPI wglGetProcAddress(LPCSTR lpszProc)
 		RESHADE_OPENGL_HOOK_PROC(glBlitNamedFramebuffer);
 		RESHADE_OPENGL_HOOK_PROC(glGenerateTextureMipmap);
 		RESHADE_OPENGL_HOOK_PROC(glBindTextureUnit);
+		RESHADE_OPENGL_HOOK_PROC(glEnableVertexArrayAttrib);
+		RESHADE_OPENGL_HOOK_PROC(glDisableVertexArrayAttrib);
+		RESHADE_OPENGL_HOOK_PROC(glVertexArrayAttribFormat);
+		RESHADE_OPENGL_HOOK_PROC(glVertexArrayAttribIFormat);
+		RESHADE_OPENGL_HOOK_PROC(glVertexArrayAttribLFormat);
+		RESHADE_OPENGL_HOOK_PROC(glVertexArrayAttribBinding);
+		RESHADE_OPENGL_HOOK_PROC(glVertexArrayBindingDivisor);
+		RESHADE_OPENGL_HOOK_PROC(glVertexArrayElementBuffer);
 #endif
 
 		// GL_ARB_vertex_program / GL_ARB_fragment_program
@@ -7,7 +7,7 @@
 #include "opengl_impl_device_context.hpp"
 #include "opengl_impl_type_convert.hpp"
 #include <cstring> // std::memcpy
-#include <algorithm> // std::copy_n, std::max
+#include <algorithm> // std::copy_n, std::max, std::min_element
 
 #define gl _device_impl->_dispatch_table
 
@@ -137,11 +137,132 @@ void reshade::opengl::device_context_impl::bind_render_targets_and_depth_stencil
 	glEnableOrDisable(GL_FRAMEBUFFER_SRGB, has_srgb_attachment);
 }
 
+void reshade::opengl::device_context_impl::flush_fbo_lookup_invalidations()
+{
+	if (_device_impl->_fbo_lookup_version.load(std::memory_order_acquire) == _last_fbo_lookup_version)
+		return;
+
+	const std::unique_lock<std::mutex> lock(_device_impl->_lookup_invalidation_mutex);
+
+	const uint64_t current_lookup_version = _device_impl->_fbo_lookup_version.load(std::memory_order_relaxed);
+	if (current_lookup_version - _last_fbo_lookup_version > device_impl::lookup_invalidation_count)
+	{
+		// Too many objects were destroyed since the last lookup to know which framebuffers reference them, so have to destroy all of them
+		for (const auto &fbo_data : _fbo_lookup)
+			gl.DeleteFramebuffers(1, &fbo_data.second.fbo);
+		_fbo_lookup.clear();
+		_fbo_lookup_attachments.clear();
+
+		invalidate_binding(GL_FRAMEBUFFER);
+	}
+	else
+	{
+		for (uint64_t version = _last_fbo_lookup_version; version != current_lookup_version; ++version)
+		{
+			const uint64_t attachment_key = _device_impl->_fbo_lookup_invalidations[version % device_impl::lookup_invalidation_count];
+
+			// Erasing a framebuffer also removes it from the attachment index, so look up the next one again every iteration
+			for (auto it = _fbo_lookup_attachments.find(attachment_key); it != _fbo_lookup_attachments.end(); it = _fbo_lookup_attachments.find(attachment_key))
+				erase_fbo_lookup(it->second);
+		}
+	}
+
+	_last_fbo_lookup_version = current_lookup_version;
+}
+void reshade::opengl::device_context_impl::flush_vao_lookup_invalidations()
+{
+	if (_device_impl->_vao_lookup_version.load(std::memory_order_acquire) == _last_vao_lookup_version)
+		return;
+
+	const std::unique_lock<std::mutex> lock(_device_impl->_lookup_invalidation_mutex);
+
+	const uint64_t current_lookup_version = _device_impl->_vao_lookup_version.load(std::memory_order_relaxed);
+	if (current_lookup_version - _last_vao_lookup_version > device_impl::lookup_invalidation_count)
+	{
+		for (const auto &vao_data : _vao_lookup)
+			gl.DeleteVertexArrays(1, &vao_data.second);
+		_vao_lookup.clear();
+	}
+	else
+	{
+		for (uint64_t version = _last_vao_lookup_version; version != current_lookup_version; ++version)
+		{
+			if (const auto it = _vao_lookup.find(static_cast<size_t>(_device_impl->_vao_lookup_invalidations[version % device_impl::lookup_invalidation_count]));
+				it != _vao_lookup.end())
+			{
+				gl.DeleteVertexArrays(1, &it->second);
+				_vao_lookup.erase(it);
+			}
+		}
+	}
+
+	_last_vao_lookup_version = current_lookup_version;
+}
+
+GLuint reshade::opengl::device_context_impl::find_fbo_lookup(size_t hash)
+{
+	flush_fbo_lookup_invalidations();
+
+	if (const auto it = _fbo_lookup.find(hash);
+		it != _fbo_lookup.end())
+	{
+		it->second.last_used = ++_fbo_lookup_tick;
+		return it->second.fbo;
+	}
+
+	return 0;
+}
+void reshade::opengl::device_context_impl::insert_fbo_lookup(size_t hash, GLuint fbo, uint32_t attachment_count, const uint64_t *attachment_keys)
+{
+	// Bound the number of cached framebuffers by evicting the least recently used one
+	if (_fbo_lookup.size() >= max_fbo_lookup_count)
+	{
+		const auto lru_it = std::min_element(_fbo_lookup.begin(), _fbo_lookup.end(),
+			[](const std::pair<const size_t, fbo_data> &lhs, const std::pair<const size_t, fbo_data> &rhs) {
+				return lhs.second.last_used < rhs.second.last_used;
+			});
+		erase_fbo_lookup(lru_it->first);
+	}
+
+	fbo_data &data = _fbo_lookup[hash];
+	data.fbo = fbo;
+	data.last_used = ++_fbo_lookup_tick;
+	data.attachment_keys.assign(attachment_keys, attachment_keys + attachment_count);
+
+	for (uint32_t i = 0; i < attachment_count; ++i)
+		_fbo_lookup_attachments.emplace(attachment_keys[i], hash);
+}
+void reshade::opengl::device_context_impl::erase_fbo_lookup(size_t hash)
+{
+	const auto it = _fbo_lookup.find(hash);
+	if (it == _fbo_lookup.end())
+		return;
+
+	for (const uint64_t attachment_key : it->second.attachment_keys)
+	{
+		for (auto range = _fbo_lookup_attachments.equal_range(attachment_key); range.first != range.second;)
+		{
+			if (range.first->second == hash)
+				range.first = _fbo_lookup_attachments.erase(range.first);
+			else
+				++range.first;
+		}
+	}
+
+	// Deleting a framebuffer that is currently bound reverts that binding to the default framebuffer
+	gl.DeleteFramebuffers(1, &it->second.fbo);
+	invalidate_binding(GL_FRAMEBUFFER);
+
+	_fbo_lookup.erase(it);
+}
+
 void reshade::opengl::device_context_impl::bind_framebuffer_with_resource(GLenum target, GLenum attachment, api::resource dst, uint32_t dst_subresource, const api::resource_desc &dst_desc)
 {
 	const GLenum dst_target = dst.handle >> 40;
 	const GLuint dst_object = dst.handle & 0xFFFFFFFF;
 
+	invalidate_binding(target);
+
 	if (dst_target == GL_FRAMEBUFFER_DEFAULT)
 	{
 		gl.BindFramebuffer(target, 0);
@@ -156,24 +277,16 @@ void reshade::opengl::device_context_impl::bind_framebuffer_with_resource(GLenum
 	hash_combine(hash, dst_desc.texture.height);
 	hash_combine(hash, static_cast<uint32_t>(dst_desc.texture.format));
 
-	if (const uint64_t current_lookup_version = _device_impl->_fbo_lookup_version;
-		current_lookup_version != _last_fbo_lookup_version)
+	if (const GLuint fbo = find_fbo_lookup(hash))
 	{
-		for (const auto &fbo_data : _fbo_lookup)
-			gl.DeleteFramebuffers(1, &fbo_data.second);
-		_fbo_lookup.clear();
-		_last_fbo_lookup_version = current_lookup_version;
-	}
-	else if (const auto it = _fbo_lookup.find(hash);
-		it != _fbo_lookup.end())
-	{
-		gl.BindFramebuffer(target, it->second);
+		gl.BindFramebuffer(target, fbo);
 		return;
 	}
 
 	GLuint fbo = 0;
 	gl.GenFramebuffers(1, &fbo);
-	_fbo_lookup.emplace(hash, fbo);
+	const uint64_t attachment_key = make_framebuffer_attachment_key(dst.handle);
+	insert_fbo_lookup(hash, fbo, 1, &attachment_key);
 
 	gl.BindFramebuffer(target, fbo);
 
@@ -204,6 +317,8 @@ void reshade::opengl::device_context_impl::bind_framebuffer_with_resource(GLenum
 }
 void reshade::opengl::device_context_impl::bind_framebuffer_with_resource_views(GLenum target, uint32_t count, const api::resource_view *rtvs, api::resource_view dsv)
 {
+	invalidate_binding(target);
+
 	if ((count == 1 && (rtvs[0].handle >> 40) == GL_FRAMEBUFFER_DEFAULT) ||
 		(count == 0 && (dsv == 0 || (dsv.handle >> 40) == GL_FRAMEBUFFER_DEFAULT)))
 	{
@@ -219,18 +334,9 @@ void reshade::opengl::device_context_impl::bind_framebuffer_with_resource_views(
 		hash_combine(hash, rtvs[i].handle);
 	hash_combine(hash, dsv.handle);
 
-	if (const uint64_t current_lookup_version = _device_impl->_fbo_lookup_version;
-		current_lookup_version != _last_fbo_lookup_version)
-	{
-		for (const auto &fbo_data : _fbo_lookup)
-			gl.DeleteFramebuffers(1, &fbo_data.second);
-		_fbo_lookup.clear();
-		_last_fbo_lookup_version = current_lookup_version;
-	}
-	else if (const auto it = _fbo_lookup.find(hash);
-		it != _fbo_lookup.end())
+	if (const GLuint fbo = find_fbo_lookup(hash))
 	{
-		gl.BindFramebuffer(target, it->second);
+		gl.BindFramebuffer(target, fbo);
 		update_current_window_height(count != 0 ? rtvs[0] : dsv);
 		return;
 	}
@@ -296,7 +402,15 @@ void reshade::opengl::device_context_impl::bind_framebuffer_with_resource_views(
 
 	assert(gl.CheckFramebufferStatus(target) == GL_FRAMEBUFFER_COMPLETE);
 
-	_fbo_lookup.emplace(hash, fbo);
+	temp_mem<uint64_t, 9> attachment_keys(count + 1);
+	uint32_t attachment_count = 0;
+	for (uint32_t i = 0; i < count; ++i)
+		if (rtvs[i].handle != 0)
+			attachment_keys[attachment_count++] = make_framebuffer_attachment_key(rtvs[i].handle);
+	if (dsv != 0)
+		attachment_keys[attachment_count++] = make_framebuffer_attachment_key(dsv.handle);
+
+	insert_fbo_lookup(hash, fbo, attachment_count, attachment_keys.p);
 
 	update_current_window_height(count != 0 ? rtvs[0] : dsv);
 }
@@ -392,7 +506,10 @@ void reshade::opengl::device_context_impl::bind_pipeline(api::pipeline_stage sta
 		if ((stages & api::pipeline_stage::all_shader_stages) != 0)
 			gl.UseProgram(0);
 		if ((stages & api::pipeline_stage::input_assembler) != 0)
+		{
 			gl.BindVertexArray(0);
+			set_binding(GL_VERTEX_ARRAY, 0);
+		}
 		return;
 	}
 
@@ -407,6 +524,7 @@ void reshade::opengl::device_context_impl::bind_pipeline(api::pipeline_stage sta
 	{
 		assert((stages & ~api::pipeline_stage::input_assembler) == 0);
 		gl.BindVertexArray(pipeline.handle & 0xFFFFFFFF);
+		set_binding(GL_VERTEX_ARRAY, pipeline.handle & 0xFFFFFFFF);
 		_current_vao_dirty = false;
 		return;
 	}
@@ -523,15 +641,11 @@ void reshade::opengl::device_context_impl::bind_pipeline(api::pipeline_stage sta
 
 		_current_vao_dirty = false;
 
-		if (const uint64_t current_lookup_version = _device_impl->_vao_lookup_version;
-			current_lookup_version != _last_vao_lookup_version)
-		{
-			for (const auto &vao_data : _vao_lookup)
-				gl.DeleteVertexArrays(1, &vao_data.second);
-			_vao_lookup.clear();
-			_last_vao_lookup_version = current_lookup_version;
-		}
-		else if (const auto it = _vao_lookup.find(static_cast<size_t>(pipeline.handle));
+		invalidate_binding(GL_VERTEX_ARRAY);
+
+		flush_vao_lookup_invalidations();
+
+		if (const auto it = _vao_lookup.find(static_cast<size_t>(pipeline.handle));
 			it != _vao_lookup.end())
 		{
 			gl.BindVertexArray(it->second);
@@ -1215,6 +1329,7 @@ void reshade::opengl::device_context_impl::bind_index_buffer(api::resource buffe
 	assert(offset == 0);
 
 	gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.handle & 0xFFFFFFFF);
+	set_binding(GL_ELEMENT_ARRAY_BUFFER, buffer.handle & 0xFFFFFFFF);
 
 	switch (index_size)
 	{
@@ -1294,14 +1409,17 @@ void reshade::opengl::device_context_impl::draw_or_dispatch_indirect(api::indire
 	{
 	case api::indirect_command::draw:
 		gl.BindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer.handle & 0xFFFFFFFF);
+		set_binding(GL_DRAW_INDIRECT_BUFFER, buffer.handle & 0xFFFFFFFF);
 		gl.MultiDrawArraysIndirect(_current_prim_mode, reinterpret_cast<const void *>(static_cast<uintptr_t>(offset)), static_cast<GLsizei>(draw_count), static_cast<GLsizei>(stride));
 		break;
 	case api::indirect_command::draw_indexed:
 		gl.BindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer.handle & 0xFFFFFFFF);
+		set_binding(GL_DRAW_INDIRECT_BUFFER, buffer.handle & 0xFFFFFFFF);
 		gl.MultiDrawElementsIndirect(_current_prim_mode, _current_index_type, reinterpret_cast<const void *>(static_cast<uintptr_t>(offset)), static_cast<GLsizei>(draw_count), static_cast<GLsizei>(stride));
 		break;
 	case api::indirect_command::dispatch:
 		gl.BindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buffer.handle & 0xFFFFFFFF);
+		set_binding(GL_DISPATCH_INDIRECT_BUFFER, buffer.handle & 0xFFFFFFFF);
 		for (GLuint i = 0; i < draw_count; ++i)
 		{
 			assert(offset <= static_cast<uint64_t>(std::numeric_limits<GLintptr>::max()));
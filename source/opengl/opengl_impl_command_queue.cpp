@@ -6,6 +6,7 @@
 #include "opengl_impl_device.hpp"
 #include "opengl_impl_device_context.hpp"
 #include "opengl_impl_type_convert.hpp"
+#include <algorithm> // std::copy_n, std::min, std::max
 
 #define gl _device_impl->_dispatch_table
 
@@ -15,6 +16,9 @@ reshade::opengl::device_context_impl::device_context_impl(device_impl *device, H
 	_default_fbo_width(device->_default_fbo_desc.texture.width),
 	_default_fbo_height(device->_default_fbo_desc.texture.height)
 {
+	gl.GetIntegerv(GL_MAX_VERTEX_ATTRIBS, &_max_vertex_attribs);
+	gl.GetIntegerv(GL_MAX_VERTEX_ATTRIB_BINDINGS, &_max_vertex_attrib_bindings);
+
 #ifndef NDEBUG
 	const auto debug_message_callback = [](unsigned int /* source */, unsigned int type, unsigned int /* id */, unsigned int /* severity */, int /* length */, const char *message, const void * /* userParam */) {
 		if (type == GL_DEBUG_TYPE_ERROR || type == GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR)
@@ -30,7 +34,7 @@ reshade::opengl::device_context_impl::~device_context_impl()
 {
 	// Destroy framebuffers
 	for (const auto &fbo_data : _fbo_lookup)
-		gl.DeleteFramebuffers(1, &fbo_data.second);
+		gl.DeleteFramebuffers(1, &fbo_data.second.fbo);
 
 	// Destroy vertex array objects
 	for (const auto &vao_data : _vao_lookup)
@@ -45,6 +49,81 @@ reshade::api::device *reshade::opengl::device_context_impl::get_device()
 	return _device_impl;
 }
 
+GLuint reshade::opengl::device_context_impl::query_binding(GLenum target, uint32_t index)
+{
+	GLenum pname = GL_NONE;
+	switch (target)
+	{
+	case GL_VERTEX_ARRAY:
+		pname = GL_VERTEX_ARRAY_BINDING;
+		break;
+	default:
+		pname = get_binding_for_target(target);
+		break;
+	}
+
+	GLint object = 0;
+	gl.GetIntegerv(pname, &object);
+
+	if (index < shadow_binding_count)
+	{
+		_shadow_bindings[index] = object;
+		_shadow_valid |= (1u << index);
+	}
+
+	return object;
+}
+
+void reshade::opengl::device_context_impl::get_clear_color(GLfloat color[4])
+{
+	if ((_shadow_valid & shadow_clear_color_bit) == 0)
+	{
+		gl.GetFloatv(GL_COLOR_CLEAR_VALUE, _shadow_clear_color);
+		_shadow_valid |= shadow_clear_color_bit;
+	}
+
+	std::copy_n(_shadow_clear_color, 4, color);
+}
+void reshade::opengl::device_context_impl::set_clear_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	_shadow_clear_color[0] = red;
+	_shadow_clear_color[1] = green;
+	_shadow_clear_color[2] = blue;
+	_shadow_clear_color[3] = alpha;
+	_shadow_valid |= shadow_clear_color_bit;
+}
+GLfloat reshade::opengl::device_context_impl::get_clear_depth()
+{
+	if ((_shadow_valid & shadow_clear_depth_bit) == 0)
+	{
+		gl.GetFloatv(GL_DEPTH_CLEAR_VALUE, &_shadow_clear_depth);
+		_shadow_valid |= shadow_clear_depth_bit;
+	}
+
+	return _shadow_clear_depth;
+}
+void reshade::opengl::device_context_impl::set_clear_depth(GLfloat depth)
+{
+	// Depth clear value is always clamped to [0, 1]
+	_shadow_clear_depth = std::min(std::max(depth, 0.0f), 1.0f);
+	_shadow_valid |= shadow_clear_depth_bit;
+}
+GLint reshade::opengl::device_context_impl::get_clear_stencil()
+{
+	if ((_shadow_valid & shadow_clear_stencil_bit) == 0)
+	{
+		gl.GetIntegerv(GL_STENCIL_CLEAR_VALUE, &_shadow_clear_stencil);
+		_shadow_valid |= shadow_clear_stencil_bit;
+	}
+
+	return _shadow_clear_stencil;
+}
+void reshade::opengl::device_context_impl::set_clear_stencil(GLint stencil)
+{
+	_shadow_clear_stencil = stencil;
+	_shadow_valid |= shadow_clear_stencil_bit;
+}
+
 void reshade::opengl::device_context_impl::flush_immediate_command_list() const
 {
 	gl.Flush();
@@ -841,9 +841,11 @@ void reshade::opengl::device_impl::destroy_resource(api::resource resource)
 	case GL_TEXTURE_CUBE_MAP_ARRAY:
 	case GL_TEXTURE_RECTANGLE:
 		gl.DeleteTextures(1, &object);
+		invalidate_fbo_lookup(make_framebuffer_attachment_key(resource.handle));
 		break;
 	case GL_RENDERBUFFER:
 		gl.DeleteRenderbuffers(1, &object);
+		invalidate_fbo_lookup(make_framebuffer_attachment_key(resource.handle));
 		break;
 	case GL_FRAMEBUFFER_DEFAULT:
 		assert(false); // It is not allowed to destroy the default frame buffer
@@ -1191,11 +1193,31 @@ void reshade::opengl::device_impl::destroy_resource_view(api::resource_view view
 {
 	// Check if this is a standalone object (see 'make_resource_view_handle')
 	if (((view.handle >> 32) & 0x1) != 0)
+	{
 		destroy_resource({ view.handle });
+		return;
+	}
 
-	// Force all framebuffers to be destroyed, to ensure they are recreated even if a resource view handle is reused
+	// Force all framebuffers referencing this view to be destroyed, to ensure they are recreated even if a resource view handle is reused
 	// This is necessary since framebuffers include dimension information, so 'glBlitFramebuffer' etc. will clip the image if an outdated one is used
-	_fbo_lookup_version++;
+	invalidate_fbo_lookup(make_framebuffer_attachment_key(view.handle));
+}
+
+void reshade::opengl::device_impl::invalidate_fbo_lookup(uint64_t attachment_key)
+{
+	const std::unique_lock<std::mutex> lock(_lookup_invalidation_mutex);
+
+	const uint64_t version = _fbo_lookup_version.load(std::memory_order_relaxed);
+	_fbo_lookup_invalidations[version % lookup_invalidation_count] = attachment_key;
+	_fbo_lookup_version.store(version + 1, std::memory_order_release);
+}
+void reshade::opengl::device_impl::invalidate_vao_lookup(uint64_t pipeline_handle)
+{
+	const std::unique_lock<std::mutex> lock(_lookup_invalidation_mutex);
+
+	const uint64_t version = _vao_lookup_version.load(std::memory_order_relaxed);
+	_vao_lookup_invalidations[version % lookup_invalidation_count] = pipeline_handle;
+	_vao_lookup_version.store(version + 1, std::memory_order_release);
 }
 
 reshade::api::format reshade::opengl::device_impl::get_resource_format(GLenum target, GLenum object) const
@@ -2226,8 +2248,8 @@ void reshade::opengl::device_impl::destroy_pipeline(api::pipeline pipeline)
 	gl.DeleteProgram(impl->program);
 
 	if (!impl->input_elements.empty())
-		// Force all vertex array objects to be destroyed, to ensure they are recreated with the right vertex attributes when the object name is reused
-		_vao_lookup_version++;
+		// Force vertex array objects created for this pipeline to be destroyed, to ensure they are recreated with the right vertex attributes when the handle is reused
+		invalidate_vao_lookup(pipeline.handle);
 
 	delete impl;
 }
@@ -7,6 +7,7 @@
 
 #include <glad/wgl.h>
 #include "reshade_api_object_impl.hpp"
+#include <mutex>
 #include <atomic>
 #include <unordered_map>
 
@@ -116,7 +117,17 @@ namespace reshade::opengl
 		};
 		std::unordered_map<size_t, map_info> _map_lookup;
 
+		// Objects that were destroyed are recorded here, so that render contexts can evict the framebuffer and vertex array objects referencing them from their caches
+		// When a render context falls behind by more than the size of these ring buffers, it has to clear its cache entirely
+		void invalidate_fbo_lookup(uint64_t attachment_key);
+		void invalidate_vao_lookup(uint64_t pipeline_handle);
+
+		static constexpr uint64_t lookup_invalidation_count = 256;
+
+		std::mutex _lookup_invalidation_mutex;
 		std::atomic<uint64_t> _fbo_lookup_version = 0;
+		uint64_t _fbo_lookup_invalidations[lookup_invalidation_count] = {};
 		std::atomic<uint64_t> _vao_lookup_version = 0;
+		uint64_t _vao_lookup_invalidations[lookup_invalidation_count] = {};
 	};
 }
@@ -7,6 +7,7 @@
 
 #include <glad/wgl.h>
 #include "reshade_api_object_impl.hpp"
+#include <vector>
 #include <unordered_map>
 
 namespace reshade::opengl
@@ -99,6 +100,16 @@ namespace reshade::opengl
 		bool _current_ibo_dirty = true;
 		bool _current_vbo_dirty = true;
 
+		// Input layouts of the vertex array objects that were reported to add-ons, so that they only have to be queried and reported again after they were changed
+		struct input_layout
+		{
+			std::vector<api::input_element> elements;
+			bool dirty = false;
+		};
+		std::unordered_map<GLuint, input_layout> _input_layout_cache;
+		uint64_t _input_layout_cache_hits = 0;
+		uint64_t _input_layout_cache_misses = 0;
+
 		GLenum _current_prim_mode = GL_NONE;
 		GLenum _current_index_type = GL_UNSIGNED_INT;
 		GLuint _current_vertex_count = 0; // Used to calculate vertex count inside 'glBegin'/'glEnd' pairs
@@ -108,15 +119,128 @@ namespace reshade::opengl
 		unsigned int _default_fbo_width = 0;
 		unsigned int _default_fbo_height = 0;
 
+		// Implementation limits, which do not change over the lifetime of the render context
+		GLint _max_vertex_attribs = 0;
+		GLint _max_vertex_attrib_bindings = 0;
+
+		// The hooks keep a shadow copy of some frequently needed state, so that it does not have to be queried from the driver (which may stall) on every call
+		// Each entry is only used while it is valid, after state was changed in a way the hooks cannot follow it is queried from the driver again once
+		GLuint get_binding(GLenum target)
+		{
+			const uint32_t index = shadow_binding_index(target);
+			if (index < shadow_binding_count && (_shadow_valid & (1u << index)) != 0)
+				return _shadow_bindings[index];
+			return query_binding(target, index);
+		}
+		void set_binding(GLenum target, GLuint object)
+		{
+			if (target == GL_FRAMEBUFFER)
+			{
+				set_binding(GL_DRAW_FRAMEBUFFER, object);
+				set_binding(GL_READ_FRAMEBUFFER, object);
+				return;
+			}
+
+			const uint32_t index = shadow_binding_index(target);
+			if (index >= shadow_binding_count)
+				return;
+
+			_shadow_bindings[index] = object;
+			_shadow_valid |= (1u << index);
+
+			// The element array buffer binding is part of the vertex array object state
+			if (target == GL_VERTEX_ARRAY)
+				invalidate_binding(GL_ELEMENT_ARRAY_BUFFER);
+		}
+		void invalidate_binding(GLenum target)
+		{
+			if (target == GL_FRAMEBUFFER)
+			{
+				invalidate_binding(GL_DRAW_FRAMEBUFFER);
+				invalidate_binding(GL_READ_FRAMEBUFFER);
+				return;
+			}
+
+			const uint32_t index = shadow_binding_index(target);
+			if (index < shadow_binding_count)
+				_shadow_valid &= ~(1u << index);
+
+			if (target == GL_VERTEX_ARRAY)
+				invalidate_binding(GL_ELEMENT_ARRAY_BUFFER);
+		}
+
+		void get_clear_color(GLfloat color[4]);
+		void set_clear_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+		GLfloat get_clear_depth();
+		void set_clear_depth(GLfloat depth);
+		GLint get_clear_stencil();
+		void set_clear_stencil(GLint stencil);
+
+		void invalidate_shadow_state() { _shadow_valid = 0; }
+
 	private:
+		static constexpr uint32_t shadow_binding_index(GLenum target)
+		{
+			switch (target)
+			{
+			case GL_VERTEX_ARRAY:
+				return 0;
+			case GL_ELEMENT_ARRAY_BUFFER:
+				return 1;
+			case GL_DRAW_INDIRECT_BUFFER:
+				return 2;
+			case GL_DISPATCH_INDIRECT_BUFFER:
+				return 3;
+			case GL_PIXEL_UNPACK_BUFFER:
+				return 4;
+			case GL_DRAW_FRAMEBUFFER:
+				return 5;
+			case GL_READ_FRAMEBUFFER:
+				return 6;
+			default:
+				return shadow_binding_count;
+			}
+		}
+
+		GLuint query_binding(GLenum target, uint32_t index);
+
+		void flush_fbo_lookup_invalidations();
+		void flush_vao_lookup_invalidations();
+		GLuint find_fbo_lookup(size_t hash);
+		void insert_fbo_lookup(size_t hash, GLuint fbo, uint32_t attachment_count, const uint64_t *attachment_keys);
+		void erase_fbo_lookup(size_t hash);
+
 		device_impl *const _device_impl;
 
+		static constexpr uint32_t shadow_binding_count = 7;
+		static constexpr uint32_t shadow_clear_color_bit = 1u << (shadow_binding_count + 0);
+		static constexpr uint32_t shadow_clear_depth_bit = 1u << (shadow_binding_count + 1);
+		static constexpr uint32_t shadow_clear_stencil_bit = 1u << (shadow_binding_count + 2);
+
+		uint32_t _shadow_valid = 0;
+		GLuint _shadow_bindings[shadow_binding_count] = {};
+		GLfloat _shadow_clear_color[4] = {};
+		GLfloat _shadow_clear_depth = 1.0f;
+		GLint _shadow_clear_stencil = 0;
+
 		std::vector<GLuint> _push_constants;
 		std::vector<GLuint> _push_constants_size;
 
 		// Framebuffer and vertex array objects cannot be shared between render contexts, so have to create them for each one
+		// Framebuffers are additionally indexed by the textures and renderbuffers attached to them (see 'make_framebuffer_attachment_key'), so that only those referencing a destroyed object have to be recreated
+		struct fbo_data
+		{
+			GLuint fbo;
+			uint64_t last_used;
+			std::vector<uint64_t> attachment_keys;
+		};
+
+		static constexpr size_t max_fbo_lookup_count = 128;
+
 		uint64_t _last_fbo_lookup_version = 0;
-		std::unordered_map<size_t, GLuint> _fbo_lookup;
+		uint64_t _fbo_lookup_tick = 0;
+		std::unordered_map<size_t, fbo_data> _fbo_lookup;
+		std::unordered_multimap<uint64_t, size_t> _fbo_lookup_attachments;
 		uint64_t _last_vao_lookup_version = 0;
 		std::unordered_map<size_t, GLuint> _vao_lookup;
 	};
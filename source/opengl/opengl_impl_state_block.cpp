@@ -5,6 +5,7 @@
 
 #include "opengl_impl_device.hpp"
 #include "opengl_impl_state_block.hpp"
+#include <algorithm> // std::min, std::max
 
 #define gl _device_impl->_dispatch_table
 
@@ -28,14 +29,21 @@ reshade::opengl::state_block::state_block(device_impl *device) :
 {
 }
 
-void reshade::opengl::state_block::capture()
+void reshade::opengl::state_block::capture(const api::state_block_subset &subset)
 {
+	// Only capture the texture units that are going to be modified (samplers and textures are combined in OpenGL)
+	_capture_vertex_buffers = subset.vertex_buffers;
+	_num_texture_units = std::min(std::max(subset.sampler_count, subset.shader_resource_view_count), 32u);
+
 	gl.GetIntegerv(GL_COPY_READ_BUFFER_BINDING, &_copy_read);
 	gl.GetIntegerv(GL_COPY_WRITE_BUFFER_BINDING, &_copy_write);
 
 	gl.GetIntegerv(GL_VERTEX_ARRAY_BINDING, &_vao);
-	gl.GetIntegerv(GL_ARRAY_BUFFER_BINDING, &_vbo);
-	gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &_ibo);
+	if (_capture_vertex_buffers)
+	{
+		gl.GetIntegerv(GL_ARRAY_BUFFER_BINDING, &_vbo);
+		gl.GetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &_ibo);
+	}
 
 	gl.GetIntegerv(GL_CURRENT_PROGRAM, &_program);
 
@@ -55,7 +63,7 @@ void reshade::opengl::state_block::capture()
 
 	// Technically should capture image bindings here as well ...
 	gl.GetIntegerv(GL_ACTIVE_TEXTURE, &_active_texture);
-	for (GLuint i = 0; i < 32; i++)
+	for (GLuint i = 0; i < _num_texture_units; i++)
 	{
 		gl.GetIntegeri_v(GL_SAMPLER_BINDING, i, &_samplers[i]);
 		gl.GetIntegeri_v(GL_TEXTURE_BINDING_2D, i, &_textures2d[i]);
@@ -145,8 +153,11 @@ void reshade::opengl::state_block::apply() const
 	gl.BindBuffer(GL_COPY_WRITE_BUFFER, _copy_write);
 
 	gl.BindVertexArray(_vao);
-	gl.BindBuffer(GL_ARRAY_BUFFER, _vbo);
-	gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+	if (_capture_vertex_buffers)
+	{
+		gl.BindBuffer(GL_ARRAY_BUFFER, _vbo);
+		gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, _ibo);
+	}
 
 	gl.UseProgram(_program);
 
@@ -164,7 +175,7 @@ void reshade::opengl::state_block::apply() const
 	// 'glBindBufferBase' and 'glBindBufferRange' also update the general binding point, so set it after these were called
 	gl.BindBuffer(GL_UNIFORM_BUFFER, _active_ubo);
 
-	for (GLuint i = 0; i < 32; i++)
+	for (GLuint i = 0; i < _num_texture_units; i++)
 	{
 		gl.ActiveTexture(GL_TEXTURE0 + i);
 		gl.BindTexture(GL_TEXTURE_2D, _textures2d[i]);
@@ -6,6 +6,7 @@
 #pragma once
 
 #include <glad/gl.h>
+#include "state_block.hpp"
 
 namespace reshade::opengl
 {
@@ -16,12 +17,15 @@ namespace reshade::opengl
 	public:
 		explicit state_block(device_impl *device);
 
-		void capture();
+		void capture(const api::state_block_subset &subset = {});
 		void apply() const;
 
 	private:
 		device_impl *const _device_impl;
 
+		bool _capture_vertex_buffers = false;
+		GLuint _num_texture_units = 0;
+
 		GLint _copy_read = 0;
 		GLint _copy_write = 0;
 
@@ -101,6 +101,12 @@ namespace reshade::opengl
 	{
 		return { (static_cast<uint64_t>(target) << 40) | (static_cast<uint64_t>(standalone_object ? 0x1 : 0) << 32) | object };
 	}
+	constexpr auto make_framebuffer_attachment_key(uint64_t resource_or_view_handle) -> uint64_t
+	{
+		// Texture and renderbuffer names are allocated separately, but the different texture targets (and views of the same texture) share the same object
+		const GLenum target = (resource_or_view_handle >> 40) == GL_RENDERBUFFER ? GL_RENDERBUFFER : GL_TEXTURE;
+		return (static_cast<uint64_t>(target) << 40) | (resource_or_view_handle & 0xFFFFFFFF);
+	}
 
 	auto convert_format(api::format format, GLint swizzle_mask[4] = nullptr) -> GLenum;
 	auto convert_format(GLenum internal_format, const GLint swizzle_mask[4] = nullptr) -> api::format;
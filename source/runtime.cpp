@@ -8,7 +8,7 @@
 #include "effect_parser.hpp"
 #include "effect_codegen.hpp"
 #include "effect_preprocessor.hpp"
-#include "version.h"
+#include "effect_cache.hpp"
 #include "dll_log.hpp"
 #include "dll_resources.hpp"
 #include "ini_file.hpp"
@@ -20,13 +20,14 @@
 #include "reshade_api_object_impl.hpp"
 #include <set>
 #include <thread>
+#include <atomic>
 #include <cmath> // std::abs, std::fmod
 #include <cctype> // std::toupper
 #include <cwctype> // std::towlower
 #include <cstdio> // std::snprintf
 #include <cstdlib> // std::malloc, std::rand, std::strtod, std::strtol
-#include <cstring> // std::memcpy, std::memset, std::strlen
-#include <charconv> // std::to_chars
+#include <cstring> // std::memcmp, std::memcpy, std::memset, std::strlen
+#include <charconv> // std::from_chars, std::to_chars
 #include <algorithm> // std::all_of, std::copy_n, std::equal, std::fill_n, std::find, std::find_if, std::for_each, std::max, std::min, std::replace, std::remove, std::remove_if, std::reverse, std::search, std::set_symmetric_difference, std::sort, std::stable_sort, std::swap, std::transform
 #include <fpng.h>
 #include <stb_image.h>
@@ -173,6 +174,84 @@ static std::vector<std::filesystem::path> find_files(const std::vector<std::file
 	return files;
 }
 
+static void mark_uniform_data_dirty(reshade::effect &effect, size_t offset, size_t size)
+{
+	if (effect.uniform_data_dirty_begin < effect.uniform_data_dirty_end)
+	{
+		effect.uniform_data_dirty_begin = std::min(effect.uniform_data_dirty_begin, offset);
+		effect.uniform_data_dirty_end = std::max(effect.uniform_data_dirty_end, offset + size);
+	}
+	else
+	{
+		effect.uniform_data_dirty_begin = offset;
+		effect.uniform_data_dirty_end = offset + size;
+	}
+}
+
+static bool decode_special_uniform(const reshade::uniform &variable, reshade::special_uniform_update &update)
+{
+	using reshade::special_uniform;
+	using input_mode = reshade::special_uniform_update::input_mode;
+
+	update.special = variable.special;
+
+	switch (variable.special)
+	{
+		case special_uniform::frame_count:
+			update.boolean = variable.type.is_boolean();
+			break;
+		case special_uniform::random:
+			update.min_int = variable.annotation_as_int("min", 0, 0);
+			update.max_int = variable.annotation_as_int("max", 0, RAND_MAX);
+			break;
+		case special_uniform::ping_pong:
+			update.min = variable.annotation_as_float("min", 0, 0.0f);
+			update.max = variable.annotation_as_float("max", 0, 1.0f);
+			update.step[0] = variable.annotation_as_float("step", 0);
+			update.step[1] = variable.annotation_as_float("step", 1);
+			update.smoothing = variable.annotation_as_float("smoothing");
+			break;
+		case special_uniform::key:
+		case special_uniform::mouse_button:
+			update.keycode = variable.annotation_as_int("keycode");
+			if (variable.special == special_uniform::key ? (update.keycode <= 7 || update.keycode >= 256) : (update.keycode < 0 || update.keycode >= 5))
+				return false; // Nothing to update for invalid key codes
+			if (const std::string_view mode = variable.annotation_as_string("mode");
+				mode == "toggle" || variable.annotation_as_int("toggle"))
+				update.mode = input_mode::toggle;
+			else if (mode == "press")
+				update.mode = input_mode::press;
+			else
+				update.mode = input_mode::down;
+			break;
+		case special_uniform::mouse_wheel:
+			update.min = variable.annotation_as_float("min");
+			update.max = variable.annotation_as_float("max");
+			update.step[0] = variable.annotation_as_float("step");
+			if (update.step[0] == 0.0f)
+				update.step[0] = 1.0f;
+			break;
+		case special_uniform::none:
+		case special_uniform::unknown:
+			return false;
+		default:
+			break;
+	}
+
+	return true;
+}
+
+// Included files are shared between all effects (and all runtime instances), so that common headers are only read and tokenized once per reload
+static reshadefx::include_cache s_effect_include_cache;
+
+#if RESHADE_ADDON
+// Add-on event statistics are gathered process-wide, so only the first runtime that presents flushes them, to do that exactly once per frame
+static std::atomic<reshade::runtime *> s_addon_statistics_runtime = nullptr;
+#endif
+// Number of runtime instances that currently have effects loaded, strings interned while compiling effects are only released once no instance uses them anymore
+static std::mutex s_effect_string_table_mutex;
+static size_t s_effect_string_table_users = 0;
+
 reshade::runtime::runtime(api::swapchain *swapchain, api::command_queue *graphics_queue, const std::filesystem::path &config_path, bool is_vr) :
 	_swapchain(swapchain),
 	_device(swapchain->get_device()),
@@ -243,6 +322,12 @@ reshade::runtime::~runtime()
 	assert(_worker_threads.empty());
 	assert(!_is_initialized && _techniques.empty() && _technique_sorting.empty());
 
+#if RESHADE_ADDON
+	// Let the next runtime that presents take over flushing add-on event statistics
+	runtime *expected_runtime = this;
+	s_addon_statistics_runtime.compare_exchange_strong(expected_runtime, nullptr);
+#endif
+
 #if RESHADE_GUI
 	// Save configuration before shutting down to ensure the current window state is written to disk
 	save_config();
@@ -525,6 +610,9 @@ void reshade::runtime::on_reset()
 	// Already performs a wait for idle, so no need to do it again before destroying resources below
 	destroy_effects();
 
+	// Stop loader threads, these are started again the next time effects are loaded
+	_load_scheduler.stop();
+
 	_device->destroy_resource(_empty_tex);
 	_empty_tex = {};
 	_device->destroy_resource_view(_empty_srv);
@@ -583,13 +671,16 @@ void reshade::runtime::on_present()
 	if (!_is_initialized)
 		return;
 
+	const std::chrono::high_resolution_clock::time_point time_present_started = _frame_trace.is_capturing() ? std::chrono::high_resolution_clock::now() : std::chrono::high_resolution_clock::time_point();
+
 #if RESHADE_ADDON
 	_is_in_present_call = true;
 #endif
 
 	api::command_list *const cmd_list = _graphics_queue->get_immediate_command_list();
 
-	capture_state(cmd_list, _app_state);
+	// Effects created in 'update_effects' below may modify more state than the current subset describes and still render this frame, so capture everything on frames where that can happen
+	capture_state(cmd_list, _app_state, _reload_create_queue.empty() ? get_app_state_subset(true) : api::state_block_subset());
 
 	uint32_t back_buffer_index = (_back_buffer_resolved != 0 ? 2 : 0) + _swapchain->get_current_back_buffer_index() * 2;
 	const api::resource back_buffer_resource = _device->get_resource_from_view(_back_buffer_targets[back_buffer_index]);
@@ -614,8 +705,14 @@ void reshade::runtime::on_present()
 	// Lock input so it cannot be modified by other threads while we are reading it here
 	std::unique_lock<std::recursive_mutex> input_lock;
 	if (_input != nullptr)
+	{
 		input_lock = _input->lock();
 
+		// Update input status with what was received since the last frame
+		if (_primary_input_handler)
+			_input->next_frame();
+	}
+
 	update_effects();
 
 	_current_time = std::chrono::system_clock::now();
@@ -644,6 +741,12 @@ void reshade::runtime::on_present()
 	const auto current_time = std::chrono::high_resolution_clock::now();
 	_last_frame_duration = current_time - _last_present_time; _last_present_time = current_time;
 
+#if RESHADE_ADDON
+	if (runtime *expected_runtime = nullptr;
+		addon_profiling && (s_addon_statistics_runtime.compare_exchange_strong(expected_runtime, this) || expected_runtime == this))
+		flush_addon_event_statistics();
+#endif
+
 #if RESHADE_GUI
 	// Draw overlay
 	if (_is_vr)
@@ -836,8 +939,6 @@ void reshade::runtime::on_present()
 	_effects_rendered_this_frame = false;
 
 	// Update input status
-	if (_primary_input_handler && _input != nullptr)
-		_input->next_frame();
 	if (_primary_input_handler && _input_gamepad != nullptr)
 		_input_gamepad->next_frame();
 
@@ -845,6 +946,29 @@ void reshade::runtime::on_present()
 	if (!ini_file::flush_cache())
 		_preset_save_successful = false;
 
+	if (_frame_trace.is_capturing())
+	{
+		// Capture may have been started during this present, in which case there is no start time
+		if (time_present_started != std::chrono::high_resolution_clock::time_point())
+			_frame_trace.add_span("frame", "present", time_present_started, std::chrono::high_resolution_clock::now());
+
+		// Keep capturing until effects finished loading, so that a reload started during the capture is recorded completely
+		if (_frame_trace.end_frame() && !is_loading())
+		{
+			const std::time_t t = std::chrono::system_clock::to_time_t(_current_time);
+			struct tm tm; localtime_s(&tm, &t);
+
+			char filename[64];
+			std::snprintf(filename, std::size(filename), "ReShade_Trace_%.4d-%.2d-%.2d_%.2d-%.2d-%.2d.json", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+
+			const std::filesystem::path trace_path = g_reshade_base_path / std::filesystem::u8path(filename);
+			if (_frame_trace.end(trace_path))
+				log::message(log::level::info, "Saved frame trace to '%s'.", trace_path.u8string().c_str());
+			else
+				log::message(log::level::error, "Failed to save frame trace to '%s'!", trace_path.u8string().c_str());
+		}
+	}
+
 #if RESHADE_ADDON == 1
 	// Detect high network traffic
 	extern volatile long g_network_traffic;
@@ -906,7 +1030,9 @@ void reshade::runtime::load_config()
 	config_get("INPUT", "KeyReload", _reload_key_data);
 
 	config_get("GENERAL", "NoDebugInfo", _no_debug_info);
+	config_get("GENERAL", "NoEffectOptimization", _no_effect_optimization);
 	config_get("GENERAL", "NoEffectCache", _no_effect_cache);
+	config_get("GENERAL", "NoEffectCacheArchive", _no_effect_cache_archive);
 	config_get("GENERAL", "NoReloadOnInit", _no_reload_on_init);
 
 	config_get("GENERAL", "EffectSearchPaths", _effect_search_paths);
@@ -915,6 +1041,7 @@ void reshade::runtime::load_config()
 	config_get("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config_get("GENERAL", "TextureSearchPaths", _texture_search_paths);
 	config_get("GENERAL", "IntermediateCachePath", _effect_cache_path);
+	config_get("GENERAL", "IntermediateCacheSizeLimit", _effect_cache_size_limit);
 
 	config_get("GENERAL", "StartupPresetPath", _startup_preset_path);
 	config_get("GENERAL", "PresetPath", _current_preset_path);
@@ -985,7 +1112,9 @@ void reshade::runtime::save_config() const
 	config.set("INPUT", "KeyReload", _reload_key_data);
 
 	config.set("GENERAL", "NoDebugInfo", _no_debug_info);
+	config.set("GENERAL", "NoEffectOptimization", _no_effect_optimization);
 	config.set("GENERAL", "NoEffectCache", _no_effect_cache);
+	config.set("GENERAL", "NoEffectCacheArchive", _no_effect_cache_archive);
 	config.set("GENERAL", "NoReloadOnInit", _no_reload_on_init);
 
 	config.set("GENERAL", "EffectSearchPaths", _effect_search_paths);
@@ -994,6 +1123,7 @@ void reshade::runtime::save_config() const
 	config.set("GENERAL", "SkipLoadingDisabledEffects", _effect_load_skipping);
 	config.set("GENERAL", "TextureSearchPaths", _texture_search_paths);
 	config.set("GENERAL", "IntermediateCachePath", _effect_cache_path);
+	config.set("GENERAL", "IntermediateCacheSizeLimit", _effect_cache_size_limit);
 
 	config.set("GENERAL", "StartupPresetPath", make_relative_path(_startup_preset_path));
 	config.set("GENERAL", "PresetPath", make_relative_path(_current_preset_path));
@@ -1405,21 +1535,25 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 {
 	const std::chrono::high_resolution_clock::time_point time_load_started = std::chrono::high_resolution_clock::now();
 
-	// Generate a unique string identifying this effect
-	std::string attributes;
-	attributes += "app=" + g_target_executable_path.stem().u8string() + ';';
-	attributes += "width=" + std::to_string(_effect_permutations[permutation_index].width) + ';';
-	attributes += "height=" + std::to_string(_effect_permutations[permutation_index].height) + ';';
-	attributes += "color_space=" + std::to_string(static_cast<uint32_t>(_effect_permutations[permutation_index].color_space)) + ';';
-	attributes += "color_format=" + std::to_string(static_cast<uint32_t>(_effect_permutations[permutation_index].color_format)) + ';';
-	attributes += "version=" + std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION) + ';';
-	attributes += "performance_mode=" + std::string(_performance_mode ? "1" : "0") + ';';
-	attributes += "vendor=" + std::to_string(_vendor_id) + ';';
-	attributes += "device=" + std::to_string(_device_id) + ';';
-
 	const std::string effect_name = source_file.filename().u8string();
 
-	std::vector<std::pair<std::string, std::string>> preprocessor_definitions = _global_preprocessor_definitions;
+	const frame_trace::scope trace_scope(_frame_trace, "load", "load_effect", effect_name);
+
+	effect_cache_key cache_key;
+	cache_key.source_file = source_file;
+	cache_key.application = g_target_executable_path.stem().u8string();
+	cache_key.renderer_id = _renderer_id;
+	cache_key.vendor_id = _vendor_id;
+	cache_key.device_id = _device_id;
+	cache_key.performance_mode = _performance_mode;
+	cache_key.width = _effect_permutations[permutation_index].width;
+	cache_key.height = _effect_permutations[permutation_index].height;
+	cache_key.color_space = _effect_permutations[permutation_index].color_space;
+	cache_key.color_format = _effect_permutations[permutation_index].color_format;
+	cache_key.search_paths = _effect_search_paths;
+
+	std::vector<std::pair<std::string, std::string>> &preprocessor_definitions = cache_key.definitions;
+	preprocessor_definitions = _global_preprocessor_definitions;
 	// Insert preset preprocessor definitions before global ones, so that if there are duplicates, the preset ones are used (since 'add_macro_definition' succeeds only for the first occurance)
 	if (const auto preset_it = _preset_preprocessor_definitions.find({});
 		preset_it != _preset_preprocessor_definitions.end())
@@ -1447,55 +1581,29 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	}
 #endif
 
-	for (const std::pair<std::string, std::string> &definition : preprocessor_definitions)
-		attributes += definition.first + '=' + definition.second + ';';
-
-	std::error_code ec;
-	std::set<std::filesystem::path> include_paths;
-	if (source_file.is_absolute())
-		include_paths.emplace(source_file.parent_path());
-	for (std::filesystem::path include_path : _effect_search_paths)
-	{
-		const bool recursive_search = include_path.filename() == L"**";
-		if (recursive_search)
-			include_path.remove_filename();
-
-		if (resolve_path(include_path, ec))
-		{
-			include_paths.emplace(include_path);
-
-			if (recursive_search)
-			{
-				for (const std::filesystem::directory_entry &entry : std::filesystem::recursive_directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
-					if (entry.is_directory(ec))
-						include_paths.emplace(entry);
-			}
-		}
-	}
+	// Generate a unique string identifying this effect
+	const std::string attributes = cache_key.attributes();
 
-	attributes += effect_name;
-	attributes += '?';
-	attributes += std::to_string(std::filesystem::last_write_time(source_file, ec).time_since_epoch().count());
-	attributes += ';';
+	effect &effect = _effects[effect_index];
 
-	// The actual included files are not known at this point, so detect changes to any ".fxh" files in the search paths
-	for (const std::filesystem::path &include_path : include_paths)
-	{
-		for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(include_path, std::filesystem::directory_options::skip_permission_denied, ec))
-		{
-			if (entry.path().extension() == L".fxh")
-			{
-				attributes += entry.path().filename().u8string();
-				attributes += '?';
-				attributes += std::to_string(entry.last_write_time(ec).time_since_epoch().count());
-				attributes += ';';
-			}
-		}
-	}
+	// The actual included files are not known before preprocessing, so check the files that were included the last time this effect was preprocessed instead
+	const std::string dependencies_cache_id = cache_key.cache_id(reshadefx::hash_data(attributes));
+	std::string dependencies;
+	std::string dependencies_key;
+	std::vector<std::filesystem::path> dependency_files;
+	if (permutation_index == 0 && source_file == effect.source_file && !effect.dependencies.empty())
+		dependencies = effect.dependencies;
+	else
+		load_effect_cache(dependencies_cache_id, "deps", dependencies);
 
-	effect &effect = _effects[effect_index];
+	const std::string previous_dependencies = dependencies;
+	const bool dependencies_valid = check_effect_dependencies(dependencies, g_reshade_base_path, dependencies_key, dependency_files);
+	if (!dependencies_valid)
+		dependencies_key.clear();
+	else if (dependencies != previous_dependencies)
+		save_effect_cache(dependencies_cache_id, "deps", dependencies); // Update file sizes and last write times of files that were touched without changing their contents
 
-	const size_t source_hash = std::hash<std::string>()(attributes);
+	uint64_t source_hash = reshadefx::hash_data(dependencies_key, reshadefx::hash_data(attributes));
 	if (permutation_index == 0 && (source_file != effect.source_file || source_hash != effect.source_hash))
 	{
 		if (effect.created)
@@ -1516,6 +1624,9 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		effect.permutations.resize(1);
 	}
 
+	if (permutation_index == 0 && dependencies_valid)
+		effect.dependencies = dependencies;
+
 	if (_effect_load_skipping && !force_load)
 	{
 		if (std::vector<std::string> techniques;
@@ -1543,98 +1654,50 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 	bool compiled = effect.compiled && permutation_index == 0;
 	bool source_cached = false;
 	bool skip_optimization = false;
+	// Whether any part of the effect was compiled instead of loaded from the cache, only then is the load time representative of its cost
+	bool cache_miss = false;
 	std::string code_preamble;
 	std::string source;
 	std::string errors;
 
-	if (!preprocessed && (preprocess_required || (source_cached = load_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source)) == false))
+	if (!preprocessed && (preprocess_required || !dependencies_valid || (source_cached = load_effect_cache(cache_key.cache_id(source_hash), "i", source)) == false))
 	{
-		reshadefx::preprocessor pp;
-		pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
-		pp.add_macro_definition("__RESHADE_PERMUTATION__", permutation_index != 0 ? "1" : "0");
-		pp.add_macro_definition("__RESHADE_PERFORMANCE_MODE__", _performance_mode ? "1" : "0");
-		pp.add_macro_definition("__VENDOR__", std::to_string(_vendor_id));
-		pp.add_macro_definition("__DEVICE__", std::to_string(_device_id));
-		pp.add_macro_definition("__RENDERER__", std::to_string(_renderer_id));
-		pp.add_macro_definition("__APPLICATION__", std::to_string( // Truncate hash to 32-bit, since lexer currently only supports 32-bit numbers anyway
-			std::hash<std::string>()(g_target_executable_path.stem().u8string()) & 0xFFFFFFFF));
-		pp.add_macro_definition("BUFFER_WIDTH", std::to_string(_effect_permutations[permutation_index].width));
-		pp.add_macro_definition("BUFFER_HEIGHT", std::to_string(_effect_permutations[permutation_index].height));
-		pp.add_macro_definition("BUFFER_RCP_WIDTH", "(1.0 / BUFFER_WIDTH)");
-		pp.add_macro_definition("BUFFER_RCP_HEIGHT", "(1.0 / BUFFER_HEIGHT)");
-		pp.add_macro_definition("BUFFER_COLOR_SPACE", std::to_string(static_cast<uint32_t>(_effect_permutations[permutation_index].color_space)));
-		pp.add_macro_definition("BUFFER_COLOR_FORMAT", std::to_string(static_cast<uint32_t>(_effect_permutations[permutation_index].color_format)));
-		pp.add_macro_definition("BUFFER_COLOR_BIT_DEPTH", std::to_string(api::format_bit_depth(_effect_permutations[permutation_index].color_format)));
-
-		for (const std::pair<std::string, std::string> &definition : preprocessor_definitions)
-		{
-			if (definition.first.empty())
-				continue; // Skip invalid definitions
+		const frame_trace::scope preprocess_trace_scope(_frame_trace, "load", "preprocess", effect_name);
 
-			pp.add_macro_definition(definition.first, definition.second.empty() ? "1" : definition.second);
-		}
+		reshadefx::preprocessor pp(s_effect_include_cache);
+		cache_key.setup_preprocessor(pp, permutation_index != 0, cache_key.resolve_include_paths(g_reshade_base_path));
 		preprocessor_definitions.clear(); // Clear before reusing for used preprocessor definitions below
 
-		for (const std::filesystem::path &include_path : include_paths)
-			pp.add_include_path(include_path);
-
-		// Add some conversion macros for compatibility with older versions of ReShade
-		pp.append_string(
-			"#define tex2Doffset(s, coords, offset) tex2D(s, coords, offset)\n"
-			"#define tex2Dlodoffset(s, coords, offset) tex2Dlod(s, coords, offset)\n"
-			"#define tex2Dgather(s, t, c) tex2Dgather##c(s, t)\n"
-			"#define tex2Dgatheroffset(s, t, o, c) tex2Dgather##c(s, t, o)\n"
-			"#define tex2Dgather0 tex2DgatherR\n"
-			"#define tex2Dgather1 tex2DgatherG\n"
-			"#define tex2Dgather2 tex2DgatherB\n"
-			"#define tex2Dgather3 tex2DgatherA\n");
-
 		// Load and preprocess the source file
 		preprocessed = pp.append_file(source_file);
+		cache_miss = true;
 
 		// Append preprocessor errors to the error list
 		errors += pp.errors();
 
 		if (preprocessed)
 		{
-			source = pp.output();
+			skip_optimization = finalize_preprocessed_effect(pp, source, code_preamble, preprocessor_definitions);
 
-			for (const std::pair<std::string, std::string> &pragma : pp.used_pragma_directives())
-			{
-				if (pragma.first == "reshade")
-				{
-					if (pragma.second == "skipoptimization" || pragma.second == "nooptimization")
-						skip_optimization = true;
-					continue;
-				}
-
-				const std::string pragma_directive = "#pragma " + pragma.first + ' ' + pragma.second + '\n';
+			// Keep track of the files this effect depends upon and their content hashes, so that the next load only has to check those
+			dependency_files = pp.included_files();
+			dependency_files.insert(dependency_files.begin(), source_file);
 
-				code_preamble += pragma_directive;
-				source = "// " + pragma_directive + source;
-			}
-
-			// Keep track of used preprocessor definitions (so they can be displayed in the overlay)
-			for (const std::pair<std::string, std::string> &definition : pp.used_macro_definitions())
+			if (build_effect_dependencies(dependency_files, pp.missing_files(), cache_key.search_paths, g_reshade_base_path, s_effect_include_cache, dependencies) &&
+				check_effect_dependencies(dependencies, g_reshade_base_path, dependencies_key, dependency_files))
 			{
-				if (definition.first.size() < 8 ||
-					definition.first[0] == '_' ||
-					definition.first.compare(0, 7, "BUFFER_") == 0 ||
-					definition.first.compare(0, 8, "RESHADE_") == 0 ||
-					definition.first.find("INCLUDE_") != std::string::npos)
-					continue;
+				source_hash = reshadefx::hash_data(dependencies_key, reshadefx::hash_data(attributes));
 
-				preprocessor_definitions.emplace_back(definition.first, trim(definition.second));
+				if (permutation_index == 0)
+				{
+					effect.source_hash = source_hash;
+					effect.dependencies = dependencies;
+				}
 
-				// Write used preprocessor definitions to the cached source
-				source = "// " + definition.first + '=' + definition.second + '\n' + source;
+				// Do not cache if any special pragma directives were used, to ensure they are read again next time
+				if (!skip_optimization && save_effect_cache(dependencies_cache_id, "deps", dependencies))
+					source_cached = save_effect_cache(cache_key.cache_id(source_hash), "i", source);
 			}
-
-			std::sort(preprocessor_definitions.begin(), preprocessor_definitions.end());
-
-			// Do not cache if any special pragma directives were used, to ensure they are read again next time
-			if (!skip_optimization)
-				source_cached = save_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id) + '-' + std::to_string(source_hash), "i", source);
 		}
 
 		if (permutation_index == 0)
@@ -1676,35 +1739,26 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			}
 
 			std::sort(effect.definitions.begin(), effect.definitions.end());
+
+			// Restore the list of included files from the dependency manifest (which has the source file itself as the first entry)
+			effect.included_files.assign(dependency_files.begin() + 1, dependency_files.end());
+			std::sort(effect.included_files.begin(), effect.included_files.end());
 		}
 	}
 
 	std::unique_ptr<reshadefx::codegen> codegen;
 	if (!compiled && !source.empty())
 	{
-		unsigned shader_model;
-		if (_renderer_id == 0x9000)
-			shader_model = 30; // D3D9
-		else if (_renderer_id < 0xa100)
-			shader_model = 40; // D3D10 (including feature level 9)
-		else if (_renderer_id < 0xb000)
-			shader_model = 41; // D3D10.1
-		else if (_renderer_id < 0xc000)
-			shader_model = 50; // D3D11
-		else
-			shader_model = 51; // D3D12
-
-		if ((_renderer_id & 0xF0000) == 0)
-			codegen.reset(reshadefx::create_codegen_hlsl(shader_model, !_no_debug_info, _performance_mode));
-		else if (_renderer_id < 0x20000)
-			codegen.reset(reshadefx::create_codegen_glsl(false, !_no_debug_info, _performance_mode, false, true));
-		else // Vulkan uses SPIR-V input
-			codegen.reset(reshadefx::create_codegen_spirv(true, !_no_debug_info, _performance_mode, false, false));
+		codegen.reset(create_effect_codegen(_renderer_id, !_no_debug_info, _performance_mode));
 
 		reshadefx::parser parser;
 
 		// Compile the pre-processed source code (try the compile even if the preprocessor step failed to get additional error information)
-		compiled = parser.parse(std::move(source), codegen.get());
+		{
+			const frame_trace::scope parse_trace_scope(_frame_trace, "load", "parse", effect_name);
+
+			compiled = parser.parse(std::move(source), codegen.get(), !_no_effect_optimization);
+		}
 
 		// Append parser errors to the error list
 		errors += parser.errors();
@@ -1719,9 +1773,11 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 			if (permutation_index == 0)
 			{
 				effect.uniforms.clear();
+				effect.special_uniforms.clear();
 
 				// Create space for all variables (aligned to 16 bytes)
 				effect.uniform_data_storage.resize((permutation.module.total_uniform_size + 15) & ~15);
+				mark_uniform_data_dirty(effect, 0, effect.uniform_data_storage.size());
 
 				for (uniform variable : permutation.module.uniforms)
 				{
@@ -1766,6 +1822,13 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 					// Copy initial data into uniform storage area
 					reset_uniform_value(variable);
 
+					if (special_uniform_update update = {};
+						decode_special_uniform(variable, update))
+					{
+						update.uniform_index = effect.uniforms.size();
+						effect.special_uniforms.push_back(update);
+					}
+
 					effect.uniforms.push_back(std::move(variable));
 				}
 			}
@@ -1939,6 +2002,18 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 		if (permutation.assembly.empty())
 		{
 			// Compile shader modules
+			// Entry points are compiled in parallel, since the backend compiler is the most expensive part of loading an effect with many passes
+			struct entry_point_result
+			{
+				std::string errors;
+				std::string cache_id;
+				bool save_cso = false;
+				bool save_asm = false;
+				bool success = true;
+			};
+
+			std::vector<entry_point_result> entry_point_results(permutation.module.entry_points.size());
+
 			for (const std::pair<std::string, reshadefx::shader_type> &entry_point : permutation.module.entry_points)
 			{
 				if (entry_point.second == reshadefx::shader_type::compute && !_device->check_capability(api::device_caps::compute_shader))
@@ -1947,186 +2022,151 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 					compiled = false;
 					break;
 				}
+			}
 
-				std::string &cso = permutation.assembly[entry_point.first];
-				std::string &cso_text = permutation.assembly_text[entry_point.first];
-
-				if ((_renderer_id & 0xF0000) == 0)
-				{
-					assert(_d3d_compiler_module != nullptr);
-
-					// Copy string, since this has to be repeated for every entry point
-					std::string hlsl = code_preamble;
-
-					if (_renderer_id == 0x9000)
-					{
-						// Create SEMANTIC_PIXEL_SIZE constants
-						hlsl += "#define COLOR_PIXEL_SIZE 1.0 / " + std::to_string(_effect_permutations[permutation_index].width) + ", 1.0 / " + std::to_string(_effect_permutations[permutation_index].height) + '\n';
-
-						uint32_t semantic_index = 0;
-						for (const reshadefx::texture &tex : permutation.module.textures)
-						{
-							if (tex.semantic.empty() || tex.semantic == "COLOR")
-								continue;
-
-							semantic_index++;
-							assert((effect.uniform_data_storage.size() / 16) <= (224 - semantic_index));
+			task_scheduler::group entry_point_tasks;
 
-							// Avoid duplicate declarations if the semantic was used multiple times
-							if (hlsl.find(tex.semantic + "_PIXEL_SIZE") == std::string::npos)
-								hlsl += "uniform float2 " + tex.semantic + "_PIXEL_SIZE : register(c" + std::to_string(224 - semantic_index) + ");\n";
-						}
-					}
+			for (size_t entry_point_index = 0; compiled && entry_point_index < permutation.module.entry_points.size(); ++entry_point_index)
+			{
+				const std::pair<std::string, reshadefx::shader_type> &entry_point = permutation.module.entry_points[entry_point_index];
 
-					hlsl += "#line 1\n"; // Reset line number, so it matches what is shown when viewing the generated code
-					hlsl += codegen->finalize_code_for_entry_point(entry_point.first);
+				// References to map elements stay valid when other elements are inserted, so tasks can write to them while this loop continues
+				std::string &cso = permutation.assembly[entry_point.first];
+				std::string_view &cso_view = permutation.assembly_views[entry_point.first];
+				std::string &cso_text = permutation.assembly_text[entry_point.first];
 
-					std::string profile;
-					switch (entry_point.second)
-					{
-					case reshadefx::shader_type::vertex:
-						profile = "vs";
-						break;
-					case reshadefx::shader_type::pixel:
-						profile = "ps";
-						break;
-					case reshadefx::shader_type::compute:
-						profile = "cs";
-						break;
-					}
+				_load_scheduler.push([this, &effect, &permutation, &codegen, &code_preamble, &entry_point, &cso, &cso_view, &cso_text, &result = entry_point_results[entry_point_index], permutation_index, skip_optimization]() {
+					const frame_trace::scope compile_trace_scope(_frame_trace, "load", "compile", entry_point.first);
 
-					switch (_renderer_id)
+					if ((_renderer_id & 0xF0000) == 0)
 					{
-					default:
-					case D3D_FEATURE_LEVEL_11_0:
-						profile += "_5_0";
-						break;
-					case D3D_FEATURE_LEVEL_10_1:
-						profile += "_4_1";
-						break;
-					case D3D_FEATURE_LEVEL_10_0:
-						profile += "_4_0";
-						break;
-					case D3D_FEATURE_LEVEL_9_1:
-					case D3D_FEATURE_LEVEL_9_2:
-						profile += "_4_0_level_9_1";
-						break;
-					case D3D_FEATURE_LEVEL_9_3:
-						profile += "_4_0_level_9_3";
-						break;
-					case 0x9000:
-						profile += "_3_0";
-						break;
-					}
-
-					UINT compile_flags = 0;
-					if (skip_optimization)
-						compile_flags |= D3DCOMPILE_SKIP_OPTIMIZATION;
-					else if (_performance_mode)
-						compile_flags |= D3DCOMPILE_OPTIMIZATION_LEVEL3;
-					if (_renderer_id >= D3D_FEATURE_LEVEL_10_0)
-						compile_flags |= D3DCOMPILE_ENABLE_STRICTNESS;
-#ifndef NDEBUG
-					compile_flags |= D3DCOMPILE_DEBUG;
-#endif
+						assert(_d3d_compiler_module != nullptr);
 
-					std::string hlsl_attributes;
-					hlsl_attributes += "entrypoint=" + entry_point.first + ';';
-					hlsl_attributes += "profile=" + profile + ';';
-					hlsl_attributes += "flags=" + std::to_string(compile_flags) + ';';
+						const std::string hlsl = build_effect_hlsl(*codegen, permutation.module, code_preamble, entry_point.first, _renderer_id, _effect_permutations[permutation_index].width, _effect_permutations[permutation_index].height);
+						const std::string profile = effect_hlsl_profile(entry_point.second, _renderer_id);
+						const UINT compile_flags = effect_hlsl_compile_flags(_renderer_id, skip_optimization, _performance_mode);
 
-					const std::string cache_id =
-						effect.source_file.stem().u8string() + '-' + entry_point.first + '-' + std::to_string(_renderer_id) + '-' +
-						std::to_string(std::hash<std::string_view>()(hlsl_attributes) ^ std::hash<std::string_view>()(hlsl));
+						std::string &cache_id = result.cache_id;
+						cache_id = effect_shader_cache_id(effect.source_file, entry_point.first, _renderer_id, profile, compile_flags, hlsl);
 
-					if (!load_effect_cache(cache_id, "cso", cso))
-					{
-						const auto D3DCompile = reinterpret_cast<pD3DCompile>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DCompile"));
-						assert(D3DCompile != nullptr);
-
-						com_ptr<ID3DBlob> d3d_compiled, d3d_errors;
-						const HRESULT hr = D3DCompile(
-							hlsl.data(), hlsl.size(),
-							nullptr, nullptr, nullptr,
-							entry_point.first.c_str(),
-							profile.c_str(),
-							compile_flags, 0,
-							&d3d_compiled, &d3d_errors);
-
-						std::string d3d_errors_string;
-						if (d3d_errors != nullptr) // Append warnings to the output error string as well
-							d3d_errors_string.assign(static_cast<const char *>(d3d_errors->GetBufferPointer()), d3d_errors->GetBufferSize() - 1); // Subtracting one to not append the null-terminator as well
-						d3d_errors.reset();
-
-						// De-duplicate error lines (D3DCompiler sometimes repeats the same error multiple times)
-						for (size_t line_offset = 0, next_line_offset; (next_line_offset = d3d_errors_string.find('\n', line_offset)) != std::string::npos; line_offset = next_line_offset + 1)
+						// Reference cached shader code directly in the effect cache archive, instead of copying it
+						if (!load_effect_cache(cache_id, "cso", cso, cso_view))
 						{
-							const std::string_view cur_line(d3d_errors_string.data() + line_offset, next_line_offset - line_offset);
-
-							if (const size_t end_offset = d3d_errors_string.find('\n', next_line_offset + 1);
-								end_offset != std::string::npos)
+							const auto D3DCompile = reinterpret_cast<pD3DCompile>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DCompile"));
+							assert(D3DCompile != nullptr);
+
+							com_ptr<ID3DBlob> d3d_compiled, d3d_errors;
+							const HRESULT hr = D3DCompile(
+								hlsl.data(), hlsl.size(),
+								nullptr, nullptr, nullptr,
+								entry_point.first.c_str(),
+								profile.c_str(),
+								compile_flags, 0,
+								&d3d_compiled, &d3d_errors);
+
+							std::string d3d_errors_string;
+							if (d3d_errors != nullptr) // Append warnings to the output error string as well
+								d3d_errors_string.assign(static_cast<const char *>(d3d_errors->GetBufferPointer()), d3d_errors->GetBufferSize() - 1); // Subtracting one to not append the null-terminator as well
+							d3d_errors.reset();
+
+							// De-duplicate error lines (D3DCompiler sometimes repeats the same error multiple times)
+							for (size_t line_offset = 0, next_line_offset; (next_line_offset = d3d_errors_string.find('\n', line_offset)) != std::string::npos; line_offset = next_line_offset + 1)
 							{
-								const std::string_view next_line(d3d_errors_string.data() + next_line_offset + 1, end_offset - next_line_offset - 1);
-								if (cur_line == next_line)
+								const std::string_view cur_line(d3d_errors_string.data() + line_offset, next_line_offset - line_offset);
+
+								if (const size_t end_offset = d3d_errors_string.find('\n', next_line_offset + 1);
+									end_offset != std::string::npos)
 								{
-									d3d_errors_string.erase(next_line_offset, end_offset - next_line_offset);
+									const std::string_view next_line(d3d_errors_string.data() + next_line_offset + 1, end_offset - next_line_offset - 1);
+									if (cur_line == next_line)
+									{
+										d3d_errors_string.erase(next_line_offset, end_offset - next_line_offset);
+										next_line_offset = line_offset - 1;
+									}
+								}
+
+								// Also remove D3DCompiler warnings about 'groupshared' specifier used in VS/PS modules
+								if (cur_line.find("X3579") != std::string_view::npos)
+								{
+									d3d_errors_string.erase(line_offset, next_line_offset + 1 - line_offset);
 									next_line_offset = line_offset - 1;
 								}
 							}
 
-							// Also remove D3DCompiler warnings about 'groupshared' specifier used in VS/PS modules
-							if (cur_line.find("X3579") != std::string_view::npos)
+							if (FAILED(hr))
 							{
-								d3d_errors_string.erase(line_offset, next_line_offset + 1 - line_offset);
-								next_line_offset = line_offset - 1;
+								// Add a prefix with the offending entry point name for generic error messages like an out of memory notification
+								if (d3d_errors_string.find("error") == std::string::npos)
+									result.errors += "error: " + entry_point.first + ": ";
+
+								result.errors += d3d_errors_string;
+								result.success = false;
+								return;
 							}
+							else
+							{
+								// Append warnings
+								result.errors += d3d_errors_string;
+							}
+
+							cso.resize(d3d_compiled->GetBufferSize());
+							std::memcpy(cso.data(), d3d_compiled->GetBufferPointer(), cso.size());
+							cso_view = cso;
+
+							result.save_cso = true;
 						}
 
-						if (FAILED(hr))
+						if (!load_effect_cache(cache_id, "asm", cso_text))
 						{
-							// Add a prefix with the offending entry point name for generic error messages like an out of memory notification
-							if (d3d_errors_string.find("error") == std::string::npos)
-								errors += "error: " + entry_point.first + ": ";
+							const auto D3DDisassemble = reinterpret_cast<pD3DDisassemble>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DDisassemble"));
+							assert(D3DDisassemble != nullptr);
 
-							errors += d3d_errors_string;
-							compiled = false;
-							break;
+							com_ptr<ID3DBlob> d3d_disassembled;
+							if (SUCCEEDED(D3DDisassemble(cso_view.data(), cso_view.size(), 0, nullptr, &d3d_disassembled)))
+								cso_text.assign(static_cast<const char *>(d3d_disassembled->GetBufferPointer()), d3d_disassembled->GetBufferSize() - 1);
+
+							result.save_asm = true;
 						}
-						else
+					}
+					else
+					{
+						cso = codegen->finalize_code_for_entry_point(entry_point.first);
+
+						if (_renderer_id < 0x20000)
 						{
-							// Append warnings
-							errors += d3d_errors_string;
-						}
+							cso.insert(std::size("#version 430\n") - 1, code_preamble);
 
-						cso.resize(d3d_compiled->GetBufferSize());
-						std::memcpy(cso.data(), d3d_compiled->GetBufferPointer(), cso.size());
+							cso_text = cso;
+						}
 
-						save_effect_cache(cache_id, "cso", cso);
+						cso_view = cso;
 					}
+				}, entry_point_tasks);
+			}
 
-					if (!load_effect_cache(cache_id, "asm", cso_text))
-					{
-						const auto D3DDisassemble = reinterpret_cast<pD3DDisassemble>(GetProcAddress(static_cast<HMODULE>(_d3d_compiler_module), "D3DDisassemble"));
-						assert(D3DDisassemble != nullptr);
+			_load_scheduler.wait(entry_point_tasks);
 
-						com_ptr<ID3DBlob> d3d_disassembled;
-						if (SUCCEEDED(D3DDisassemble(cso.data(), cso.size(), 0, nullptr, &d3d_disassembled)))
-							cso_text.assign(static_cast<const char *>(d3d_disassembled->GetBufferPointer()), d3d_disassembled->GetBufferSize() - 1);
+			// Collect results in entry point order, so that the error list and cache writes do not depend on the order in which tasks finished
+			for (size_t entry_point_index = 0; compiled && entry_point_index < permutation.module.entry_points.size(); ++entry_point_index)
+			{
+				const entry_point_result &result = entry_point_results[entry_point_index];
+				const std::string &entry_point_name = permutation.module.entry_points[entry_point_index].first;
 
-						save_effect_cache(cache_id, "asm", cso_text);
-					}
-				}
-				else
-				{
-					cso = codegen->finalize_code_for_entry_point(entry_point.first);
+				errors += result.errors;
 
-					if (_renderer_id < 0x20000)
-					{
-						cso.insert(std::size("#version 430\n") - 1, code_preamble);
+				if (!result.success)
+				{
+					compiled = false;
+					break;
+				}
 
-						cso_text = cso;
-					}
+				if (result.save_cso)
+				{
+					save_effect_cache(result.cache_id, "cso", permutation.assembly.at(entry_point_name));
+					cache_miss = true;
 				}
+				if (result.save_asm)
+					save_effect_cache(result.cache_id, "asm", permutation.assembly_text.at(entry_point_name));
 			}
 		}
 
@@ -2296,6 +2336,11 @@ bool reshade::runtime::load_effect(const std::filesystem::path &source_file, con
 
 	if (compiled && (preprocessed || source_cached))
 	{
+		// Remember how long this effect took to load, so that the next reload can start with the most expensive effects first
+		// This is skipped when everything came from the cache, since that says little about how long compiling it takes after it changed
+		if (permutation_index == 0 && cache_miss)
+			save_effect_cache(source_file.stem().u8string() + '-' + std::to_string(_renderer_id), "cost", std::to_string(std::chrono::duration_cast<std::chrono::microseconds>(time_load_finished - time_load_started).count()));
+
 		if (effect.errors.empty())
 			log::message(log::level::info, "Successfully compiled '%s'%s in %f s.", source_file.u8string().c_str(), permutation_index == 0 ? "" : " permutation", std::chrono::duration_cast<std::chrono::milliseconds>(time_load_finished - time_load_started).count() * 1e-3f);
 		else
@@ -2423,9 +2468,15 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 				srv_range.count = std::max(srv_range.count, binding.entry_point_binding + 1);
 			for (const reshadefx::storage_binding &binding : pass.storage_bindings)
 				uav_range.count = std::max(uav_range.count, binding.entry_point_binding + 1);
+
+			if (!pass.cs_entry_point.empty())
+				_effect_state_subset.compute = true;
 		}
 	}
 
+	_effect_state_subset.sampler_count = std::max(_effect_state_subset.sampler_count, sampler_range.count);
+	_effect_state_subset.shader_resource_view_count = std::max(_effect_state_subset.shader_resource_view_count, srv_range.count);
+
 	// Create optional query heap for time measurements
 	if (permutation_index == 0 &&
 		!_device->create_query_heap(api::query_type::timestamp, static_cast<uint32_t>((permutation.module.techniques.size() + total_pass_count) * 2 * 4), &effect.query_heap))
@@ -2496,6 +2547,9 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 			}
 
 			_device->set_resource_name(effect.cb, "ReShade constant buffer");
+
+			// New buffer has undefined contents, so needs to be filled completely
+			mark_uniform_data_dirty(effect, 0, effect.uniform_data_storage.size());
 		}
 		else
 		{
@@ -2571,7 +2625,7 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 			if (!pass.cs_entry_point.empty())
 			{
 				api::shader_desc cs_desc = {};
-				const std::string &cs = permutation.assembly.at(pass.cs_entry_point);
+				const std::string_view cs = permutation.assembly_views.at(pass.cs_entry_point);
 				cs_desc.code = cs.data();
 				cs_desc.code_size = cs.size();
 				if (_renderer_id & 0x20000)
@@ -2597,7 +2651,7 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 				api::shader_desc vs_desc = {};
 				if (!pass.vs_entry_point.empty())
 				{
-					const std::string &vs = permutation.assembly.at(pass.vs_entry_point);
+					const std::string_view vs = permutation.assembly_views.at(pass.vs_entry_point);
 					vs_desc.code = vs.data();
 					vs_desc.code_size = vs.size();
 					if (_renderer_id & 0x20000)
@@ -2614,7 +2668,7 @@ bool reshade::runtime::create_effect(size_t effect_index, size_t permutation_ind
 				api::shader_desc ps_desc = {};
 				if (!pass.ps_entry_point.empty())
 				{
-					const std::string &ps = permutation.assembly.at(pass.ps_entry_point);
+					const std::string_view ps = permutation.assembly_views.at(pass.ps_entry_point);
 					ps_desc.code = ps.data();
 					ps_desc.code_size = ps.size();
 					if (_renderer_id & 0x20000)
@@ -3524,8 +3578,25 @@ void reshade::runtime::reorder_techniques(std::vector<size_t> &&technique_indice
 	_technique_sorting = std::move(technique_indices);
 }
 
+static size_t get_max_loader_thread_count()
+{
+	size_t num_threads = static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+#ifndef _WIN64
+	// Limit number of threads in 32-bit due to the limited about of address space being available there and compilation being memory hungry
+	num_threads = std::min(num_threads, static_cast<size_t>(4));
+#endif
+	return num_threads;
+}
+
 void reshade::runtime::load_effects(bool force_load_all)
 {
+	if (!_uses_effect_string_table)
+	{
+		const std::unique_lock<std::mutex> lock(s_effect_string_table_mutex);
+		s_effect_string_table_users++;
+		_uses_effect_string_table = true;
+	}
+
 	// Build a list of effect files by walking through the effect search paths
 	const std::vector<std::filesystem::path> effect_files =
 		find_files(_effect_search_paths, { L".fx", L".addonfx" });
@@ -3533,6 +3604,9 @@ void reshade::runtime::load_effects(bool force_load_all)
 	if (effect_files.empty())
 		return; // No effect files found, so nothing more to do
 
+	// Check all included files for changes again
+	s_effect_include_cache.invalidate();
+
 	ini_file &preset = ini_file::load_cache(_current_preset_path);
 
 	// Have to be initialized at this point or else the threads spawned below will immediately exit without reducing the remaining effects count
@@ -3566,27 +3640,47 @@ void reshade::runtime::load_effects(bool force_load_all)
 	for (const std::filesystem::path &effect_file : effect_files)
 		preset.get(effect_file.filename().u8string(), "PreprocessorDefinitions", _preset_preprocessor_definitions[effect_file.filename().u8string()]);
 
+	// Open effect cache archive before any loading threads are spawned, so that they can look up cached data from it
+	if (!_no_effect_cache && !_no_effect_cache_archive && !_effect_cache_archive.is_open() &&
+		!_effect_cache_archive.open(g_reshade_base_path / _effect_cache_path / L"reshade-effects.cache", static_cast<uint64_t>(_effect_cache_size_limit) * 1024 * 1024))
+		log::message(log::level::warning, "Failed to open effect cache archive in '%s'. Falling back to separate cache files.", _effect_cache_path.u8string().c_str());
+
 	// Allocate space for effects which are placed in this array during the 'load_effect' call
 	const size_t offset = _effects.size();
 	_effects.resize(offset + effect_files.size());
 	_reload_remaining_effects = effect_files.size();
 
-	// Now that we have a list of files, load them in parallel
-	// Split workload into batches instead of launching a thread for every file to avoid launch overhead and stutters due to too many threads being in flight
-	size_t num_splits = std::min(effect_files.size(), static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 2u) - 1));
-#ifndef _WIN64
-	// Limit number of threads in 32-bit due to the limited about of address space being available there and compilation being memory hungry
-	num_splits = std::min(num_splits, static_cast<size_t>(4));
-#endif
+	// Order effects by how long they took to load the last time, so that the most expensive ones are started first and do not end up delaying the end of loading
+	std::vector<std::pair<size_t, uint64_t>> load_order;
+	load_order.reserve(effect_files.size());
+	for (size_t i = 0; i < effect_files.size(); ++i)
+	{
+		uint64_t load_cost = 0;
+		if (std::string load_cost_string;
+			load_effect_cache(effect_files[i].stem().u8string() + '-' + std::to_string(_renderer_id), "cost", load_cost_string))
+			std::from_chars(load_cost_string.data(), load_cost_string.data() + load_cost_string.size(), load_cost);
 
-	// Keep track of the spawned threads, so the runtime cannot be destroyed while they are still running
-	for (size_t n = 0; n < num_splits; ++n)
-		_worker_threads.emplace_back([this, effect_files, offset, num_splits, n, &preset, force_load_all]() {
+		load_order.emplace_back(i, load_cost);
+	}
+
+	std::stable_sort(load_order.begin(), load_order.end(),
+		[](const std::pair<size_t, uint64_t> &lhs, const std::pair<size_t, uint64_t> &rhs) {
+			return lhs.second > rhs.second;
+		});
+
+	for (const std::pair<size_t, uint64_t> &load_entry : load_order)
+	{
+		_load_scheduler.push([this, effect_file = effect_files[load_entry.first], effect_index = offset + load_entry.first, &preset, force_load_all]() {
 			// Abort loading when initialization state changes (indicating that 'on_reset' was called in the meantime)
-			for (size_t i = 0; i < effect_files.size() && _is_initialized; ++i)
-				if (i * num_splits / effect_files.size() == n)
-					load_effect(effect_files[i], preset, offset + i, 0, force_load_all || effect_files[i].extension() == L".addonfx");
+			if (_is_initialized)
+				load_effect(effect_file, preset, effect_index, 0, force_load_all || effect_file.extension() == L".addonfx");
 		});
+	}
+
+	// Now that we have a list of files, load them in parallel
+	// Threads pull the next effect from the shared queue as soon as they are done with the previous one, instead of launching a thread for every file, to avoid launch overhead and stutters due to too many threads being in flight
+	// The threads are kept around after loading finished, so that reloading a single effect or permutation later on can reuse them
+	_load_scheduler.start(get_max_loader_thread_count());
 }
 bool reshade::runtime::reload_effect(size_t effect_index)
 {
@@ -3610,7 +3704,18 @@ bool reshade::runtime::reload_effect(size_t effect_index)
 	// Make sure 'is_loading' is true while loading the effect
 	_reload_remaining_effects = 1;
 
-	return load_effect(source_file, ini_file::load_cache(_current_preset_path), effect_index, 0, true, true);
+	s_effect_include_cache.invalidate();
+
+	// Load the effect through the shared task queue, so that the loader threads can compile its entry points in parallel while this thread waits for it to finish
+	bool success = false;
+	task_scheduler::group load_task;
+	_load_scheduler.push([this, &source_file, effect_index, &success]() {
+		success = load_effect(source_file, ini_file::load_cache(_current_preset_path), effect_index, 0, true, true);
+	}, load_task);
+
+	_load_scheduler.wait(load_task);
+
+	return success;
 }
 void reshade::runtime::reload_effects(bool force_load_all)
 {
@@ -3634,6 +3739,8 @@ void reshade::runtime::reload_effects(bool force_load_all)
 void reshade::runtime::destroy_effects()
 {
 	// Make sure no threads are still accessing effect data
+	// Any effects still queued for loading are loaded here too, but abort early if this is called because the runtime is being reset
+	_load_scheduler.run();
 	for (std::thread &thread : _worker_threads)
 		if (thread.joinable())
 			thread.join();
@@ -3643,6 +3750,9 @@ void reshade::runtime::destroy_effects()
 	_effect_filter[0] = '\0';
 #endif
 
+	// Close effect cache archive after all loading threads finished, so that any views into it are no longer in use
+	_effect_cache_archive.close();
+
 	// Reset the effect creation queue
 	_reload_create_queue.clear();
 	_reload_required_effects.clear();
@@ -3657,6 +3767,8 @@ void reshade::runtime::destroy_effects()
 	// Reset the effect list after all resources have been destroyed
 	_effects.clear();
 
+	_effect_state_subset = { 1, 1, 1, false, false };
+
 	// Clean up sampler objects
 	for (const auto &[hash, sampler] : _effect_sampler_states)
 		_device->destroy_sampler(sampler);
@@ -3672,19 +3784,61 @@ void reshade::runtime::destroy_effects()
 	// Textures and techniques should have been cleaned up by the calls to 'destroy_effect' above
 	assert(_textures.empty());
 	assert(_techniques.empty() && _technique_sorting.empty());
+
+	if (_uses_effect_string_table)
+	{
+		const std::unique_lock<std::mutex> lock(s_effect_string_table_mutex);
+		_uses_effect_string_table = false;
+
+		// Release interned strings once no runtime has any effects loaded anymore, so that they do not accumulate over reloads
+		// The include cache holds tokens that reference interned strings, so it has to be cleared along with them
+		if (--s_effect_string_table_users == 0)
+		{
+			s_effect_include_cache.clear();
+			reshadefx::string_atom::clear_table();
+		}
+	}
 }
 
 bool reshade::runtime::load_effect_cache(const std::string &id, const std::string &type, std::string &data) const
+{
+	std::string_view data_view;
+	if (!load_effect_cache(id, type, data, data_view))
+		return false;
+
+	if (data_view.data() != data.data())
+		data.assign(data_view);
+	return true;
+}
+bool reshade::runtime::load_effect_cache(const std::string &id, const std::string &type, std::string &data, std::string_view &data_view) const
 {
 	if (_no_effect_cache)
 		return false;
 
+	if (_effect_cache_archive.is_open())
+	{
+		// Return a view of the mapped archive data where possible, which stays valid until the archive is closed
+		if (!_effect_cache_archive.load(id + '.' + type, data, data_view))
+		{
+			_frame_trace.add_instant("cache", "cache miss", id + '.' + type);
+			return false;
+		}
+
+		_frame_trace.add_instant("cache", "cache hit", id + '.' + type);
+		return true;
+	}
+
 	std::filesystem::path path = g_reshade_base_path / _effect_cache_path;
 	path /= std::filesystem::u8path("reshade-" + id + '.' + type);
 
 	FILE *const file = _wfsopen(path.c_str(), L"rb", SH_DENYNO);
 	if (file == nullptr)
+	{
+		_frame_trace.add_instant("cache", "cache miss", id + '.' + type);
 		return false;
+	}
+
+	_frame_trace.add_instant("cache", "cache hit", id + '.' + type);
 
 	fseek(file, 0, SEEK_END);
 	const size_t file_size = ftell(file);
@@ -3693,13 +3847,17 @@ bool reshade::runtime::load_effect_cache(const std::string &id, const std::strin
 	data.resize(file_size, '\0');
 	const size_t file_size_read = fread(data.data(), 1, data.size(), file);
 	fclose(file);
+	data_view = data;
 	return file_size_read == data.size();
 }
-bool reshade::runtime::save_effect_cache(const std::string &id, const std::string &type, const std::string &data) const
+bool reshade::runtime::save_effect_cache(const std::string &id, const std::string &type, const std::string &data)
 {
 	if (_no_effect_cache)
 		return false;
 
+	if (_effect_cache_archive.is_open())
+		return _effect_cache_archive.save(id + '.' + type, data);
+
 	std::filesystem::path path = g_reshade_base_path / _effect_cache_path;
 	path /= std::filesystem::u8path("reshade-" + id + '.' + type);
 
@@ -3713,6 +3871,9 @@ bool reshade::runtime::save_effect_cache(const std::string &id, const std::strin
 }
 void reshade::runtime::clear_effect_cache()
 {
+	// The archive file cannot be deleted while it is open, so instead remove all its entries, which truncates it when it is closed
+	_effect_cache_archive.clear();
+
 	std::error_code ec;
 
 	// Find all cached effect files and delete them
@@ -3723,7 +3884,9 @@ void reshade::runtime::clear_effect_cache()
 
 		const std::filesystem::path filename = entry.path().filename();
 		const std::filesystem::path extension = entry.path().extension();
-		if (filename.native().compare(0, 8, L"reshade-") != 0 || (extension != L".i" && extension != L".cso" && extension != L".asm"))
+		if (filename.native().compare(0, 8, L"reshade-") != 0 || (extension != L".i" && extension != L".cso" && extension != L".asm" && extension != L".deps" && extension != L".cost" && extension != L".cache"))
+			continue;
+		if (_effect_cache_archive.is_open() && filename == L"reshade-effects.cache")
 			continue;
 
 		std::filesystem::remove(entry, ec);
@@ -3839,15 +4002,16 @@ void reshade::runtime::update_effects()
 			}
 			else
 			{
-				// This resize should only happen on the first non-default permutation, before launching threads that can access it
+				// This resize should only happen on the first non-default permutation, before queuing loads that can access it
 				if (_effects[effect_index].permutations.size() < _effect_permutations.size())
 					_effects[effect_index].permutations.resize(_effect_permutations.size());
 
 				_reload_remaining_effects += 1;
 
-				_worker_threads.emplace_back([this, effect_index, permutation_index]() {
-						load_effect(_effects[effect_index].source_file, ini_file::load_cache(_current_preset_path), effect_index, permutation_index, true);
-					});
+				// Load through the shared task queue as well, so that the entry points of the permutation are compiled in parallel by the loader threads
+				_load_scheduler.push([this, effect_index, permutation_index]() {
+					load_effect(_effects[effect_index].source_file, ini_file::load_cache(_current_preset_path), effect_index, permutation_index, true);
+				});
 			}
 
 			// Force immediate effect initialization of this permutation after reloading
@@ -3867,6 +4031,10 @@ void reshade::runtime::update_effects()
 				thread.join(); // Threads have exited, but still need to join them prior to destruction
 		_worker_threads.clear();
 
+		// Drop files from the include cache that were not used by this reload, so that files of effects that were unloaded or removed do not stay in memory
+		// After reloading a single effect this also drops files only used by other effects, which are simply read again the next time those are loaded
+		s_effect_include_cache.evict_unused();
+
 		// Finished loading effects, so apply preset to figure out which ones need compiling
 		load_current_preset();
 
@@ -3975,9 +4143,11 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		if (!effect.rendering || (!_effects_enabled && !effect.addon))
 			continue;
 
-		for (uniform &variable : effect.uniforms)
+		for (const special_uniform_update &update : effect.special_uniforms)
 		{
-			switch (variable.special)
+			uniform &variable = effect.uniforms[update.uniform_index];
+
+			switch (update.special)
 			{
 				case special_uniform::frame_time:
 				{
@@ -3986,7 +4156,7 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 				}
 				case special_uniform::frame_count:
 				{
-					if (variable.type.is_boolean())
+					if (update.boolean)
 						set_uniform_value(variable, (_frame_count % 2) == 0);
 					else
 						set_uniform_value(variable, static_cast<unsigned int>(_frame_count % UINT_MAX));
@@ -3994,37 +4164,30 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 				}
 				case special_uniform::random:
 				{
-					const int min = variable.annotation_as_int("min", 0, 0);
-					const int max = variable.annotation_as_int("max", 0, RAND_MAX);
-					set_uniform_value(variable, min + (std::rand() % (std::abs(max - min) + 1)));
+					set_uniform_value(variable, update.min_int + (std::rand() % (std::abs(update.max_int - update.min_int) + 1)));
 					break;
 				}
 				case special_uniform::ping_pong:
 				{
-					const float min = variable.annotation_as_float("min", 0, 0.0f);
-					const float max = variable.annotation_as_float("max", 0, 1.0f);
-					const float step_min = variable.annotation_as_float("step", 0);
-					const float step_max = variable.annotation_as_float("step", 1);
-					float increment = step_max == 0 ? step_min : (step_min + std::fmod(static_cast<float>(std::rand()), step_max - step_min + 1));
-					const float smoothing = variable.annotation_as_float("smoothing");
+					float increment = update.step[1] == 0 ? update.step[0] : (update.step[0] + std::fmod(static_cast<float>(std::rand()), update.step[1] - update.step[0] + 1));
 
 					float value[2] = { 0, 0 };
 					get_uniform_value(variable, value, 2);
 					if (value[1] >= 0)
 					{
-						increment = std::max(increment - std::max(0.0f, smoothing - (max - value[0])), 0.05f);
+						increment = std::max(increment - std::max(0.0f, update.smoothing - (update.max - value[0])), 0.05f);
 						increment *= _last_frame_duration.count() * 1e-9f;
 
-						if ((value[0] += increment) >= max)
-							value[0] = max, value[1] = -1;
+						if ((value[0] += increment) >= update.max)
+							value[0] = update.max, value[1] = -1;
 					}
 					else
 					{
-						increment = std::max(increment - std::max(0.0f, smoothing - (value[0] - min)), 0.05f);
+						increment = std::max(increment - std::max(0.0f, update.smoothing - (value[0] - update.min)), 0.05f);
 						increment *= _last_frame_duration.count() * 1e-9f;
 
-						if ((value[0] -= increment) <= min)
-							value[0] = min, value[1] = +1;
+						if ((value[0] -= increment) <= update.min)
+							value[0] = update.min, value[1] = +1;
 					}
 					set_uniform_value(variable, value, 2);
 					break;
@@ -4054,22 +4217,17 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					if (const int keycode = variable.annotation_as_int("keycode");
-						keycode > 7 && keycode < 256)
+					if (update.mode == special_uniform_update::input_mode::toggle)
 					{
-						if (const std::string_view mode = variable.annotation_as_string("mode");
-							mode == "toggle" || variable.annotation_as_int("toggle"))
-						{
-							bool current_value = false;
-							get_uniform_value(variable, &current_value);
-							if (_input->is_key_pressed(keycode))
-								set_uniform_value(variable, !current_value);
-						}
-						else if (mode == "press")
-							set_uniform_value(variable, _input->is_key_pressed(keycode));
-						else
-							set_uniform_value(variable, _input->is_key_down(keycode));
+						bool current_value = false;
+						get_uniform_value(variable, &current_value);
+						if (_input->is_key_pressed(update.keycode))
+							set_uniform_value(variable, !current_value);
 					}
+					else if (update.mode == special_uniform_update::input_mode::press)
+						set_uniform_value(variable, _input->is_key_pressed(update.keycode));
+					else
+						set_uniform_value(variable, _input->is_key_down(update.keycode));
 					break;
 				}
 				case special_uniform::mouse_point:
@@ -4093,22 +4251,17 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					if (const int keycode = variable.annotation_as_int("keycode");
-						keycode >= 0 && keycode < 5)
+					if (update.mode == special_uniform_update::input_mode::toggle)
 					{
-						if (const std::string_view mode = variable.annotation_as_string("mode");
-							mode == "toggle" || variable.annotation_as_int("toggle"))
-						{
-							bool current_value = false;
-							get_uniform_value(variable, &current_value);
-							if (_input->is_mouse_button_pressed(keycode))
-								set_uniform_value(variable, !current_value);
-						}
-						else if (mode == "press")
-							set_uniform_value(variable, _input->is_mouse_button_pressed(keycode));
-						else
-							set_uniform_value(variable, _input->is_mouse_button_down(keycode));
+						bool current_value = false;
+						get_uniform_value(variable, &current_value);
+						if (_input->is_mouse_button_pressed(update.keycode))
+							set_uniform_value(variable, !current_value);
 					}
+					else if (update.mode == special_uniform_update::input_mode::press)
+						set_uniform_value(variable, _input->is_mouse_button_pressed(update.keycode));
+					else
+						set_uniform_value(variable, _input->is_mouse_button_down(update.keycode));
 					break;
 				}
 				case special_uniform::mouse_wheel:
@@ -4116,20 +4269,14 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 					if (_input == nullptr)
 						break;
 
-					const float min = variable.annotation_as_float("min");
-					const float max = variable.annotation_as_float("max");
-					float step = variable.annotation_as_float("step");
-					if (step == 0.0f)
-						step  = 1.0f;
-
 					float value[2] = { 0, 0 };
 					get_uniform_value(variable, value, 2);
 					value[1] = _input->mouse_wheel_delta();
-					value[0] = value[0] + value[1] * step;
-					if (min != max)
+					value[0] = value[0] + value[1] * update.step[0];
+					if (update.min != update.max)
 					{
-						value[0] = std::max(value[0], min);
-						value[0] = std::min(value[0], max);
+						value[0] = std::max(value[0], update.min);
+						value[0] = std::min(value[0], update.max);
 					}
 					set_uniform_value(variable, value, 2);
 					break;
@@ -4187,7 +4334,7 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 	}
 
 	if (!_is_in_present_call)
-		api::capture_state(cmd_list, _app_state);
+		api::capture_state(cmd_list, _app_state, get_app_state_subset(false));
 
 	invoke_addon_event<addon_event::reshade_begin_effects>(this, cmd_list, rtv, rtv_srgb);
 #endif
@@ -4235,6 +4382,26 @@ void reshade::runtime::render_effects(api::command_list *cmd_list, api::resource
 		api::apply_state(cmd_list, _app_state);
 #endif
 }
+auto reshade::runtime::get_app_state_subset([[maybe_unused]] bool in_present) const -> api::state_block_subset
+{
+#if RESHADE_ADDON
+	// Add-ons may modify any state in these events, so have to capture everything
+	if (has_addon_event<addon_event::reshade_begin_effects>() ||
+		has_addon_event<addon_event::reshade_finish_effects>() ||
+		has_addon_event<addon_event::reshade_render_technique>() ||
+		has_addon_event<addon_event::reshade_overlay>() ||
+		has_addon_event<addon_event::reshade_screenshot>())
+		return api::state_block_subset();
+#endif
+
+	api::state_block_subset subset = _effect_state_subset;
+#if RESHADE_GUI
+	// The overlay is drawn with vertex and index buffers during present
+	subset.vertex_buffers = in_present;
+#endif
+	return subset;
+}
+
 void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb, size_t permutation_index)
 {
 	const effect &effect = _effects[tech.effect_index];
@@ -4246,7 +4413,10 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 
 #if RESHADE_GUI
 	uint32_t query_base_index = 0;
-	const bool gather_gpu_statistics = _gather_gpu_statistics && _timestamp_frequency != 0 && effect.query_heap != 0 && permutation_index == 0;
+	const bool trace = _frame_trace.is_capturing();
+	const bool gather_gpu_statistics = (_gather_gpu_statistics || trace) && _timestamp_frequency != 0 && effect.query_heap != 0 && permutation_index == 0;
+
+	const std::chrono::high_resolution_clock::time_point time_technique_started = std::chrono::high_resolution_clock::now();
 
 	if (gather_gpu_statistics)
 	{
@@ -4260,25 +4430,62 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 			const uint64_t tech_duration = timestamps[1] - timestamps[0];
 			tech.average_gpu_duration.append(tech_duration * 1'000'000'000ull / _timestamp_frequency);
 
+			// Convert timestamps to nanoseconds in two steps, to avoid overflowing with large timestamp values
+			const auto timestamp_to_ns = [this](uint64_t timestamp) {
+				return (timestamp / _timestamp_frequency) * 1'000'000'000ull + (timestamp % _timestamp_frequency) * 1'000'000'000ull / _timestamp_frequency;
+			};
+
+			if (trace)
+				_frame_trace.add_gpu_span("technique", tech.name, timestamp_to_ns(timestamps[0]), timestamp_to_ns(timestamps[1]), tech.query_record_times[_frame_count % 4], effect.source_file.filename().u8string());
+
 			for (size_t pass_index = 0; pass_index < tech.permutations[0].passes.size(); ++pass_index)
 			{
 				const uint64_t pass_duration = timestamps[2 + pass_index * 2 + 1] - timestamps[2 + pass_index * 2];
 				tech.permutations[0].passes[pass_index].average_gpu_duration.append(pass_duration * 1'000'000'000ull / _timestamp_frequency);
+
+				if (trace)
+				{
+					const technique::pass &pass = tech.permutations[0].passes[pass_index];
+					_frame_trace.add_gpu_span("pass", pass.name.empty() ? "pass " + std::to_string(pass_index) : pass.name, timestamp_to_ns(timestamps[2 + pass_index * 2]), timestamp_to_ns(timestamps[2 + pass_index * 2 + 1]), tech.query_record_times[_frame_count % 4], tech.name);
+				}
 			}
 		}
 
+		tech.query_record_times[_frame_count % 4] = time_technique_started;
+
 		cmd_list->end_query(effect.query_heap, api::query_type::timestamp, query_base_index);
 	}
-
-	const std::chrono::high_resolution_clock::time_point time_technique_started = std::chrono::high_resolution_clock::now();
 #endif
 
-	// Update shader constants
-	if (void *mapped_uniform_data;
-		effect.cb != 0 && _device->map_buffer_region(effect.cb, 0, effect.uniform_data_storage.size(), api::map_access::write_discard, &mapped_uniform_data))
+	// Update shader constants, which only needs to happen if any changed since the last technique of this effect was rendered
+	if (effect.cb != 0)
 	{
-		std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data(), effect.uniform_data_storage.size());
-		_device->unmap_buffer_region(effect.cb);
+		if (effect.uniform_data_dirty_begin < effect.uniform_data_dirty_end)
+		{
+			size_t offset = effect.uniform_data_dirty_begin & ~static_cast<size_t>(15);
+			size_t size = effect.uniform_data_dirty_end - offset;
+			api::map_access access = api::map_access::write_only;
+
+			// Dynamic buffers in D3D10/11 can only be mapped with discard, which requires rewriting the entire buffer
+			// Prefer orphaning the buffer in OpenGL too, since writing to a range of a buffer that is still in use by the GPU may stall
+			if (const api::device_api device_api = _device->get_api();
+				device_api == api::device_api::d3d10 || device_api == api::device_api::d3d11 || device_api == api::device_api::opengl)
+			{
+				offset = 0;
+				size = effect.uniform_data_storage.size();
+				access = api::map_access::write_discard;
+			}
+
+			if (void *mapped_uniform_data;
+				_device->map_buffer_region(effect.cb, offset, size, access, &mapped_uniform_data))
+			{
+				std::memcpy(mapped_uniform_data, effect.uniform_data_storage.data() + offset, size);
+				_device->unmap_buffer_region(effect.cb);
+
+				effect.uniform_data_dirty_begin = 0;
+				effect.uniform_data_dirty_end = 0;
+			}
+		}
 	}
 	else if (_device->get_api() == api::device_api::d3d9)
 	{
@@ -4313,6 +4520,8 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 #if RESHADE_GUI
 		if (gather_gpu_statistics)
 			cmd_list->end_query(effect.query_heap, api::query_type::timestamp, query_base_index + static_cast<uint32_t>((1 + pass_index) * 2));
+
+		const std::chrono::high_resolution_clock::time_point time_pass_started = trace ? std::chrono::high_resolution_clock::now() : std::chrono::high_resolution_clock::time_point();
 #endif
 
 		const uint32_t num_barriers = static_cast<uint32_t>(pass.modified_resources.size());
@@ -4463,6 +4672,9 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 #if RESHADE_GUI
 		if (gather_gpu_statistics)
 			cmd_list->end_query(effect.query_heap, api::query_type::timestamp, query_base_index + static_cast<uint32_t>((1 + pass_index) * 2) + 1);
+
+		if (trace)
+			_frame_trace.add_span("pass", pass.name.empty() ? "pass " + std::to_string(pass_index) : pass.name, time_pass_started, std::chrono::high_resolution_clock::now(), tech.name);
 #endif
 
 		// Generate mipmaps for modified resources
@@ -4479,6 +4691,9 @@ void reshade::runtime::render_technique(technique &tech, api::command_list *cmd_
 
 	tech.average_cpu_duration.append(std::chrono::duration_cast<std::chrono::nanoseconds>(time_technique_finished - time_technique_started).count());
 
+	if (trace)
+		_frame_trace.add_span("technique", tech.name, time_technique_started, time_technique_finished, effect.source_file.filename().u8string());
+
 	if (gather_gpu_statistics)
 		cmd_list->end_query(effect.query_heap, api::query_type::timestamp, query_base_index + 1);
 #endif
@@ -4648,7 +4863,9 @@ void reshade::runtime::reset_uniform_value(uniform &variable)
 {
 	if (variable.special != reshade::special_uniform::none)
 	{
-		std::memset(_effects[variable.effect_index].uniform_data_storage.data() + variable.offset, 0, variable.size);
+		effect &effect = _effects[variable.effect_index];
+		std::memset(effect.uniform_data_storage.data() + variable.offset, 0, variable.size);
+		mark_uniform_data_dirty(effect, variable.offset, variable.size);
 		return;
 	}
 
@@ -4784,7 +5001,8 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 	size = std::min(size, static_cast<size_t>(variable.size));
 	assert(data != nullptr && (size % 4) == 0);
 
-	std::vector<uint8_t> &data_storage = _effects[variable.effect_index].uniform_data_storage;
+	effect &effect = _effects[variable.effect_index];
+	std::vector<uint8_t> &data_storage = effect.uniform_data_storage;
 	assert(variable.offset + size <= data_storage.size());
 
 	const size_t array_length = (variable.type.is_array() ? variable.type.array_length : 1u);
@@ -4812,8 +5030,18 @@ void reshade::runtime::set_uniform_value_data(uniform &variable, const uint8_t *
 	}
 	else
 	{
+		// Most special variables are set every frame, but often to the same value, so avoid causing an upload in that case
+		if (std::memcmp(data_storage.data() + variable.offset, data, size) == 0)
+			return;
+
 		std::memcpy(data_storage.data() + variable.offset, data, size);
+		mark_uniform_data_dirty(effect, variable.offset, size);
+		return;
 	}
+
+	// Conservatively mark everything from the first written array element onwards
+	const size_t element_offset = base_index * (variable.type.is_matrix() ? variable.type.rows * 16u : 16u);
+	mark_uniform_data_dirty(effect, variable.offset + element_offset, variable.size - element_offset);
 }
 
 template <> void reshade::runtime::set_uniform_value<bool>(uniform &variable, const bool *values, size_t count, size_t array_index)
@@ -8,6 +8,9 @@
 #include "reshade_api.hpp"
 #include "state_block.hpp"
 #include "imgui_code_editor.hpp"
+#include "cache_archive.hpp"
+#include "task_scheduler.hpp"
+#include "frame_trace.hpp"
 #include <chrono>
 #include <memory>
 #include <filesystem>
@@ -168,6 +171,8 @@ namespace reshade
 
 		void reload_effect_next_frame(const char *effect_name) final;
 
+		bool get_addon_event_statistics(const char *addon_name, uint32_t ev, uint64_t *out_duration_ns, uint64_t *out_call_count) const final;
+
 	private:
 		static void check_for_update();
 
@@ -198,12 +203,14 @@ namespace reshade
 		void destroy_effects();
 
 		bool load_effect_cache(const std::string &id, const std::string &type, std::string &data) const;
-		bool save_effect_cache(const std::string &id, const std::string &type, const std::string &data) const;
+		bool load_effect_cache(const std::string &id, const std::string &type, std::string &data, std::string_view &data_view) const;
+		bool save_effect_cache(const std::string &id, const std::string &type, const std::string &data);
 		void clear_effect_cache();
 
 		auto add_effect_permutation(uint32_t width, uint32_t height, api::format color_format, api::format stencil_format, api::color_space color_space) -> size_t;
 
 		void update_effects();
+		auto get_app_state_subset(bool in_present) const -> api::state_block_subset;
 		void render_technique(technique &technique, api::command_list *cmd_list, api::resource back_buffer_resource, api::resource_view back_buffer_rtv, api::resource_view back_buffer_rtv_srgb, size_t permutation_index);
 
 		void save_texture(const texture &texture);
@@ -273,11 +280,16 @@ namespace reshade
 		uint64_t _frame_count = 0;
 		std::chrono::high_resolution_clock::duration _last_frame_duration;
 		std::chrono::high_resolution_clock::time_point _start_time, _last_present_time;
+		// Recording events does not change the state of the runtime, so allow doing so from const methods too
+		mutable frame_trace _frame_trace;
 		#pragma endregion
 
 		#pragma region Effect Loading
 		bool _no_debug_info = true;
+		bool _no_effect_optimization = false;
 		bool _no_effect_cache = false;
+		bool _no_effect_cache_archive = false;
+		unsigned int _effect_cache_size_limit = 512;
 		bool _no_reload_on_init = false;
 		bool _performance_mode = false;
 		bool _effect_load_skipping = false;
@@ -289,6 +301,7 @@ namespace reshade
 		std::vector<std::pair<size_t, size_t>> _reload_required_effects;
 
 		std::filesystem::path _effect_cache_path;
+		cache_archive _effect_cache_archive;
 		std::vector<std::filesystem::path> _effect_search_paths;
 		std::vector<std::filesystem::path> _texture_search_paths;
 
@@ -304,6 +317,8 @@ namespace reshade
 		std::vector<size_t> _technique_sorting;
 
 		std::vector<std::thread> _worker_threads;
+		task_scheduler _load_scheduler;
+		bool _uses_effect_string_table = false;
 		std::chrono::high_resolution_clock::time_point _last_reload_time;
 		#pragma endregion
 
@@ -339,6 +354,8 @@ namespace reshade
 		std::vector<api::resource_view> _back_buffer_targets;
 
 		api::state_block _app_state = {};
+		// Slots and stages modified by the loaded effects, which is all that has to be captured of the application state when nothing else interferes
+		api::state_block_subset _effect_state_subset = { 1, 1, 1, false, false };
 		#pragma endregion
 
 		#pragma region Screenshot
@@ -492,6 +509,7 @@ namespace reshade
 
 		#pragma region Overlay Statistics
 		bool _gather_gpu_statistics = false;
+		unsigned int _trace_frame_count = 60;
 		api::resource_view _preview_texture = {};
 		unsigned int _preview_size[3] = { 0, 0, 0xFFFFFFFF };
 		uint64_t _timestamp_frequency = 0;
@@ -1298,7 +1298,7 @@ void reshade::runtime::render_technique(api::effect_technique handle, api::comma
 	}
 
 	if (!_is_in_present_call)
-		capture_state(cmd_list, _app_state);
+		capture_state(cmd_list, _app_state, get_app_state_subset(false));
 
 	invoke_addon_event<addon_event::reshade_begin_effects>(this, cmd_list, rtv, rtv_srgb);
 #endif
@@ -1465,3 +1465,23 @@ void reshade::runtime::reload_effect_next_frame(const char *effect_name)
 			_reload_required_effects.emplace_back(effect_index, static_cast<size_t>(0u));
 	}
 }
+
+#if RESHADE_ADDON
+bool reshade::runtime::get_addon_event_statistics(const char *addon_name, uint32_t ev, uint64_t *out_duration_ns, uint64_t *out_call_count) const
+{
+	addon_event_statistics statistics[static_cast<uint32_t>(addon_event::max)];
+	if (!addon_profiling || addon_name == nullptr || ev >= static_cast<uint32_t>(addon_event::max) || !reshade::get_addon_event_statistics(addon_name, statistics))
+		return false;
+
+	if (out_duration_ns != nullptr)
+		*out_duration_ns = static_cast<uint64_t>(statistics[ev].average_duration + 0.5f);
+	if (out_call_count != nullptr)
+		*out_call_count = static_cast<uint64_t>(statistics[ev].average_count + 0.5f);
+	return true;
+}
+#else
+bool reshade::runtime::get_addon_event_statistics(const char * /*addon_name*/, uint32_t /*ev*/, uint64_t * /*out_duration_ns*/, uint64_t * /*out_call_count*/) const
+{
+	return false;
+}
+#endif
@@ -2549,6 +2549,24 @@ void reshade::runtime::draw_gui_statistics()
 			ImGui::Text("%*.3f ms GPU", gpu_digits + 4, (post_processing_time_gpu * 1e-6f));
 
 		ImGui::EndGroup();
+
+		ImGui::Spacing();
+
+		if (_frame_trace.is_capturing())
+		{
+			ImGui::Text(_("Capturing trace (%u frames remaining) ..."), _frame_trace.remaining_frames());
+		}
+		else
+		{
+			const float button_width = ImGui::GetContentRegionAvail().x * 0.33333333f;
+
+			ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - button_width - _imgui_context->Style.ItemSpacing.x);
+			ImGui::SliderInt("##trace_frame_count", reinterpret_cast<int *>(&_trace_frame_count), 1, 600, _("%d frames"), ImGuiSliderFlags_AlwaysClamp);
+			ImGui::SameLine();
+			if (ImGui::Button(_("Capture trace"), ImVec2(button_width, 0)))
+				_frame_trace.begin(_trace_frame_count);
+			ImGui::SetItemTooltip(_("Record a timeline of the next frames and effect loading to a JSON file in the base folder, which can be opened in Perfetto or \"chrome://tracing\"."));
+		}
 	}
 
 	if (ImGui::CollapsingHeader(_("Techniques"), ImGuiTreeNodeFlags_DefaultOpen) && !is_loading() && _effects_enabled)
@@ -2665,6 +2683,56 @@ void reshade::runtime::draw_gui_statistics()
 		ImGui::EndGroup();
 	}
 
+#if RESHADE_ADDON
+	if (ImGui::CollapsingHeader(_("Add-ons"), ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		ImGui::Checkbox(_("Measure time spent in add-on event callbacks"), &addon_profiling);
+
+		if (addon_profiling)
+		{
+			for (const addon_info &info : addon_loaded_info)
+			{
+				if (info.handle == nullptr)
+					continue; // Skip disabled add-ons
+
+				addon_event_statistics statistics[static_cast<uint32_t>(addon_event::max)];
+				if (!reshade::get_addon_event_statistics(info.name, statistics))
+					continue;
+
+				float total_duration = 0.0f;
+				float total_count = 0.0f;
+				for (const addon_event_statistics &event_statistics : statistics)
+				{
+					total_duration += event_statistics.average_duration;
+					total_count += event_statistics.average_count;
+				}
+
+				const bool open = ImGui::TreeNodeEx(info.name.c_str(), ImGuiTreeNodeFlags_NoTreePushOnOpen);
+				ImGui::SameLine(ImGui::GetWindowWidth() * 0.33333333f);
+				ImGui::Text("%8.3f ms CPU", total_duration * 1e-6f);
+				ImGui::SameLine(ImGui::GetWindowWidth() * 0.66666666f);
+				ImGui::Text(_("%10.1f calls"), total_count);
+
+				if (!open)
+					continue;
+
+				for (uint32_t ev = 0; ev < static_cast<uint32_t>(addon_event::max); ++ev)
+				{
+					// Skip events that are not called regularly
+					if (statistics[ev].average_count < 0.05f)
+						continue;
+
+					ImGui::Text("  %s", addon_event_to_string(static_cast<addon_event>(ev)));
+					ImGui::SameLine(ImGui::GetWindowWidth() * 0.33333333f);
+					ImGui::Text("%8.3f ms CPU", statistics[ev].average_duration * 1e-6f);
+					ImGui::SameLine(ImGui::GetWindowWidth() * 0.66666666f);
+					ImGui::Text(_("%10.1f calls"), statistics[ev].average_count);
+				}
+			}
+		}
+	}
+#endif
+
 	if (ImGui::CollapsingHeader(_("Render Targets & Textures"), ImGuiTreeNodeFlags_DefaultOpen) && !is_loading())
 	{
 		struct texture_format_info
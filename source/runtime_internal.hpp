@@ -7,6 +7,7 @@
 
 #include "effect_module.hpp"
 #include "moving_average.hpp"
+#include <chrono>
 
 namespace reshade
 {
@@ -179,6 +180,8 @@ namespace reshade
 		bool enabled_in_screenshot = true;
 
 		uint32_t query_base_index = 0;
+		// CPU time at which the queries in each slot of the query ring were recorded, to align their results on the frame trace timeline
+		std::chrono::high_resolution_clock::time_point query_record_times[4];
 
 		 int64_t time_left = 0;
 
@@ -208,6 +211,26 @@ namespace reshade
 		std::vector<permutation> permutations;
 	};
 
+	struct special_uniform_update
+	{
+		enum class input_mode : uint8_t
+		{
+			down,
+			press,
+			toggle
+		};
+
+		size_t uniform_index;
+		special_uniform special;
+		input_mode mode = input_mode::down;
+		bool boolean = false;
+		int keycode = 0;
+		int min_int = 0, max_int = 0;
+		float min = 0.0f, max = 0.0f;
+		float step[2] = { 0.0f, 0.0f };
+		float smoothing = 0.0f;
+	};
+
 	struct effect
 	{
 		std::filesystem::path source_file;
@@ -222,10 +245,16 @@ namespace reshade
 		std::string errors;
 
 		std::vector<std::filesystem::path> included_files;
+		std::string dependencies;
 		std::vector<std::pair<std::string, std::string>> definitions;
 
 		std::vector<uniform> uniforms;
+		// Special uniforms with their annotations already decoded, so they can be updated every frame without looking at any other uniforms
+		std::vector<special_uniform_update> special_uniforms;
 		std::vector<uint8_t> uniform_data_storage;
+		// Byte range in 'uniform_data_storage' that was modified since it was last uploaded to the constant buffer
+		size_t uniform_data_dirty_begin = 0;
+		size_t uniform_data_dirty_end = 0;
 		api::resource cb = {};
 
 		struct binding
@@ -242,6 +271,8 @@ namespace reshade
 			reshadefx::effect_module module;
 			std::string generated_code;
 			std::unordered_map<std::string, std::string> assembly;
+			// Compiled code per entry point, which either references the string in 'assembly' or directly the data in the effect cache archive (which stays mapped until 'destroy_effects')
+			std::unordered_map<std::string, std::string_view> assembly_views;
 			std::unordered_map<std::string, std::string> assembly_text;
 
 			api::pipeline_layout layout = {};
@@ -8,6 +8,7 @@
 #include "d3d10/d3d10_impl_state_block.hpp"
 #include "d3d11/d3d11_impl_state_block.hpp"
 #include "opengl/opengl_impl_device.hpp"
+#include "opengl/opengl_impl_device_context.hpp"
 #include "opengl/opengl_impl_state_block.hpp"
 
 void reshade::api::create_state_block(api::device *device, state_block *out_state_block)
@@ -66,26 +67,29 @@ void reshade::api::apply_state(api::command_list *cmd_list, state_block state_bl
 		break;
 	case api::device_api::opengl:
 		reinterpret_cast<opengl::state_block *>(state_block.handle)->apply();
+		// Bindings were restored without going through the hooks, so cannot trust the shadow state of the render context anymore
+		static_cast<opengl::device_context_impl *>(cmd_list)->invalidate_shadow_state();
 		break;
 	}
 }
-void reshade::api::capture_state(api::command_list *cmd_list, state_block state_block)
+void reshade::api::capture_state(api::command_list *cmd_list, state_block state_block, const state_block_subset &subset)
 {
 	api::device *const device = cmd_list->get_device();
 
 	switch (device->get_api())
 	{
 	case api::device_api::d3d9:
+		// D3D9 always captures everything, since the state touched by the copy and pipeline state blocks goes beyond what the subset describes
 		reinterpret_cast<d3d9::state_block *>(state_block.handle)->capture();
 		break;
 	case api::device_api::d3d10:
-		reinterpret_cast<d3d10::state_block *>(state_block.handle)->capture();
+		reinterpret_cast<d3d10::state_block *>(state_block.handle)->capture(subset);
 		break;
 	case api::device_api::d3d11:
-		reinterpret_cast<d3d11::state_block *>(state_block.handle)->capture(reinterpret_cast<ID3D11DeviceContext *>(cmd_list->get_native()));
+		reinterpret_cast<d3d11::state_block *>(state_block.handle)->capture(reinterpret_cast<ID3D11DeviceContext *>(cmd_list->get_native()), subset);
 		break;
 	case api::device_api::opengl:
-		reinterpret_cast<opengl::state_block *>(state_block.handle)->capture();
+		reinterpret_cast<opengl::state_block *>(state_block.handle)->capture(subset);
 		break;
 	}
 }
@@ -11,9 +11,37 @@ namespace reshade::api
 {
 	RESHADE_DEFINE_HANDLE(state_block);
 
+	/// <summary>
+	/// Describes which state is modified between capturing and applying a state block, so that only that has to be saved and restored.
+	/// The default is to capture everything.
+	/// </summary>
+	struct state_block_subset
+	{
+		/// <summary>
+		/// Number of constant buffer slots (starting at zero) per shader stage that are modified.
+		/// </summary>
+		uint32_t constant_buffer_count = UINT32_MAX;
+		/// <summary>
+		/// Number of sampler slots (starting at zero) per shader stage that are modified.
+		/// </summary>
+		uint32_t sampler_count = UINT32_MAX;
+		/// <summary>
+		/// Number of shader resource view slots (starting at zero) per shader stage that are modified.
+		/// </summary>
+		uint32_t shader_resource_view_count = UINT32_MAX;
+		/// <summary>
+		/// Set when vertex and index buffer bindings are modified.
+		/// </summary>
+		bool vertex_buffers = true;
+		/// <summary>
+		/// Set when compute shader state is modified.
+		/// </summary>
+		bool compute = true;
+	};
+
 	void create_state_block(api::device *device, state_block *out_state_block);
 	void destroy_state_block(api::device *device, state_block state_block);
 
 	void apply_state(api::command_list *cmd_list, state_block state_block);
-	void capture_state(api::command_list *cmd_list, state_block state_block);
+	void capture_state(api::command_list *cmd_list, state_block state_block, const state_block_subset &subset = {});
 }
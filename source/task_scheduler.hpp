@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2014 Patrick Mours
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm> // std::find_if
+#include <functional>
+#include <condition_variable>
+
+namespace reshade
+{
+	/// <summary>
+	/// A task queue that is shared by a set of threads, which each pull the next task from it as soon as they finished their previous one.
+	/// Worker threads are started once and then wait for new tasks when the queue is empty, so that they can be reused instead of being launched again for every batch of tasks.
+	/// Threads waiting for a group of tasks to finish help executing the queued tasks of that group in the meantime, so that tasks can themselves push and wait for nested tasks.
+	/// </summary>
+	class task_scheduler
+	{
+	public:
+		task_scheduler() = default;
+		~task_scheduler() { stop(); }
+
+		task_scheduler(const task_scheduler &) = delete;
+		task_scheduler &operator=(const task_scheduler &) = delete;
+
+		/// <summary>
+		/// A set of tasks that can be waited upon.
+		/// </summary>
+		class group
+		{
+			friend class task_scheduler;
+			size_t _remaining = 0;
+		};
+
+		/// <summary>
+		/// Adds a task to the end of the queue.
+		/// </summary>
+		void push(std::function<void()> task)
+		{
+			const std::unique_lock<std::mutex> lock(_mutex);
+			_tasks.push_back({ std::move(task), nullptr });
+			// Wake up all threads, since a thread waiting on a group would ignore this task and not pass on the notification
+			_condition.notify_all();
+		}
+		/// <summary>
+		/// Adds a task that belongs to the specified <paramref name="group"/> to the front of the queue.
+		/// Those are executed before any other queued tasks, so that the thread waiting on the group is not stalled behind unrelated work.
+		/// </summary>
+		void push(std::function<void()> task, group &group)
+		{
+			const std::unique_lock<std::mutex> lock(_mutex);
+			group._remaining++;
+			_tasks.push_front({ std::move(task), &group });
+			_condition.notify_all();
+		}
+
+		/// <summary>
+		/// Starts the specified number of worker threads, which execute queued tasks until <see cref="stop"/> is called.
+		/// Does nothing if worker threads were already started.
+		/// </summary>
+		void start(size_t num_threads)
+		{
+			const std::unique_lock<std::mutex> lock(_mutex);
+			if (!_threads.empty())
+				return;
+
+			for (size_t n = 0; n < num_threads; ++n)
+				_threads.emplace_back([this]() { worker(); });
+		}
+		/// <summary>
+		/// Executes all remaining queued tasks and then stops the worker threads again.
+		/// </summary>
+		void stop()
+		{
+			std::vector<std::thread> threads;
+			{
+				const std::unique_lock<std::mutex> lock(_mutex);
+				_stop = true;
+				_condition.notify_all();
+				threads = std::move(_threads);
+			}
+
+			for (std::thread &thread : threads)
+				thread.join();
+
+			const std::unique_lock<std::mutex> lock(_mutex);
+			_stop = false;
+		}
+
+		/// <summary>
+		/// Executes queued tasks until the queue is empty and no other thread is still running a task that could push more.
+		/// </summary>
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (!_tasks.empty() || _running != 0)
+			{
+				if (!_tasks.empty())
+					execute(lock, _tasks.begin());
+				else
+					_condition.wait(lock);
+			}
+		}
+
+		/// <summary>
+		/// Executes queued tasks of the specified <paramref name="group"/> until all of them have finished.
+		/// Unrelated tasks are left to the other threads, so that the waiting thread is not held up by them and does not nest further and further into their own waits.
+		/// </summary>
+		void wait(group &group)
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (group._remaining != 0)
+			{
+				// Tasks of a group are pushed to the front of the queue, so this usually finds one right away
+				if (const auto it = std::find_if(_tasks.begin(), _tasks.end(), [&group](const task &queued) { return queued.second == &group; });
+					it != _tasks.end())
+					execute(lock, it);
+				else
+					_condition.wait(lock); // Remaining tasks of the group are still running on other threads
+			}
+		}
+
+	private:
+		using task = std::pair<std::function<void()>, group *>;
+
+		void worker()
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			while (true)
+			{
+				if (!_tasks.empty())
+					execute(lock, _tasks.begin());
+				else if (_stop)
+					break;
+				else
+					_condition.wait(lock);
+			}
+		}
+
+		void execute(std::unique_lock<std::mutex> &lock, std::deque<task>::iterator it)
+		{
+			auto [function, group] = std::move(*it);
+			_tasks.erase(it);
+			_running++;
+
+			// Update the counters again even if the task throws, so that threads in 'run' or 'wait' do not end up waiting forever
+			struct completion_guard
+			{
+				task_scheduler &scheduler;
+				std::unique_lock<std::mutex> &lock;
+				task_scheduler::group *const group;
+
+				~completion_guard()
+				{
+					lock.lock();
+
+					scheduler._running--;
+					if (group != nullptr)
+						group->_remaining--;
+
+					// Wake up all threads, since both threads waiting on a group and threads waiting for the queue to drain may be able to continue now
+					scheduler._condition.notify_all();
+				}
+			} const guard { *this, lock, group };
+
+			lock.unlock();
+			function();
+		}
+
+		std::mutex _mutex;
+		std::condition_variable _condition;
+		std::deque<task> _tasks;
+		size_t _running = 0;
+		bool _stop = false;
+		std::vector<std::thread> _threads;
+	};
+}
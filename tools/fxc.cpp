@@ -6,10 +6,20 @@
 #include "effect_parser.hpp"
 #include "effect_codegen.hpp"
 #include "effect_preprocessor.hpp"
+#include "effect_cache.hpp"
+#include "cache_archive.hpp"
+#include "task_scheduler.hpp"
 #include "version.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdio> // std::sscanf
 #include <cstring>
 #include <fstream>
 #include <iostream>
+#include <algorithm> // std::max, std::sort, std::unique
+#include <Windows.h>
+#include <d3dcompiler.h>
 
 static void print_usage(const char *path)
 {
@@ -36,10 +46,332 @@ Options:
   --spec-constants          Convert uniform variables to specialization constants.
   --vulkan-semantics        Generate GLSL/SPIR-V code under Vulkan semantics, instead of OpenGL semantics.
 
-  -Zi                       Enable debug information.
+  -Zi                       Enable debug information. In batch mode this has to match the 'NoDebugInfo' setting (which is enabled by default, so leave this out).
+  --no-optimize             Disable constant folding of intrinsic calls and removal of code in branches that can never be taken. In batch mode this has to match the 'NoEffectOptimization' setting.
+
+Batch mode:
+  --batch <path>            Precompile all input effects into the effect cache directory at <path>, using the same cache keys as ReShade. Inputs may be effect files or directories containing them.
+  --base-path <path>        Directory relative '-I' search paths are resolved against (the directory containing ReShade). Defaults to the working directory.
+  --renderer <value>        Renderer ID to compile for, e.g. 0x9000 (D3D9), 0xa000 (D3D10), 0xb000 (D3D11), 0xc000 (D3D12), 0x10000 (OpenGL) or 0x20000 (Vulkan).
+  --app <name>              Name of the application executable (without extension).
+  --vendor <value>          PCI vendor ID of the graphics card.
+  --device <value>          PCI device ID of the graphics card.
+  --permutation <w>x<h>:<color space>:<color format>
+                            Back buffer dimensions, color space and format (as 'reshade::api::color_space' and 'reshade::api::format' values) to compile for.
+                            Has to be specified at least once, the first one is the default permutation.
+  --performance-mode        Compile with performance mode enabled.
+  --no-archive              Write separate cache files instead of a single cache archive.
+  -j <count>                Number of threads to compile with. Defaults to the number of processors.
+
+  In batch mode '-I' adds an effect search path (a trailing "**" searches recursively) and '-D' a global preprocessor definition.
+  Both have to be passed exactly as they appear in the ReShade configuration (and in the same order) for the cache to be used.
+  Comparing the summary with and without '--no-optimize' shows the effect of these optimizations on the input effects.
 	)", path);
 }
 
+struct batch_options
+{
+	std::filesystem::path cache_path;
+	std::filesystem::path base_path;
+	std::vector<std::filesystem::path> inputs;
+	std::vector<reshade::effect_cache_key> permutations;
+	reshade::effect_cache_key key;
+	bool debug_info = false;
+	bool optimize = true;
+	bool no_archive = false;
+	unsigned int num_threads = 0;
+};
+
+struct batch_context
+{
+	reshade::cache_archive archive;
+	reshadefx::include_cache include_cache;
+	std::filesystem::path cache_path;
+	HMODULE d3d_compiler_module = nullptr;
+	std::mutex output_mutex;
+
+	// Time spent in each stage, in microseconds and summed up over all threads
+	std::atomic<uint64_t> preprocess_time = 0;
+	std::atomic<uint64_t> parse_time = 0;
+	std::atomic<uint64_t> backend_time = 0;
+	// Size of the code passed to the D3DCompiler, in bytes and summed up over all entry points
+	std::atomic<uint64_t> code_size = 0;
+
+	bool save(const std::string &id, const std::string &type, const std::string &data)
+	{
+		if (archive.is_open())
+			return archive.save(id + '.' + type, data);
+
+		// Use the same file names as ReShade when it is not using the cache archive
+		std::ofstream file(cache_path / std::filesystem::u8path("reshade-" + id + '.' + type), std::ios::binary);
+		return file.write(data.data(), data.size()).good();
+	}
+};
+
+static uint64_t elapsed_microseconds(std::chrono::high_resolution_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+static bool parse_permutation(const char *arg, reshade::effect_cache_key &key)
+{
+	// Format is "<width>x<height>:<color space>:<color format>"
+	// The color space and format are part of the cache key, so have to match the back buffer exactly for the cache to be used
+	unsigned int width = 0, height = 0, color_space = 0, color_format = 0;
+	if (std::sscanf(arg, "%ux%u:%u:%u", &width, &height, &color_space, &color_format) != 4 || width == 0 || height == 0 || color_format == 0)
+		return false;
+
+	key.width = width;
+	key.height = height;
+	key.color_space = static_cast<reshade::api::color_space>(color_space);
+	// Handle sRGB and non-sRGB format variants as the same permutation, the same way as ReShade does
+	key.color_format = reshade::api::format_to_default_typed(static_cast<reshade::api::format>(color_format), 0);
+	return true;
+}
+
+static bool compile_entry_point(batch_context &context, const std::string &cache_id, const std::string &entry_point, const std::string &hlsl, const std::string &profile, uint32_t compile_flags, std::string &errors)
+{
+	const auto D3DCompile = reinterpret_cast<pD3DCompile>(GetProcAddress(context.d3d_compiler_module, "D3DCompile"));
+	const auto D3DDisassemble = reinterpret_cast<pD3DDisassemble>(GetProcAddress(context.d3d_compiler_module, "D3DDisassemble"));
+	if (D3DCompile == nullptr || D3DDisassemble == nullptr)
+		return false;
+
+	ID3DBlob *d3d_compiled = nullptr, *d3d_errors = nullptr;
+	const HRESULT hr = D3DCompile(
+		hlsl.data(), hlsl.size(),
+		nullptr, nullptr, nullptr,
+		entry_point.c_str(),
+		profile.c_str(),
+		compile_flags, 0,
+		&d3d_compiled, &d3d_errors);
+
+	if (d3d_errors != nullptr)
+	{
+		errors.append(static_cast<const char *>(d3d_errors->GetBufferPointer()), d3d_errors->GetBufferSize() - 1);
+		d3d_errors->Release();
+	}
+
+	if (FAILED(hr))
+		return false;
+
+	const std::string cso(static_cast<const char *>(d3d_compiled->GetBufferPointer()), d3d_compiled->GetBufferSize());
+	d3d_compiled->Release();
+
+	std::string cso_text;
+	if (ID3DBlob *d3d_disassembled = nullptr;
+		SUCCEEDED(D3DDisassemble(cso.data(), cso.size(), 0, nullptr, &d3d_disassembled)))
+	{
+		cso_text.assign(static_cast<const char *>(d3d_disassembled->GetBufferPointer()), d3d_disassembled->GetBufferSize() - 1);
+		d3d_disassembled->Release();
+	}
+
+	return context.save(cache_id, "cso", cso) && context.save(cache_id, "asm", cso_text);
+}
+
+static bool compile_effect(batch_context &context, reshade::task_scheduler &scheduler, const reshade::effect_cache_key &key, bool permutation, bool debug_info, bool optimize, const std::filesystem::path &base_path, std::string &errors)
+{
+	std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+	const std::string attributes = key.attributes();
+
+	reshadefx::preprocessor pp(context.include_cache);
+	key.setup_preprocessor(pp, permutation, key.resolve_include_paths(base_path));
+
+	const bool preprocessed = pp.append_file(key.source_file);
+	errors += pp.errors();
+	if (!preprocessed)
+		return false;
+
+	std::string source;
+	std::string code_preamble;
+	std::vector<std::pair<std::string, std::string>> used_definitions;
+	const bool skip_optimization = reshade::finalize_preprocessed_effect(pp, source, code_preamble, used_definitions);
+
+	std::vector<std::filesystem::path> dependency_files = pp.included_files();
+	dependency_files.insert(dependency_files.begin(), key.source_file);
+
+	std::string dependencies;
+	std::string dependencies_key;
+	if (!reshade::build_effect_dependencies(dependency_files, pp.missing_files(), key.search_paths, base_path, context.include_cache, dependencies) ||
+		!reshade::check_effect_dependencies(dependencies, base_path, dependencies_key, dependency_files))
+	{
+		errors += "error: " + key.source_file.u8string() + ": failed to read included files\n";
+		return false;
+	}
+
+	// ReShade does not cache effects that use special pragma directives, so there is nothing to precompile for those
+	if (!skip_optimization && (
+		!context.save(key.cache_id(reshadefx::hash_data(attributes)), "deps", dependencies) ||
+		!context.save(key.cache_id(reshadefx::hash_data(dependencies_key, reshadefx::hash_data(attributes))), "i", source)))
+	{
+		errors += "error: " + key.source_file.u8string() + ": failed to write to effect cache\n";
+		return false;
+	}
+
+	context.preprocess_time += elapsed_microseconds(time_started);
+
+	// Only the D3DCompiler output is cached by ReShade, GLSL and SPIR-V code is generated on every load
+	if ((key.renderer_id & 0xF0000) != 0)
+		return true;
+
+	time_started = std::chrono::high_resolution_clock::now();
+
+	const std::unique_ptr<reshadefx::codegen> codegen(reshade::create_effect_codegen(key.renderer_id, debug_info, key.performance_mode));
+
+	reshadefx::parser parser;
+	const bool compiled = parser.parse(std::move(source), codegen.get(), optimize);
+	errors += parser.errors();
+	if (!compiled)
+		return false;
+
+	context.parse_time += elapsed_microseconds(time_started);
+
+	const reshadefx::effect_module &module = codegen->module();
+
+	// Specialization constants are filled with values from the preset in performance mode, which are not known here
+	if (key.performance_mode && !module.spec_constants.empty())
+		return true;
+
+	struct entry_point_result
+	{
+		std::string errors;
+		bool success = true;
+	};
+
+	std::vector<entry_point_result> entry_point_results(module.entry_points.size());
+	reshade::task_scheduler::group entry_point_tasks;
+
+	for (size_t entry_point_index = 0; entry_point_index < module.entry_points.size(); ++entry_point_index)
+	{
+		scheduler.push([&context, &key, &codegen, &module, &code_preamble, &entry_point = module.entry_points[entry_point_index], &result = entry_point_results[entry_point_index], skip_optimization]() {
+			const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+			const std::string hlsl = reshade::build_effect_hlsl(*codegen, module, code_preamble, entry_point.first, key.renderer_id, key.width, key.height);
+			const std::string profile = reshade::effect_hlsl_profile(entry_point.second, key.renderer_id);
+			const uint32_t compile_flags = reshade::effect_hlsl_compile_flags(key.renderer_id, skip_optimization, key.performance_mode);
+			const std::string cache_id = reshade::effect_shader_cache_id(key.source_file, entry_point.first, key.renderer_id, profile, compile_flags, hlsl);
+
+			context.code_size += hlsl.size();
+
+			result.success = compile_entry_point(context, cache_id, entry_point.first, hlsl, profile, compile_flags, result.errors);
+
+			context.backend_time += elapsed_microseconds(time_started);
+		}, entry_point_tasks);
+	}
+
+	scheduler.wait(entry_point_tasks);
+
+	bool success = true;
+	for (const entry_point_result &result : entry_point_results)
+	{
+		errors += result.errors;
+		success &= result.success;
+	}
+
+	return success;
+}
+
+static int compile_batch(const batch_options &options)
+{
+	std::error_code ec;
+
+	// Collect effect files, either given directly or by searching the specified directories
+	std::vector<std::filesystem::path> effect_files;
+	for (const std::filesystem::path &input : options.inputs)
+	{
+		if (std::filesystem::is_directory(input, ec))
+		{
+			for (const std::filesystem::directory_entry &entry : std::filesystem::directory_iterator(input, std::filesystem::directory_options::skip_permission_denied, ec))
+				if (const std::filesystem::path extension = entry.path().extension(); extension == L".fx" || extension == L".addonfx")
+					effect_files.push_back(std::filesystem::canonical(entry.path(), ec));
+		}
+		else if (std::filesystem::path canonical_path = std::filesystem::canonical(input, ec); !ec)
+		{
+			effect_files.push_back(std::move(canonical_path));
+		}
+		else
+		{
+			std::cout << "error: " << input.u8string() << ": file not found" << std::endl;
+			return 1;
+		}
+	}
+
+	std::sort(effect_files.begin(), effect_files.end());
+	effect_files.erase(std::unique(effect_files.begin(), effect_files.end()), effect_files.end());
+
+	batch_context context;
+	context.cache_path = options.cache_path;
+
+	std::filesystem::create_directories(options.cache_path, ec);
+
+	// Do not limit the archive size here, ReShade evicts entries as needed the next time it closes the archive
+	if (!options.no_archive && !context.archive.open(options.cache_path / L"reshade-effects.cache", 0))
+	{
+		std::cout << "error: failed to open effect cache archive in " << options.cache_path.u8string() << std::endl;
+		return 1;
+	}
+
+	if ((options.key.renderer_id & 0xF0000) == 0)
+	{
+		context.d3d_compiler_module = LoadLibraryW(L"d3dcompiler_47.dll");
+		if (context.d3d_compiler_module == nullptr)
+		{
+			std::cout << "error: unable to load D3DCompiler (\"d3dcompiler_47.dll\")" << std::endl;
+			return 1;
+		}
+	}
+
+	const std::chrono::high_resolution_clock::time_point time_started = std::chrono::high_resolution_clock::now();
+
+	std::atomic<size_t> num_failed = 0;
+
+	reshade::task_scheduler scheduler;
+	for (const std::filesystem::path &effect_file : effect_files)
+	{
+		for (size_t permutation_index = 0; permutation_index < options.permutations.size(); ++permutation_index)
+		{
+			reshade::effect_cache_key key = options.key;
+			key.source_file = effect_file;
+			key.width = options.permutations[permutation_index].width;
+			key.height = options.permutations[permutation_index].height;
+			key.color_space = options.permutations[permutation_index].color_space;
+			key.color_format = options.permutations[permutation_index].color_format;
+
+			scheduler.push([&context, &scheduler, &options, &num_failed, key = std::move(key), permutation_index]() {
+				std::string errors;
+				const bool success = compile_effect(context, scheduler, key, permutation_index != 0, options.debug_info, options.optimize, options.base_path, errors);
+				if (!success)
+					num_failed++;
+
+				const std::unique_lock<std::mutex> lock(context.output_mutex);
+				std::cout << (success ? "compiled " : "failed   ") << key.source_file.filename().u8string() << " (" << key.width << 'x' << key.height << ')' << std::endl;
+				if (!errors.empty())
+					std::cout << errors;
+			});
+		}
+	}
+
+	std::vector<std::thread> threads(std::max(options.num_threads != 0 ? options.num_threads : std::thread::hardware_concurrency(), 1u));
+	for (std::thread &thread : threads)
+		thread = std::thread(&reshade::task_scheduler::run, &scheduler);
+	for (std::thread &thread : threads)
+		thread.join();
+
+	context.archive.close();
+
+	if (context.d3d_compiler_module != nullptr)
+		FreeLibrary(context.d3d_compiler_module);
+
+	std::cout << std::endl
+		<< "Compiled " << (effect_files.size() * options.permutations.size() - num_failed) << " of " << (effect_files.size() * options.permutations.size()) << " effect permutations in " << (elapsed_microseconds(time_started) / 1000) << " ms using " << threads.size() << " threads" << std::endl
+		<< "  preprocess: " << (context.preprocess_time / 1000) << " ms" << std::endl
+		<< "  parse:      " << (context.parse_time / 1000) << " ms" << std::endl
+		<< "  backend:    " << (context.backend_time / 1000) << " ms" << std::endl
+		<< "  code size:  " << (context.code_size / 1024) << " KiB" << std::endl;
+
+	return num_failed != 0 ? 1 : 0;
+}
+
 int main(int argc, char *argv[])
 {
 	const char *source_file = nullptr;
@@ -51,10 +383,12 @@ int main(int argc, char *argv[])
 	bool print_glsl = false;
 	bool print_hlsl = false;
 	bool debug_info = false;
+	bool optimize = true;
 	bool invert_y_axis = false;
 	bool spec_constants = false;
 	bool vulkan_semantics = false;
 	unsigned int shader_model = 50;
+	batch_options batch;
 
 	reshadefx::preprocessor pp;
 	pp.add_macro_definition("__RESHADE__", std::to_string(VERSION_MAJOR * 10000 + VERSION_MINOR * 100 + VERSION_REVISION));
@@ -82,17 +416,21 @@ int main(int argc, char *argv[])
 				char *value = std::strchr(name, '=');
 				if (value) *value++ = '\0';
 				pp.add_macro_definition(name, value ? value : "1");
+				batch.key.definitions.emplace_back(name, value ? value : std::string());
 				continue;
 			}
 
 			if (0 == std::strcmp(arg, "-I"))
 			{
 				pp.add_include_path(argv[++i]);
+				batch.key.search_paths.push_back(std::filesystem::u8path(argv[i]));
 				continue;
 			}
 
 			if (0 == std::strcmp(arg, "-Zi"))
-				debug_info = true;
+				debug_info = batch.debug_info = true;
+			else if (0 == std::strcmp(arg, "--no-optimize"))
+				optimize = batch.optimize = false;
 			else if (0 == std::strcmp(arg, "--glsl"))
 				print_glsl = true;
 			else if (0 == std::strcmp(arg, "--hlsl"))
@@ -103,6 +441,10 @@ int main(int argc, char *argv[])
 				spec_constants = true;
 			else if (0 == std::strcmp(arg, "--vulkan-semantics"))
 				vulkan_semantics = true;
+			else if (0 == std::strcmp(arg, "--performance-mode"))
+				batch.key.performance_mode = true;
+			else if (0 == std::strcmp(arg, "--no-archive"))
+				batch.no_archive = true;
 
 			if (i + 1 >= argc)
 				continue;
@@ -118,11 +460,38 @@ int main(int argc, char *argv[])
 				buffer_width = argv[++i];
 			else if (0 == std::strcmp(arg, "--height"))
 				buffer_height = argv[++i];
+			else if (0 == std::strcmp(arg, "--batch"))
+				batch.cache_path = std::filesystem::u8path(argv[++i]);
+			else if (0 == std::strcmp(arg, "--base-path"))
+				batch.base_path = std::filesystem::u8path(argv[++i]);
+			else if (0 == std::strcmp(arg, "--renderer"))
+				batch.key.renderer_id = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+			else if (0 == std::strcmp(arg, "--app"))
+				batch.key.application = argv[++i];
+			else if (0 == std::strcmp(arg, "--vendor"))
+				batch.key.vendor_id = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+			else if (0 == std::strcmp(arg, "--device"))
+				batch.key.device_id = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+			else if (0 == std::strcmp(arg, "--permutation"))
+			{
+				if (!parse_permutation(argv[++i], batch.permutations.emplace_back()))
+				{
+					std::cout << "error: Invalid permutation \"" << argv[i] << '\"' << std::endl;
+					return 1;
+				}
+			}
+			else if (0 == std::strcmp(arg, "-j"))
+				batch.num_threads = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
 		}
 		else
 		{
+			batch.inputs.push_back(std::filesystem::u8path(arg));
+
 			if (source_file != nullptr)
 			{
+				if (!batch.cache_path.empty())
+					continue; // Batch mode accepts any number of input files
+
 				std::cout << "error: More than one input file specified" << std::endl;
 				return 1;
 			}
@@ -131,6 +500,20 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if (!batch.cache_path.empty())
+	{
+		if (batch.inputs.empty() || batch.permutations.empty() || batch.key.renderer_id == 0)
+		{
+			print_usage(argv[0]);
+			return 1;
+		}
+
+		if (batch.base_path.empty())
+			batch.base_path = std::filesystem::current_path();
+
+		return compile_batch(batch);
+	}
+
 	if (source_file == nullptr || (print_glsl && print_hlsl) || (print_glsl && object_file) || (print_hlsl && object_file))
 	{
 		print_usage(argv[0]);
@@ -169,7 +552,7 @@ int main(int argc, char *argv[])
 		backend.reset(reshadefx::create_codegen_spirv(vulkan_semantics, debug_info, spec_constants, invert_y_axis));
 
 	reshadefx::parser parser;
-	if (!parser.parse(pp.output(), backend.get()))
+	if (!parser.parse(pp.output(), backend.get(), optimize))
 	{
 		if (error_file == nullptr)
 			std::cout << pp.errors() << parser.errors() << std::endl;